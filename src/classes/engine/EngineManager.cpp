@@ -3,9 +3,12 @@
 
 #include "../../customCode/testScene/TestSceneOrigin.h"
 #include "../../resources/shader/GridShader.h"
+#include "../helper/AssetPack.h"
 #include "../nodeComponents/CameraComponent.h"
 #include "../nodeComponents/GeometryComponent.h"
+#include "../nodeComponents/LightComponent.h"
 #include "../nodeComponents/UiDebugWindow.h"
+#include "StartupTrace.h"
 #include "rendering/RenderManager.h"
 
 #include <iostream>
@@ -29,6 +32,11 @@ namespace Engine
         , m_showGrid(true)
         , m_gridShader(nullptr)
     {
+        StartupTrace::Scope phase(SingletonManager::get<StartupTrace>(), "engine init");
+
+        // Assets are read from the pack built by the assetPack target if there is one, else from loose files
+        AssetPack::mount(DEFAULT_ASSET_PACK_PATH);
+
         m_renderManager = std::make_shared<RenderManager>();
         m_gridShader = std::make_shared<GridShader>(m_renderManager);
     }
@@ -53,6 +61,7 @@ namespace Engine
 
         m_lastFrameTimestamp = glfwGetTime();
 
+        StartupTrace::Scope phase(SingletonManager::get<StartupTrace>(), "scene start");
         m_sceneNode->start();
 
         return true;
@@ -74,8 +83,12 @@ namespace Engine
 
     void EngineManager::engineDraw()
     {
+        m_renderManager->beginFrame();
+
         if(m_camera)
         {
+            m_renderManager->getClusteredLighting()->update(m_camera.get(), m_sceneLights);
+
             glClear(GL_COLOR_BUFFER_BIT | GL_DEPTH_BUFFER_BIT);
 
             // TODO: Investigate multithreading
@@ -114,7 +127,8 @@ namespace Engine
         );
     }
 
-    // Sorted by: Opaque objects first, sorted by their shaderID. Translucent objects second, sorted by their distance to the camera.
+    // Sorted by: Opaque objects first, sorted by their shaderID and texture. Translucent objects second, sorted by
+    // their distance to the camera.
     bool EngineManager::nodeSortingAlgorithm(
             const std::shared_ptr<GeometryComponent>& a,
             const std::shared_ptr<GeometryComponent>& b,
@@ -128,7 +142,15 @@ namespace Engine
         }
         else if(!aTranslucency)
         {
-            return a->getShader()->getShaderIdentifier().second < b->getShader()->getShaderIdentifier().second;
+            const GLuint shaderA = a->getShader()->getShaderIdentifier().second;
+            const GLuint shaderB = b->getShader()->getShaderIdentifier().second;
+            if(shaderA != shaderB)
+            {
+                return shaderA < shaderB;
+            }
+
+            // Geometry sharing an atlas or texture array is drawn back to back
+            return a->getTextureBuffer() < b->getTextureBuffer();
         }
 
         const auto& distanceA = glm::distance(a->getGlobalPosition(), cameraPosition);
@@ -146,6 +168,11 @@ namespace Engine
                 return;
             }
 
+            if(!m_renderManager->requestResidency(node->getObjectData(), node->getTexture()))
+            {
+                continue;
+            }
+
             drawNode(node);
         }
     }
@@ -160,6 +187,17 @@ namespace Engine
                 continue;
             }
 
+            const bool needsPositions = node->needsMeshPositions();
+            if(!m_renderManager->requestResidency(node->getObjectData(), node->getTexture(), needsPositions))
+            {
+                continue;
+            }
+
+            // Sorted at runtime until the precomputed orders are ready
+            if(node->getUsesTriangleOrders())
+            {
+                m_renderManager->bakeTriangleOrders(node->getObjectData());
+            }
             node->depthSortTriangles();
 
             drawNode(node);
@@ -266,6 +304,28 @@ namespace Engine
         removeGeometryFromScene(node->getNodeId());
     }
 
+    void EngineManager::addLightToScene(std::shared_ptr<LightComponent>& node)
+    {
+        m_sceneLights.emplace_back(node);
+    }
+
+    void EngineManager::removeLightFromScene(Engine::BasicNode* node)
+    {
+        removeLightFromScene(node->getNodeId());
+    }
+
+    void EngineManager::removeLightFromScene(const unsigned int& nodeId)
+    {
+        m_sceneLights.erase(
+                std::remove_if(
+                        m_sceneLights.begin(),
+                        m_sceneLights.end(),
+                        [nodeId](const auto& childNode) -> bool { return childNode->getNodeId() == nodeId; }
+                ),
+                m_sceneLights.end()
+        );
+    }
+
     void EngineManager::addDebugUiToScene(std::shared_ptr<Ui::UiDebugWindow>& node)
     {
         m_sceneDebugUi.emplace_back(node);
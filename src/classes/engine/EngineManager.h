@@ -13,6 +13,7 @@ namespace Engine
     class CameraComponent;
     class GeometryComponent;
     class GridShader;
+    class LightComponent;
 
     namespace Ui
     {
@@ -63,6 +64,18 @@ namespace Engine
             void removeGeometryFromScene(BasicNode* node);
             void removeGeometryFromScene(const unsigned int& nodeId);
 
+            /**
+             * Lights in the scene are assigned to the clusters of the view frustum every frame.
+             */
+            void addLightToScene(std::shared_ptr<LightComponent>& node);
+            void removeLightFromScene(BasicNode* node);
+            void removeLightFromScene(const unsigned int& nodeId);
+
+            const std::vector<std::shared_ptr<LightComponent>>& getSceneLights() const
+            {
+                return m_sceneLights;
+            };
+
             void addDebugUiToScene(std::shared_ptr<Ui::UiDebugWindow>& node);
             void removeDebugUiFromScene(std::shared_ptr<Ui::UiDebugWindow>& node);
             void removeDebugUiFromScene(const unsigned int& nodeId);
@@ -84,6 +97,7 @@ namespace Engine
 
             std::vector<std::shared_ptr<GeometryComponent>> m_sceneGeometry;
             std::vector<std::shared_ptr<Ui::UiDebugWindow>> m_sceneDebugUi;
+            std::vector<std::shared_ptr<LightComponent>> m_sceneLights;
             std::shared_ptr<RenderManager> m_renderManager;
             std::shared_ptr<BasicNode> m_sceneNode;
             std::shared_ptr<CameraComponent> m_camera;
@@ -3,9 +3,11 @@
 
 #include "../nodeComponents/BasicNode.h"
 #include "EngineManager.h"
+#include "StartupTrace.h"
 #include "UserEventManager.h"
 #include "WindowEventCallbackHelper.h"
 #include "WindowManager.h"
+#include "rendering/RenderManager.h"
 
 #include <imgui.h>
 #include <imgui_impl_glfw.h>
@@ -13,7 +15,19 @@
 
 namespace Engine
 {
-    GameInterface::GameInterface() { SingletonManager::get<WindowManager>()->startWindow(); }
+    static void openWindow()
+    {
+        StartupTrace::Scope phase(SingletonManager::get<StartupTrace>(), "open window");
+        SingletonManager::get<WindowManager>()->startWindow();
+    }
+
+    GameInterface::GameInterface() { openWindow(); }
+
+    GameInterface::GameInterface(const BootAssets& bootAssets)
+    {
+        RenderManager::preloadAssets(bootAssets);
+        openWindow();
+    }
 
     int GameInterface::startGame()
     {
@@ -25,7 +39,10 @@ namespace Engine
 
         const std::shared_ptr<UserEventManager>& userEventManager = SingletonManager::get<UserEventManager>();
         const std::shared_ptr<WindowManager>& windowManager = SingletonManager::get<WindowManager>();
+        const std::shared_ptr<StartupTrace>& startupTrace = SingletonManager::get<StartupTrace>();
 
+        bool isFirstFrame = true;
+        size_t firstFramePhase = startupTrace->beginPhase("first frame");
         do
         {
             ImGui_ImplOpenGL3_NewFrame();
@@ -40,6 +57,15 @@ namespace Engine
             ImGui_ImplOpenGL3_RenderDrawData(ImGui::GetDrawData());
             glfwSwapBuffers(windowManager->getWindow());
 
+            if(isFirstFrame)
+            {
+                startupTrace->endPhase(firstFramePhase);
+                startupTrace->finish();
+                // Boot assets the scene didn't register by now aren't needed
+                RenderManager::clearPreloadedAssets();
+                isFirstFrame = false;
+            }
+
             engineManager->engineLateUpdate();
 
             glfwPollEvents();
@@ -2,10 +2,21 @@
 
 namespace Engine
 {
+    struct BootAssets;
+
     class GameInterface
     {
         public:
             GameInterface();
+
+            /**
+             * Boot mode: starts loading the assets of the first scene on worker threads,
+             * then creates the window and GL context while they load.
+             *
+             * @param bootAssets The assets the first scene registers
+             */
+            explicit GameInterface(const BootAssets& bootAssets);
+
             ~GameInterface() = default;
 
             int startGame();
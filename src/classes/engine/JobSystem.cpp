@@ -0,0 +1,139 @@
+#include "JobSystem.h"
+
+#include <algorithm>
+#include <atomic>
+#include <memory>
+
+namespace Engine
+{
+    namespace
+    {
+        /**
+         * The tasks of one runTasks call. Jobs that only start once every task has been taken find nothing to
+         * do, so the task is never called after runTasks returns.
+         */
+        struct TaskBatch
+        {
+                std::atomic<size_t> nextTask = 0;
+                size_t taskCount = 0;
+                size_t finishedTasks = 0;
+                std::mutex mutex;
+                std::condition_variable finished;
+                const JobSystem::Task* task = nullptr;
+        };
+
+        void runRemainingTasks(TaskBatch& batch)
+        {
+            size_t index = batch.nextTask++;
+            for(; index < batch.taskCount; index = batch.nextTask++)
+            {
+                (*batch.task)(index);
+
+                std::lock_guard<std::mutex> lock(batch.mutex);
+                if(++batch.finishedTasks == batch.taskCount)
+                {
+                    batch.finished.notify_all();
+                }
+            }
+        }
+    } // namespace
+
+    JobSystem::JobSystem() : m_runningJobs(0), m_stopping(false)
+    {
+        // Leave one core to the main thread
+        const unsigned int workerCount = std::max(std::thread::hardware_concurrency(), 2u) - 1;
+        for(unsigned int i = 0; i < workerCount; i++)
+        {
+            m_workers.emplace_back(&JobSystem::workerLoop, this);
+        }
+    }
+
+    JobSystem::~JobSystem()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_stopping = true;
+        }
+        m_jobAvailable.notify_all();
+
+        for(auto& worker : m_workers)
+        {
+            worker.join();
+        }
+    }
+
+    void JobSystem::addJob(Job job)
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            m_jobs.push_back(std::move(job));
+        }
+        m_jobAvailable.notify_one();
+    }
+
+    void JobSystem::runTasks(size_t count, const Task& task)
+    {
+        if(count == 0)
+        {
+            return;
+        }
+
+        auto batch = std::make_shared<TaskBatch>();
+        batch->taskCount = count;
+        batch->task = &task;
+
+        // Workers busy with other jobs don't hold up the caller, it takes the tasks they don't
+        const size_t jobCount = std::min(m_workers.size(), count - 1);
+        for(size_t i = 0; i < jobCount; i++)
+        {
+            addJob([batch]() { runRemainingTasks(*batch); });
+        }
+        runRemainingTasks(*batch);
+
+        std::unique_lock<std::mutex> lock(batch->mutex);
+        batch->finished.wait(lock, [&batch]() { return batch->finishedTasks == batch->taskCount; });
+    }
+
+    void JobSystem::waitForIdle()
+    {
+        std::unique_lock<std::mutex> lock(m_mutex);
+        m_idle.wait(lock, [this]() { return m_jobs.empty() && m_runningJobs == 0; });
+    }
+
+    size_t JobSystem::getPendingJobCount()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_jobs.size() + m_runningJobs;
+    }
+
+    void JobSystem::workerLoop()
+    {
+        while(true)
+        {
+            Job job;
+            {
+                std::unique_lock<std::mutex> lock(m_mutex);
+                m_jobAvailable.wait(lock, [this]() { return m_stopping || !m_jobs.empty(); });
+                if(m_stopping)
+                {
+                    return;
+                }
+
+                job = std::move(m_jobs.front());
+                m_jobs.pop_front();
+                m_runningJobs++;
+            }
+
+            job();
+
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_runningJobs--;
+                if(m_jobs.empty() && m_runningJobs == 0)
+                {
+                    m_idle.notify_all();
+                }
+            }
+        }
+    }
+} // namespace Engine
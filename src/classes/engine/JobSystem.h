@@ -0,0 +1,61 @@
+#pragma once
+
+#include "../SingletonManager.h"
+
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Engine
+{
+    /**
+     * @brief Pool of worker threads running jobs in the order they were added.
+     * Jobs must not touch OpenGL, the context is only current on the main thread.
+     */
+    class JobSystem : public SingletonBase
+    {
+        public:
+            using Job = std::function<void()>;
+            using Task = std::function<void(size_t)>;
+
+            JobSystem();
+            ~JobSystem() override;
+
+            /**
+             * @brief Queues a job to be run on one of the worker threads.
+             * @param job The job to run.
+             */
+            void addJob(Job job);
+
+            /**
+             * @brief Runs the task for every index on the workers and the calling thread.
+             * Only waits for these tasks rather than the whole queue, so it can be called from a job as well.
+             * @param count The amount of indices.
+             * @param task The task to run, called with every index from 0 to count - 1 once.
+             */
+            void runTasks(size_t count, const Task& task);
+
+            /**
+             * @brief Blocks until every queued job has finished.
+             */
+            void waitForIdle();
+
+            size_t getWorkerCount() const { return m_workers.size(); };
+
+            size_t getPendingJobCount();
+
+        private:
+            void workerLoop();
+
+            std::vector<std::thread> m_workers;
+            std::deque<Job> m_jobs;
+            std::mutex m_mutex;
+            std::condition_variable m_jobAvailable;
+            std::condition_variable m_idle;
+            size_t m_runningJobs;
+            bool m_stopping;
+    };
+} // namespace Engine
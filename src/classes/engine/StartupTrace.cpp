@@ -0,0 +1,176 @@
+#include "StartupTrace.h"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <iostream>
+
+namespace Engine
+{
+    StartupTrace::Scope::Scope(std::shared_ptr<StartupTrace> trace, std::string name)
+        : m_trace(std::move(trace))
+        , m_phase(SIZE_MAX)
+    {
+        if(m_trace)
+        {
+            m_phase = m_trace->beginPhase(std::move(name));
+        }
+    }
+
+    StartupTrace::Scope::~Scope()
+    {
+        if(m_trace)
+        {
+            m_trace->endPhase(m_phase);
+        }
+    }
+
+    StartupTrace::StartupTrace()
+        : m_startTime(std::chrono::steady_clock::now())
+        , m_phases(std::vector<Phase>())
+        , m_threads({ std::this_thread::get_id() })
+        , m_timeToFirstFrame(0)
+        , m_isRecording(true)
+    {
+    }
+
+    double StartupTrace::getTime() const
+    {
+        return std::chrono::duration<double>(std::chrono::steady_clock::now() - m_startTime).count();
+    }
+
+    size_t StartupTrace::beginPhase(std::string name)
+    {
+        const double start = getTime();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(!m_isRecording)
+        {
+            return SIZE_MAX;
+        }
+
+        auto threadId = std::find(m_threads.begin(), m_threads.end(), std::this_thread::get_id());
+        if(threadId == m_threads.end())
+        {
+            threadId = m_threads.insert(m_threads.end(), std::this_thread::get_id());
+        }
+        const auto thread = int(threadId - m_threads.begin());
+
+        // Phases still open on this thread enclose the new one
+        const auto depth = int(std::count_if(
+                m_phases.begin(),
+                m_phases.end(),
+                [thread](const Phase& phase) { return phase.thread == thread && phase.end < 0.0; }
+        ));
+        m_phases.push_back({ std::move(name), start, -1.0, thread, depth });
+        return m_phases.size() - 1;
+    }
+
+    void StartupTrace::endPhase(size_t phase)
+    {
+        const double end = getTime();
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if(phase < m_phases.size())
+        {
+            m_phases[phase].end = end;
+        }
+    }
+
+    void StartupTrace::finish()
+    {
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if(!m_isRecording)
+            {
+                return;
+            }
+
+            m_timeToFirstFrame = getTime();
+            const double presented = m_timeToFirstFrame;
+            m_phases.push_back({ "first frame presented", presented, presented, 0, 0 });
+            m_isRecording = false;
+        }
+
+        printBreakdown();
+
+        if(!m_exportPath.empty() && !exportTrace(m_exportPath))
+        {
+            std::cout << "Couldn't write start-up trace [" << m_exportPath << "]" << std::endl;
+        }
+    }
+
+    bool StartupTrace::isRecording()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_isRecording;
+    }
+
+    double StartupTrace::getTimeToFirstFrame()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+        return m_timeToFirstFrame;
+    }
+
+    void StartupTrace::printBreakdown()
+    {
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        std::cout << "Start-up breakdown:" << std::endl;
+        std::cout << "     start   duration  thread  phase" << std::endl;
+
+        for(const Phase& phase : m_phases)
+        {
+            // Phases that never ended ran until the trace finished
+            const double end = phase.end < 0.0 ? m_timeToFirstFrame : phase.end;
+            printf("%8.1fms %8.1fms  %6d  %s%s\n",
+                   phase.start * 1000.0,
+                   (end - phase.start) * 1000.0,
+                   phase.thread,
+                   std::string(size_t(phase.depth) * 2, ' ').c_str(),
+                   phase.name.c_str());
+        }
+
+        printf("Time to first frame: %.1fms\n", m_timeToFirstFrame * 1000.0);
+    }
+
+    bool StartupTrace::exportTrace(const std::string& filePath)
+    {
+        FILE* file = fopen(filePath.c_str(), "w");
+        if(file == nullptr)
+        {
+            return false;
+        }
+
+        std::lock_guard<std::mutex> lock(m_mutex);
+
+        fprintf(file, "{\"traceEvents\":[\n");
+        for(size_t i = 0; i < m_phases.size(); i++)
+        {
+            const Phase& phase = m_phases[i];
+            const double end = phase.end < 0.0 ? m_timeToFirstFrame : phase.end;
+
+            std::string name;
+            for(const char c : phase.name)
+            {
+                if(c == '"' || c == '\\')
+                {
+                    name += '\\';
+                }
+                name += c;
+            }
+
+            // Complete events, timestamps and durations are in microseconds
+            fprintf(file,
+                    "{\"name\":\"%s\",\"ph\":\"X\",\"pid\":1,\"tid\":%d,\"ts\":%.3f,\"dur\":%.3f}%s\n",
+                    name.c_str(),
+                    phase.thread,
+                    phase.start * 1e6,
+                    (end - phase.start) * 1e6,
+                    i + 1 < m_phases.size() ? "," : "");
+        }
+        fprintf(file, "]}\n");
+
+        return fclose(file) == 0;
+    }
+} // namespace Engine
@@ -0,0 +1,103 @@
+#pragma once
+
+#include "../SingletonManager.h"
+
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace Engine
+{
+    /**
+     * @brief Timeline of the engine's start-up, from main until the first frame is presented.
+     * Phases may be recorded from any thread and nest, the trace stops recording once finish is called.
+     * Fetch it through the SingletonManager on the main thread, jobs have to be handed the pointer.
+     */
+    class StartupTrace : public SingletonBase
+    {
+        public:
+            /**
+             * @brief Ends its phase when it goes out of scope.
+             */
+            class Scope
+            {
+                public:
+                    Scope(std::shared_ptr<StartupTrace> trace, std::string name);
+                    ~Scope();
+
+                    Scope(const Scope&) = delete;
+                    Scope& operator=(const Scope&) = delete;
+
+                private:
+                    std::shared_ptr<StartupTrace> m_trace;
+                    size_t m_phase;
+            };
+
+            StartupTrace();
+            ~StartupTrace() override = default;
+
+            /**
+             * @brief Starts a phase on the calling thread.
+             * @param name The name the phase is listed as.
+             * @return The phase to pass to endPhase, SIZE_MAX once the trace has finished.
+             */
+            size_t beginPhase(std::string name);
+
+            void endPhase(size_t phase);
+
+            /**
+             * Records that the first frame was presented, prints the breakdown and writes the trace to the
+             * export path if one is set. Later calls do nothing.
+             */
+            void finish();
+
+            bool isRecording();
+
+            /**
+             * @return Seconds from the creation of the trace until finish was called, 0 until then
+             */
+            double getTimeToFirstFrame();
+
+            /**
+             * @param filePath Where finish writes the trace to, empty to not export it
+             */
+            void setExportPath(std::string filePath) { m_exportPath = std::move(filePath); };
+
+            /**
+             * Prints every phase with its start, duration and thread, indented by nesting.
+             */
+            void printBreakdown();
+
+            /**
+             * Writes the phases in the Trace Event Format, viewable in chrome://tracing or ui.perfetto.dev.
+             *
+             * @param filePath The path of the JSON file
+             * @return True if the file was written
+             */
+            bool exportTrace(const std::string& filePath);
+
+        private:
+            struct Phase
+            {
+                    std::string name;
+                    double start;
+                    double end;
+                    // Index into m_threads, the main thread is 0
+                    int thread;
+                    int depth;
+            };
+
+            double getTime() const;
+
+            std::chrono::steady_clock::time_point m_startTime;
+            std::vector<Phase> m_phases;
+            std::mutex m_mutex;
+            std::string m_exportPath;
+            std::vector<std::thread::id> m_threads;
+            double m_timeToFirstFrame;
+            bool m_isRecording;
+    };
+} // namespace Engine
@@ -1,6 +1,7 @@
 #include "WindowManager.h"
 
 #include "EngineManager.h"
+#include "StartupTrace.h"
 #include "WindowEventCallbackHelper.h"
 
 #include <imgui.h>
@@ -35,33 +36,39 @@ namespace Engine
 
     bool WindowManager::startWindow()
     {
-        // Initialise GLFW
-        if(!glfwInit())
+        const std::shared_ptr<StartupTrace> startupTrace = SingletonManager::get<StartupTrace>();
         {
-            fprintf(stderr, "Failed to initialize GLFW!\n");
-            return false;
-        }
-
-        glfwWindowHint(GLFW_SAMPLES, m_textureSamples); // Anti-Aliasing
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);  // Use version 3.3
-        glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
-        glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
-        glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
-
-        m_gameWindow = glfwCreateWindow(
-                (int)m_windowDimensions.x,
-                (int)m_windowDimensions.y,
-                m_windowTitle.c_str(),
-                nullptr,
-                nullptr
-        );
-        if(m_gameWindow == nullptr)
-        {
-            fprintf(stderr, "Failed to open GLFW window...\n");
-            glfwTerminate();
-            return false;
+            StartupTrace::Scope phase(startupTrace, "create window");
+
+            // Initialise GLFW
+            if(!glfwInit())
+            {
+                fprintf(stderr, "Failed to initialize GLFW!\n");
+                return false;
+            }
+
+            glfwWindowHint(GLFW_SAMPLES, m_textureSamples); // Anti-Aliasing
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MAJOR, 3);  // Use version 3.3
+            glfwWindowHint(GLFW_CONTEXT_VERSION_MINOR, 3);
+            glfwWindowHint(GLFW_OPENGL_FORWARD_COMPAT, GL_TRUE);
+            glfwWindowHint(GLFW_OPENGL_PROFILE, GLFW_OPENGL_CORE_PROFILE);
+
+            m_gameWindow = glfwCreateWindow(
+                    (int)m_windowDimensions.x,
+                    (int)m_windowDimensions.y,
+                    m_windowTitle.c_str(),
+                    nullptr,
+                    nullptr
+            );
+            if(m_gameWindow == nullptr)
+            {
+                fprintf(stderr, "Failed to open GLFW window...\n");
+                glfwTerminate();
+                return false;
+            }
         }
 
+        StartupTrace::Scope phase(startupTrace, "GL init");
         glfwMakeContextCurrent(m_gameWindow); // Initiate GLEW
         glewExperimental = true;              // Needed in the core profile
         if(glewInit() != GLEW_OK)
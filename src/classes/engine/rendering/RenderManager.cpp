@@ -1,11 +1,27 @@
 
 #include "RenderManager.h"
 
+#include "../../helper/BlockCompression.h"
 #include "../../helper/FileLoading.h"
+#include "../../helper/HashUtils.h"
+#include "../../helper/MeshCache.h"
+#include "../../helper/MeshOptimizer.h"
+#include "../../helper/ProgramCache.h"
+#include "../../helper/TextureAtlas.h"
+#include "../../helper/TextureCache.h"
+#include "../../helper/TriangleOrderHelper.h"
 #include "../../helper/VertexIndexingHelper.h"
+#include "../JobSystem.h"
+#include "../StartupTrace.h"
 #include "ShaderLoader.h"
 
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <future>
 #include <iostream>
+#include <mutex>
 #include <string>
 #include <utility>
 
@@ -13,172 +29,1326 @@ namespace Engine
 {
 
     RenderManager::RenderManager()
-        : m_objectList(std::map<std::string, std::shared_ptr<ObjectData>>())
+        : m_objectList(AssetRegistry<ObjectData>())
         , m_shaderList(std::map<std::string, GLuint>())
-        , m_textureList(std::map<std::string, GLuint>())
+        , m_pendingShaders(std::unordered_map<GLuint, PendingShader>())
+        , m_textureList(AssetRegistry<TextureData>())
         , m_ambientLightUbo(nullptr)
         , m_diffuseLightUbo(nullptr)
+        , m_clusteredLighting(nullptr)
         , m_showWireframe(false)
+        , m_vertexFormat(VertexFormat::SNORM16_POSITIONS)
+        , m_compressTextures(true)
+        , m_uploadQueue(std::make_shared<UploadQueue>())
+        , m_textureStreamer(std::make_shared<TextureStreamer>())
+        , m_uniformRing(std::make_shared<UniformRing>())
+        , m_uploadBudget(0.002)
+        , m_gpuMemoryBudget(0)
+        , m_frameIndex(0)
     {
         m_ambientLightUbo = std::make_shared<Lighting::AmbientLightUbo>();
         m_diffuseLightUbo = std::make_shared<Lighting::DiffuseLightUbo>();
+        m_clusteredLighting = std::make_shared<Lighting::ClusteredLighting>();
+
+        EnableParallelShaderCompile();
+    }
+
+    /**
+     * CPU side result of importing a mesh, either the mapped cache file or the freshly encoded streams.
+     */
+    struct MeshImport
+    {
+            MeshCacheFile cache;
+            bool isCached = false;
+            std::vector<uint8_t> vertexData;
+            std::vector<uint8_t> indexData;
+            unsigned int indexWidth = 2;
+            bool hasUvs = false;
+            bool hasNormals = false;
+            VertexFormat vertexFormat = VertexFormat::FLOAT32;
+            glm::vec3 boundsMin = glm::vec3(0.f);
+            glm::vec3 boundsMax = glm::vec3(0.f);
+
+            std::vector<glm::vec3> vertices;
+            std::vector<glm::vec2> uvs;
+            std::vector<glm::vec3> normals;
+            std::vector<triData> indices;
+    };
+
+    /**
+     * Meshes loaded from the cache are uploaded straight from the mapping, their CPU data is only decoded
+     * once something needs it. Freshly imported meshes already have it, nothing is done for them.
+     */
+    static void decodeMeshCache(MeshImport& mesh)
+    {
+        if(!mesh.isCached || !mesh.vertices.empty())
+        {
+            return;
+        }
+
+        const MeshCacheFile& meshCache = mesh.cache;
+        decodeVertices(
+                meshCache.getVertexData(),
+                meshCache.getVertexCount(),
+                mesh.vertexFormat,
+                mesh.boundsMin,
+                mesh.boundsMax,
+                mesh.vertices,
+                mesh.uvs,
+                mesh.normals
+        );
+        unpackIndices(meshCache.getIndexData(), meshCache.getTriangleCount(), mesh.indexWidth, mesh.indices);
+    }
+
+    /**
+     * @return True if a mesh keeps CPU data from the start, automatic retention restores it on demand
+     */
+    static bool keepsCpuData(MeshRetention retention)
+    {
+        return retention == MeshRetention::FULL || retention == MeshRetention::POSITIONS_AND_INDICES;
+    }
+
+    /**
+     * Meshes and textures loading since RenderManager::preloadAssets, taken by the first registration of
+     * their path. Textures are stored with the compression setting they were decoded with.
+     */
+    struct PreloadedAssets
+    {
+            std::mutex mutex;
+            std::unordered_map<std::string, std::shared_future<std::shared_ptr<MeshImport>>> meshes;
+            std::unordered_map<std::string, std::pair<bool, std::shared_future<std::shared_ptr<ImageData>>>>
+                    textures;
+    };
+
+    static PreloadedAssets s_preloadedAssets;
+
+    /**
+     * Takes the preloaded import of a mesh, waits for it if it's still loading.
+     *
+     * @return The import, nullptr if the mesh wasn't preloaded, failed to load or has another vertex format
+     */
+    static std::shared_ptr<MeshImport> takePreloadedMesh(
+            const std::string& filePath,
+            VertexFormat vertexFormat
+    )
+    {
+        std::shared_future<std::shared_ptr<MeshImport>> preloaded;
+        {
+            std::lock_guard<std::mutex> lock(s_preloadedAssets.mutex);
+            const auto& mesh = s_preloadedAssets.meshes.find(filePath);
+            if(mesh == s_preloadedAssets.meshes.end())
+            {
+                return nullptr;
+            }
+
+            preloaded = mesh->second;
+            s_preloadedAssets.meshes.erase(mesh);
+        }
+
+        std::shared_ptr<MeshImport> mesh = preloaded.get();
+        return mesh && mesh->vertexFormat == vertexFormat ? mesh : nullptr;
     }
 
-    std::shared_ptr<ObjectData> RenderManager::registerObject(const char* filePath)
+    /**
+     * Takes the preloaded image of a texture, waits for it if it's still decoding.
+     *
+     * @return The image, nullptr if the texture wasn't preloaded, failed to decode or was decoded with
+     * another compression setting
+     */
+    static std::shared_ptr<ImageData> takePreloadedTexture(const std::string& filePath, bool compress)
     {
-        for(auto& object : m_objectList)
+        std::pair<bool, std::shared_future<std::shared_ptr<ImageData>>> preloaded;
         {
-            if(object.first == filePath)
+            std::lock_guard<std::mutex> lock(s_preloadedAssets.mutex);
+            const auto& texture = s_preloadedAssets.textures.find(filePath);
+            if(texture == s_preloadedAssets.textures.end())
             {
-                return object.second;
+                return nullptr;
             }
+
+            preloaded = texture->second;
+            s_preloadedAssets.textures.erase(texture);
         }
 
-        std::vector<glm::vec3> vertexData, vertexNormals;
-        std::vector<glm::vec2> uvData;
+        std::shared_ptr<ImageData> image = preloaded.second.get();
+        return preloaded.first == compress ? image : nullptr;
+    }
 
-        if(!loadFileOBJ(filePath, vertexData, uvData, vertexNormals))
+    void RenderManager::preloadAssets(const BootAssets& assets)
+    {
+        const std::shared_ptr<JobSystem> jobSystem = SingletonManager::get<JobSystem>();
+        const std::shared_ptr<StartupTrace> trace = SingletonManager::get<StartupTrace>();
+
+        std::lock_guard<std::mutex> lock(s_preloadedAssets.mutex);
+        const ObjTaskRunner runTasks = makeTaskRunner(jobSystem);
+        for(const std::string& path : assets.meshes)
         {
-            return nullptr;
+            auto promise = std::make_shared<std::promise<std::shared_ptr<MeshImport>>>();
+            s_preloadedAssets.meshes[path] = promise->get_future().share();
+            jobSystem->addJob(
+                    [promise, trace, path, runTasks, vertexFormat = assets.vertexFormat]()
+                    {
+                        StartupTrace::Scope phase(trace, "preload mesh " + path);
+                        std::shared_ptr<MeshImport> mesh = std::make_shared<MeshImport>();
+                        const bool imported = importMesh(path.c_str(), vertexFormat, *mesh, runTasks);
+                        promise->set_value(imported ? mesh : nullptr);
+                    }
+            );
         }
 
-        std::vector<triData> triIndexData;
+        for(const std::string& path : assets.textures)
+        {
+            auto promise = std::make_shared<std::promise<std::shared_ptr<ImageData>>>();
+            s_preloadedAssets.textures[path] = { assets.compressTextures, promise->get_future().share() };
+            jobSystem->addJob(
+                    [promise, trace, path, compress = assets.compressTextures]()
+                    {
+                        StartupTrace::Scope phase(trace, "preload texture " + path);
+                        std::shared_ptr<ImageData> image = std::make_shared<ImageData>();
+                        promise->set_value(decodeTexture(path.c_str(), compress, *image) ? image : nullptr);
+                    }
+            );
+        }
+    }
+
+    /**
+     * Drops the entries of assets whose handles have all been released.
+     */
+    template<typename T>
+    static void pruneAssets(AssetRegistry<T>& registry)
+    {
+        std::erase_if(registry, [](const auto& elem) { return elem.second.expired(); });
+    }
 
-        indexVBO(vertexData, uvData, vertexNormals, triIndexData);
+    /**
+     * Looks up a registered asset that still has handles.
+     *
+     * @return The asset, nullptr if it isn't registered or all its handles have been released
+     */
+    template<typename T>
+    static std::shared_ptr<T> findAsset(
+            const AssetRegistry<T>& registry,
+            const AssetKey& key,
+            const char* filePath
+    )
+    {
+        const auto [begin, end] = registry.equal_range(key);
+        for(auto registered = begin; registered != end; ++registered)
+        {
+            std::shared_ptr<T> asset = registered->second.lock();
+            if(asset && asset->m_filePath == filePath)
+            {
+                return asset;
+            }
+        }
 
-        GLuint vertexBuffer = !vertexData.empty() ? createBuffer(vertexData) : -1;
-        GLuint uvBuffer = !uvData.empty() ? createBuffer(uvData) : -1;
-        GLuint normalBuffer = !vertexNormals.empty() ? createBuffer(vertexNormals) : -1;
-        GLuint indexBuffer = !triIndexData.empty() ? createBuffer(triIndexData) : -1;
+        return nullptr;
+    }
+
+    /**
+     * Adds an asset to the registry, next to any asset whose path hashes to the same key.
+     */
+    template<typename T>
+    static void addAsset(AssetRegistry<T>& registry, const AssetKey& key, const std::shared_ptr<T>& asset)
+    {
+        pruneAssets(registry);
 
-        std::shared_ptr<ObjectData> newObject = std::make_shared<ObjectData>(
+        const auto [begin, end] = registry.equal_range(key);
+        for(auto registered = begin; registered != end; ++registered)
+        {
+            if(registered->second.lock() == asset)
+            {
+                return;
+            }
+        }
+        registry.emplace(key, asset);
+    }
+
+    ObjTaskRunner RenderManager::makeTaskRunner(std::shared_ptr<JobSystem> jobSystem)
+    {
+        return [jobSystem = std::move(jobSystem)](size_t count, const std::function<void(size_t)>& task)
+        { jobSystem->runTasks(count, task); };
+    }
+
+    bool RenderManager::importMesh(
+            const char* filePath,
+            VertexFormat vertexFormat,
+            MeshImport& mesh,
+            const ObjTaskRunner& runTasks
+    )
+    {
+        mesh.vertexFormat = vertexFormat;
+
+        MeshCacheFile& meshCache = mesh.cache;
+        if(meshCache.open(filePath) && meshCache.getVertexFormat() == vertexFormat)
+        {
+            // The GPU buffers are filled straight from the mapped cache pages, see decodeMeshCache
+            mesh.isCached = true;
+            mesh.indexWidth = meshCache.getIndexWidth();
+            mesh.hasUvs = meshCache.hasUvs();
+            mesh.hasNormals = meshCache.hasNormals();
+            mesh.boundsMin = meshCache.getBoundsMin();
+            mesh.boundsMax = meshCache.getBoundsMax();
+            return true;
+        }
+
+        if(!loadFileOBJ(filePath, mesh.vertices, mesh.uvs, mesh.normals, runTasks))
+        {
+            return false;
+        }
+
+        mesh.hasUvs = !mesh.uvs.empty();
+        mesh.hasNormals = !mesh.normals.empty();
+
+        indexVBO(mesh.vertices, mesh.uvs, mesh.normals, mesh.indices);
+        optimizeMesh(filePath, mesh.vertices, mesh.uvs, mesh.normals, mesh.indices);
+
+        std::vector<PackedVertex> interleavedData;
+        interleaveVertices(mesh.vertices, mesh.uvs, mesh.normals, interleavedData);
+
+        mesh.boundsMin = mesh.vertices.empty() ? glm::vec3(0.f) : mesh.vertices[0];
+        mesh.boundsMax = mesh.boundsMin;
+        for(const auto& vertex : mesh.vertices)
+        {
+            mesh.boundsMin = glm::min(mesh.boundsMin, vertex);
+            mesh.boundsMax = glm::max(mesh.boundsMax, vertex);
+        }
+
+        encodeVertices(interleavedData, vertexFormat, mesh.boundsMin, mesh.boundsMax, mesh.vertexData);
+
+        // 16 bit indices whenever they can address every vertex
+        mesh.indexWidth = getIndexWidth(mesh.vertices.size());
+        packIndices(mesh.indices, mesh.indexWidth, mesh.indexData);
+
+        uint32_t flags = mesh.hasUvs ? MESH_CACHE_FLAG_UVS : 0;
+        flags |= mesh.hasNormals ? MESH_CACHE_FLAG_NORMALS : 0;
+        const bool cacheWritten = writeMeshCache(
                 filePath,
-                vertexBuffer,
-                uvBuffer,
-                normalBuffer,
-                indexBuffer,
-                vertexData,
-                uvData,
-                vertexNormals,
-                triIndexData
+                mesh.vertexData,
+                vertexFormat,
+                mesh.boundsMin,
+                mesh.boundsMax,
+                mesh.indexData,
+                mesh.indexWidth,
+                flags
         );
+        if(!cacheWritten)
+        {
+            std::cout << "Couldn't write mesh cache [" << filePath << "]" << std::endl;
+        }
 
-        m_objectList[filePath] = newObject;
+        return true;
+    }
+
+    void RenderManager::uploadMesh(MeshImport& mesh, ObjectData& object)
+    {
+        const void* vertexData = mesh.isCached ? mesh.cache.getVertexData() : mesh.vertexData.data();
+        const size_t vertexDataSize = mesh.isCached ? mesh.cache.getVertexDataSize() : mesh.vertexData.size();
+        const void* indexData = mesh.isCached ? mesh.cache.getIndexData() : mesh.indexData.data();
+        const size_t indexDataSize = mesh.isCached ? mesh.cache.getIndexDataSize() : mesh.indexData.size();
+
+        object.m_vertexBuffer = vertexDataSize > 0 ? createBuffer(vertexData, vertexDataSize) : -1;
+        object.m_indexBuffer = indexDataSize > 0 ? createBuffer(indexData, indexDataSize) : -1;
+        object.m_indexWidth = mesh.indexWidth;
+        object.m_hasUvs = mesh.hasUvs;
+        object.m_hasNormals = mesh.hasNormals;
+        object.m_vertexData = std::move(mesh.vertices);
+        object.m_vertexUvs = std::move(mesh.uvs);
+        object.m_vertexNormals = std::move(mesh.normals);
+        object.m_vertexIndices = std::move(mesh.indices);
+        if(mesh.isCached)
+        {
+            object.m_vertexCount = mesh.cache.getVertexCount();
+            object.m_triangleCount = mesh.cache.getTriangleCount();
+        }
+        else
+        {
+            object.m_vertexCount = object.m_vertexData.size();
+            object.m_triangleCount = object.m_vertexIndices.size();
+        }
+        // Cached meshes that weren't decoded start without CPU data, restoreCpuDataAsync loads it on demand
+        const bool hasCpuData = object.m_vertexData.size() == object.m_vertexCount;
+        object.m_retainedData = hasCpuData ? MeshRetention::FULL : MeshRetention::NONE;
+        object.m_vertexFormat = mesh.vertexFormat;
+        object.m_dequantization = getDequantizationMatrix(mesh.vertexFormat, mesh.boundsMin, mesh.boundsMax);
+        // Buffers are only uploaded into objects that aren't resident, baked triangle orders may be left
+        object.m_gpuBytes += vertexDataSize + indexDataSize;
+        object.m_isResident = true;
+        object.m_isLoading = false;
+        object.m_loadFailed = false;
+        object.m_restoreFailed = false;
+
+        // An explicit retention applies right away, an automatic one once the mesh has been drawn
+        if(hasCpuData)
+        {
+            object.releaseCpuData(object.m_retention);
+        }
+    }
+
+    void RenderManager::restoreCpuDataAsync(const MeshHandle& obj)
+    {
+        if(obj->hasPositions() || obj->m_isRestoring || obj->m_restoreFailed)
+        {
+            return;
+        }
+        obj->m_isRestoring = true;
+
+        std::weak_ptr<ObjectData> object = obj;
+        std::shared_ptr<UploadQueue> uploadQueue = m_uploadQueue;
+        const std::shared_ptr<JobSystem> jobSystem = SingletonManager::get<JobSystem>();
+        jobSystem->addJob(
+                [object,
+                 uploadQueue,
+                 path = obj->m_filePath,
+                 vertexFormat = obj->m_vertexFormat,
+                 runTasks = makeTaskRunner(jobSystem)]()
+                {
+                    std::shared_ptr<MeshImport> mesh = std::make_shared<MeshImport>();
+                    const bool imported = importMesh(path.c_str(), vertexFormat, *mesh, runTasks);
+                    if(imported)
+                    {
+                        decodeMeshCache(*mesh);
+                    }
+
+                    uploadQueue->push(
+                            [object, mesh, imported]()
+                            {
+                                const std::shared_ptr<ObjectData> target = object.lock();
+                                if(!target)
+                                {
+                                    return true;
+                                }
+
+                                target->m_isRestoring = false;
+                                if(!target->m_isResident || target->hasPositions())
+                                {
+                                    return true;
+                                }
+
+                                // A failed restore isn't retried every frame, only a new upload resets it
+                                if(!imported || mesh->indices.size() != target->m_triangleCount)
+                                {
+                                    std::cout << "Couldn't restore mesh data [" << target->m_filePath << "]"
+                                              << std::endl;
+                                    target->m_restoreFailed = true;
+                                    return true;
+                                }
+
+                                target->m_vertexData = std::move(mesh->vertices);
+                                target->m_vertexIndices = std::move(mesh->indices);
+                                target->m_retainedData = MeshRetention::POSITIONS_AND_INDICES;
+                                return true;
+                            }
+                    );
+                }
+        );
+    }
+
+    void RenderManager::applyRetention(ObjectData& object, bool needsPositions)
+    {
+        object.m_needsPositions = object.m_needsPositions || needsPositions;
+
+        if(object.m_retention == MeshRetention::AUTOMATIC && object.m_retainedData == MeshRetention::FULL)
+        {
+            object.releaseCpuData(
+                    object.m_needsPositions ? MeshRetention::POSITIONS_AND_INDICES : MeshRetention::NONE
+            );
+        }
+    }
+
+    void RenderManager::clearPreloadedAssets()
+    {
+        std::lock_guard<std::mutex> lock(s_preloadedAssets.mutex);
+        s_preloadedAssets.meshes.clear();
+        s_preloadedAssets.textures.clear();
+    }
+
+    MeshHandle RenderManager::registerObject(const char* filePath)
+    {
+        const AssetKey key = makeAssetKey(filePath);
+        MeshHandle newObject = findAsset(m_objectList, key, filePath);
+        if(newObject && newObject->m_isResident)
+        {
+            return newObject;
+        }
+        // A registered object that isn't resident is still loading asynchronously or has been evicted,
+        // it's loaded right away instead and a pending upload is skipped
+
+        const std::shared_ptr<StartupTrace> trace = SingletonManager::get<StartupTrace>();
+        StartupTrace::Scope phase(trace, std::string("load mesh ") + filePath);
+        std::shared_ptr<MeshImport> mesh = takePreloadedMesh(filePath, m_vertexFormat);
+        if(!mesh)
+        {
+            mesh = std::make_shared<MeshImport>();
+            const ObjTaskRunner runTasks = makeTaskRunner(SingletonManager::get<JobSystem>());
+            if(!importMesh(filePath, m_vertexFormat, *mesh, runTasks))
+            {
+                return nullptr;
+            }
+        }
+
+        if(!newObject)
+        {
+            newObject = std::make_shared<ObjectData>(filePath);
+        }
+        if(keepsCpuData(newObject->m_retention))
+        {
+            decodeMeshCache(*mesh);
+        }
+        uploadMesh(*mesh, *newObject);
+        newObject->m_lastUsedFrame = m_frameIndex;
+
+        addAsset(m_objectList, key, newObject);
 
         return newObject;
     }
 
-    void RenderManager::deregisterObject(std::shared_ptr<ObjectData>& obj)
+    MeshHandle RenderManager::registerObjectAsync(const char* filePath)
     {
-        std::erase_if(
-                m_objectList,
-                [&obj](const auto& elem)
+        const AssetKey key = makeAssetKey(filePath);
+        if(MeshHandle registered = findAsset(m_objectList, key, filePath))
+        {
+            return registered;
+        }
+
+        MeshHandle newObject = std::make_shared<ObjectData>(filePath);
+        newObject->m_lastUsedFrame = m_frameIndex;
+        addAsset(m_objectList, key, newObject);
+
+        loadObjectAsync(newObject);
+
+        return newObject;
+    }
+
+    void RenderManager::loadObjectAsync(const MeshHandle& obj)
+    {
+        obj->m_isLoading = true;
+
+        std::weak_ptr<ObjectData> object = obj;
+        std::shared_ptr<UploadQueue> uploadQueue = m_uploadQueue;
+        const VertexFormat vertexFormat = m_vertexFormat;
+        std::shared_ptr<StartupTrace> trace = SingletonManager::get<StartupTrace>();
+        const std::shared_ptr<JobSystem> jobSystem = SingletonManager::get<JobSystem>();
+        jobSystem->addJob(
+                [object,
+                 uploadQueue,
+                 vertexFormat,
+                 trace,
+                 path = obj->m_filePath,
+                 decode = keepsCpuData(obj->m_retention),
+                 runTasks = makeTaskRunner(jobSystem)]()
                 {
-                    const bool shouldRemove = elem.second == obj;
-                    if(shouldRemove)
+                    std::shared_ptr<MeshImport> mesh = takePreloadedMesh(path, vertexFormat);
+                    if(!mesh)
                     {
-                        GLuint buffer[1] = { obj->m_vertexBuffer };
-                        glDeleteBuffers(1, buffer);
+                        StartupTrace::Scope phase(trace, "import mesh " + path);
+                        mesh = std::make_shared<MeshImport>();
+                        if(!importMesh(path.c_str(), vertexFormat, *mesh, runTasks))
+                        {
+                            uploadQueue->push(
+                                    [object]()
+                                    {
+                                        const std::shared_ptr<ObjectData> target = object.lock();
+                                        if(target && !target->m_isResident)
+                                        {
+                                            std::cout << "Couldn't load mesh [" << target->m_filePath << "]"
+                                                      << std::endl;
+                                            target->m_isLoading = false;
+                                            target->m_loadFailed = true;
+                                        }
+                                        return true;
+                                    }
+                            );
+                            return;
+                        }
                     }
-                    return shouldRemove;
+                    if(decode)
+                    {
+                        decodeMeshCache(*mesh);
+                    }
+
+                    uploadQueue->push(
+                            [object, mesh]()
+                            {
+                                const std::shared_ptr<ObjectData> target = object.lock();
+                                if(target && !target->m_isResident)
+                                {
+                                    uploadMesh(*mesh, *target);
+                                }
+                                return true;
+                            }
+                    );
                 }
         );
     }
 
-    void RenderManager::clearObjects()
+    void RenderManager::deregisterObject(MeshHandle& obj)
     {
-        for(auto& obj : m_objectList)
+        obj.reset();
+        pruneAssets(m_objectList);
+    }
+
+    void RenderManager::clearObjects() { m_objectList.clear(); }
+
+    std::vector<MeshHandle> RenderManager::getObjects() const
+    {
+        std::vector<MeshHandle> objects;
+        for(const auto& elem : m_objectList)
+        {
+            if(MeshHandle object = elem.second.lock())
+            {
+                objects.push_back(std::move(object));
+            }
+        }
+        return objects;
+    }
+
+    void RenderManager::bakeTriangleOrders(const MeshHandle& obj, int resolution /* = 4 */)
+    {
+        if(!obj || !obj->m_isResident || obj->m_triangleCount == 0 || resolution < 1)
+        {
+            return;
+        }
+
+        if(obj->m_triangleOrderResolution == resolution || obj->m_isBakingTriangleOrders ||
+           obj->m_triangleOrdersRejected)
         {
-            GLuint buffer[1] = { obj.second->m_vertexBuffer };
-            glDeleteBuffers(1, buffer);
+            return;
         }
-        m_objectList.clear();
+
+        // The orders may take at most a quarter of the GPU memory budget
+        const size_t orderCount = size_t(getTriangleOrderCount(resolution));
+        const size_t ordersBytes = orderCount * obj->m_triangleCount * 3 * obj->m_indexWidth;
+        if(obj->m_triangleCount > TRIANGLE_ORDER_MAX_TRIANGLES ||
+           (m_gpuMemoryBudget != 0 && ordersBytes > m_gpuMemoryBudget / 4))
+        {
+            std::cout << "Triangle orders too large, sorting at runtime [" << obj->m_filePath << "]"
+                      << std::endl;
+            obj->m_triangleOrdersRejected = true;
+            return;
+        }
+
+        // Released positions are loaded in the background, the orders are baked by a later call
+        if(!obj->hasPositions())
+        {
+            restoreCpuDataAsync(obj);
+            return;
+        }
+        obj->m_isBakingTriangleOrders = true;
+
+        // Sorting every direction takes a while, the worker gets its own copy of the positions
+        std::weak_ptr<ObjectData> object = obj;
+        std::shared_ptr<UploadQueue> uploadQueue = m_uploadQueue;
+        SingletonManager::get<JobSystem>()->addJob(
+                [object,
+                 uploadQueue,
+                 resolution,
+                 path = obj->m_filePath,
+                 indexWidth = obj->m_indexWidth,
+                 vertices = obj->m_vertexData,
+                 indices = obj->m_vertexIndices]()
+                {
+                    const uint64_t meshHash = hashVector(indices, hashVector(vertices));
+                    const size_t triangleCount = indices.size();
+
+                    std::vector<triData> orders;
+                    glm::vec3 center;
+                    const char* filePath = path.c_str();
+                    if(!loadTriangleOrderCache(filePath, meshHash, resolution, triangleCount, center, orders))
+                    {
+                        computeTriangleOrders(vertices, indices, resolution, center, orders);
+                        if(!saveTriangleOrderCache(filePath, meshHash, resolution, center, orders))
+                        {
+                            std::cout << "Couldn't write triangle order cache [" << path << "]" << std::endl;
+                        }
+                    }
+
+                    auto orderData = std::make_shared<std::vector<uint8_t>>();
+                    packIndices(orders, indexWidth, *orderData);
+
+                    uploadQueue->push(
+                            [object, orderData, center, resolution, indexWidth]()
+                            {
+                                const std::shared_ptr<ObjectData> target = object.lock();
+                                if(!target)
+                                {
+                                    return true;
+                                }
+
+                                // The mesh may have been evicted or replaced while the orders were baked
+                                target->m_isBakingTriangleOrders = false;
+                                const size_t orderBytes = target->m_triangleCount * 3 * target->m_indexWidth;
+                                const size_t orderCount = size_t(getTriangleOrderCount(resolution));
+                                if(!target->m_isResident || target->m_indexWidth != indexWidth ||
+                                   orderData->size() != orderCount * orderBytes)
+                                {
+                                    return true;
+                                }
+
+                                if(target->m_triangleOrderBuffer != 0)
+                                {
+                                    glDeleteBuffers(1, &target->m_triangleOrderBuffer);
+                                    const size_t oldResolution = size_t(target->m_triangleOrderResolution);
+                                    const size_t oldOrderCount = 6 * oldResolution * oldResolution;
+                                    const size_t oldBytes = oldOrderCount * orderBytes;
+                                    target->m_gpuBytes -= std::min(target->m_gpuBytes, oldBytes);
+                                }
+
+                                target->m_triangleOrderBuffer = createBuffer(*orderData);
+                                target->m_gpuBytes += orderData->size();
+                                target->m_triangleOrderResolution = resolution;
+                                target->m_triangleOrderCenter = center;
+                                return true;
+                            }
+                    );
+                }
+        );
     }
 
-    GLuint RenderManager::registerTexture(const char* filePath)
+    bool RenderManager::decodeTexture(const char* filePath, bool compress, ImageData& image)
     {
         std::string filePathString = std::string(filePath);
         size_t dotIndex = filePathString.find_last_of('.');
         if(dotIndex == std::string::npos)
         {
             std::cout << "Texture path " << filePath << " broken" << std::endl;
-            return -1;
+            return false;
         }
 
-        for(auto& object : m_textureList)
+        std::string fileExtension = filePathString.substr(dotIndex + 1);
+        if(fileExtension == "bmp" || fileExtension == "BMP" || fileExtension == "tga" ||
+           fileExtension == "TGA" || fileExtension == "png" || fileExtension == "PNG")
         {
-            if(object.first == filePath)
+            if(!compress)
             {
-                return object.second;
+                return decodeFileImage(filePath, image);
             }
-        }
 
-        std::string fileExtension = filePathString.substr(dotIndex + 1);
-        if(fileExtension == "bmp" || fileExtension == "BMP")
-        {
-            GLuint textureId = loadFileBMP(filePath);
-            m_textureList[filePath] = textureId;
-            return textureId;
+            if(isTextureCacheFresh(filePath) && decodeFileDDS(getTextureCachePath(filePath).c_str(), image))
+            {
+                return true;
+            }
+
+            image = ImageData();
+            if(!decodeFileImage(filePath, image) || !compressImage(image))
+            {
+                return false;
+            }
+
+            if(!writeTextureCache(filePath, image))
+            {
+                std::cout << "Couldn't write texture cache [" << filePath << "]" << std::endl;
+            }
+            return true;
         }
         else if(fileExtension == "dds" || fileExtension == "DDS")
         {
-            GLuint textureId = loadFileDDS(filePath);
-            m_textureList[filePath] = textureId;
-            return textureId;
+            return decodeFileDDS(filePath, image);
         }
-        else if(fileExtension == "tga" || fileExtension == "TGA")
+        else if(fileExtension == "ktx2" || fileExtension == "KTX2")
         {
-            // TODO: make it possible to use TGA texture files
+            return decodeFileKTX2(filePath, image);
         }
 
         std::cout << "Texture extension of " << filePath << " not valid" << std::endl;
-        return -1;
+        return false;
     }
 
-    void RenderManager::deregisterTexture(GLuint tex)
+    TextureHandle RenderManager::registerTexture(const char* filePath)
     {
-        std::erase_if(
-                m_textureList,
-                [&tex](const auto& elem)
+        const AssetKey key = makeAssetKey(filePath);
+        TextureHandle texture = findAsset(m_textureList, key, filePath);
+        if(texture && texture->m_isResident)
+        {
+            return texture;
+        }
+        // A registered texture that isn't resident is still loading asynchronously or has been evicted,
+        // it's loaded right away instead and a pending upload is skipped
+
+        const std::shared_ptr<StartupTrace> trace = SingletonManager::get<StartupTrace>();
+        StartupTrace::Scope phase(trace, std::string("load texture ") + filePath);
+        std::shared_ptr<ImageData> image = takePreloadedTexture(filePath, m_compressTextures);
+        if(!image)
+        {
+            image = std::make_shared<ImageData>();
+            if(!decodeTexture(filePath, m_compressTextures, *image))
+            {
+                return nullptr;
+            }
+        }
+
+        if(!texture)
+        {
+            texture = std::make_shared<TextureData>(filePath);
+        }
+        uploadTexture(*image, *texture);
+        texture->m_lastUsedFrame = m_frameIndex;
+
+        addAsset(m_textureList, key, texture);
+        return texture;
+    }
+
+    TextureHandle RenderManager::registerTextureAsync(const char* filePath)
+    {
+        const AssetKey key = makeAssetKey(filePath);
+        if(TextureHandle registered = findAsset(m_textureList, key, filePath))
+        {
+            return registered;
+        }
+
+        TextureHandle newTexture = std::make_shared<TextureData>(filePath);
+        newTexture->m_lastUsedFrame = m_frameIndex;
+        addAsset(m_textureList, key, newTexture);
+
+        loadTextureAsync(newTexture);
+
+        return newTexture;
+    }
+
+    TextureAtlas RenderManager::buildTextureAtlas(
+            const std::string& atlasPath,
+            const std::vector<std::string>& filePaths,
+            int maxSize /* = 4096 */
+    )
+    {
+        std::vector<ImageData> images;
+        if(!decodeImageFiles(filePaths, images))
+        {
+            return {};
+        }
+
+        std::vector<glm::ivec2> sizes;
+        std::vector<const ImageData*> sources;
+        for(const ImageData& image : images)
+        {
+            sizes.emplace_back(image.levels[0].width, image.levels[0].height);
+            sources.push_back(&image);
+        }
+
+        std::vector<AtlasRect> rects;
+        const glm::ivec2 atlasSize = packAtlasRects(sizes, maxSize, rects);
+        if(atlasSize.x == 0)
+        {
+            std::cout << "Textures don't fit into a " << maxSize << " texel atlas [" << atlasPath << "]"
+                      << std::endl;
+            return {};
+        }
+
+        ImageData atlasImage;
+        std::vector<TextureRegion> regions;
+        buildAtlasImage(sources, rects, atlasSize, atlasImage, regions);
+
+        TextureAtlas atlas;
+        for(size_t i = 0; i < filePaths.size(); i++)
+        {
+            atlas.regions[filePaths[i]] = regions[i];
+        }
+        atlas.texture = registerBuiltTexture(atlasPath, atlasImage);
+        return atlas;
+    }
+
+    TextureAtlas RenderManager::buildTextureArray(
+            const std::string& arrayPath,
+            const std::vector<std::string>& filePaths
+    )
+    {
+        std::vector<ImageData> images;
+        if(!decodeImageFiles(filePaths, images))
+        {
+            return {};
+        }
+
+        std::vector<const ImageData*> sources;
+        for(const ImageData& image : images)
+        {
+            sources.push_back(&image);
+        }
+
+        ImageData arrayImage;
+        if(!buildArrayImage(sources, arrayImage))
+        {
+            std::cout << "Textures of an array need the same size [" << arrayPath << "]" << std::endl;
+            return {};
+        }
+
+        TextureAtlas atlas;
+        for(size_t i = 0; i < filePaths.size(); i++)
+        {
+            atlas.regions[filePaths[i]].layer = int(i);
+        }
+        atlas.texture = registerBuiltTexture(arrayPath, arrayImage);
+        return atlas;
+    }
+
+    bool RenderManager::decodeImageFiles(
+            const std::vector<std::string>& filePaths,
+            std::vector<ImageData>& images
+    )
+    {
+        // Each file is decoded by whoever takes it first, the caller decodes the files no worker took.
+        // It only waits for decodes that are running, never for unrelated jobs queued on the JobSystem.
+        struct DecodeBatch
+        {
+                std::vector<std::string> filePaths;
+                std::vector<ImageData> images;
+                std::unique_ptr<bool[]> decoded;
+                std::atomic<size_t> nextFile = 0;
+                size_t finishedFiles = 0;
+                std::mutex mutex;
+                std::condition_variable finished;
+        };
+
+        auto batch = std::make_shared<DecodeBatch>();
+        batch->filePaths = filePaths;
+        batch->images.assign(filePaths.size(), ImageData());
+        batch->decoded = std::make_unique<bool[]>(filePaths.size());
+
+        const auto decodeRemainingFiles = [](DecodeBatch& batch)
+        {
+            for(size_t i = batch.nextFile++; i < batch.filePaths.size(); i = batch.nextFile++)
+            {
+                batch.decoded[i] = decodeFileImage(batch.filePaths[i].c_str(), batch.images[i]);
+
+                std::lock_guard<std::mutex> lock(batch.mutex);
+                if(++batch.finishedFiles == batch.filePaths.size())
                 {
-                    const bool shouldRemove = elem.second == tex;
-                    if(shouldRemove)
+                    batch.finished.notify_all();
+                }
+            }
+        };
+
+        const std::shared_ptr<JobSystem> jobSystem = SingletonManager::get<JobSystem>();
+        const size_t otherFiles = filePaths.empty() ? 0 : filePaths.size() - 1;
+        const size_t jobCount = std::min(jobSystem->getWorkerCount(), otherFiles);
+        for(size_t i = 0; i < jobCount; i++)
+        {
+            jobSystem->addJob([batch, decodeRemainingFiles]() { decodeRemainingFiles(*batch); });
+        }
+        decodeRemainingFiles(*batch);
+
+        {
+            std::unique_lock<std::mutex> lock(batch->mutex);
+            batch->finished.wait(
+                    lock,
+                    [&batch]() { return batch->finishedFiles == batch->filePaths.size(); }
+            );
+        }
+
+        images = std::move(batch->images);
+        for(size_t i = 0; i < filePaths.size(); i++)
+        {
+            if(!batch->decoded[i])
+            {
+                return false;
+            }
+        }
+        return !filePaths.empty();
+    }
+
+    TextureHandle RenderManager::registerBuiltTexture(const std::string& filePath, ImageData& image)
+    {
+        if(m_compressTextures)
+        {
+            compressImage(image);
+        }
+        if(!writeFileDDS(filePath, image))
+        {
+            // The texture still works, but can't be reloaded once it has been evicted
+            std::cout << "Couldn't write texture file [" << filePath << "]" << std::endl;
+        }
+
+        const AssetKey key = makeAssetKey(filePath);
+        TextureHandle texture = findAsset(m_textureList, key, filePath.c_str());
+        if(!texture)
+        {
+            texture = std::make_shared<TextureData>(filePath);
+            addAsset(m_textureList, key, texture);
+        }
+
+        // A texture built before from the same path is replaced, handles to it see the new one
+        texture->releaseTexture();
+        uploadTexture(image, *texture);
+        texture->m_lastUsedFrame = m_frameIndex;
+        return texture;
+    }
+
+    bool RenderManager::uploadTexture(
+            const ImageData& image,
+            TextureData& texture,
+            TextureStreamer* streamer /* = nullptr */
+    )
+    {
+        GLuint textureId;
+        if(!streamer)
+        {
+            textureId = uploadImage(image);
+        }
+        else if(!streamer->upload(image, textureId))
+        {
+            return false;
+        }
+
+        texture.m_textureId = textureId;
+        texture.m_target = image.target;
+        texture.m_gpuBytes = estimateImageBytes(image);
+        texture.m_isResident = true;
+        texture.m_isLoading = false;
+        texture.m_loadFailed = false;
+        return true;
+    }
+
+    void RenderManager::loadTextureAsync(const TextureHandle& tex)
+    {
+        tex->m_isLoading = true;
+
+        std::weak_ptr<TextureData> texture = tex;
+        std::shared_ptr<UploadQueue> uploadQueue = m_uploadQueue;
+        std::shared_ptr<TextureStreamer> textureStreamer = m_textureStreamer;
+        const bool compress = m_compressTextures;
+        std::shared_ptr<StartupTrace> trace = SingletonManager::get<StartupTrace>();
+        SingletonManager::get<JobSystem>()->addJob(
+                [texture, uploadQueue, textureStreamer, compress, trace, path = tex->m_filePath]()
+                {
+                    std::shared_ptr<ImageData> image = takePreloadedTexture(path, compress);
+                    if(!image)
                     {
-                        GLuint buffer[1] = { tex };
-                        glDeleteBuffers(1, buffer);
+                        StartupTrace::Scope phase(trace, "decode texture " + path);
+                        image = std::make_shared<ImageData>();
+                        if(!decodeTexture(path.c_str(), compress, *image))
+                        {
+                            uploadQueue->push(
+                                    [texture]()
+                                    {
+                                        const std::shared_ptr<TextureData> target = texture.lock();
+                                        if(target && !target->m_isResident)
+                                        {
+                                            std::cout << "Couldn't load texture [" << target->m_filePath
+                                                      << "]" << std::endl;
+                                            target->m_isLoading = false;
+                                            target->m_loadFailed = true;
+                                        }
+                                        return true;
+                                    }
+                            );
+                            return;
+                        }
                     }
-                    return shouldRemove;
+
+                    uploadQueue->push(
+                            [texture, image, textureStreamer]()
+                            {
+                                const std::shared_ptr<TextureData> target = texture.lock();
+                                if(target && !target->m_isResident)
+                                {
+                                    return uploadTexture(*image, *target, textureStreamer.get());
+                                }
+                                return true;
+                            }
+                    );
                 }
         );
     }
 
-    void RenderManager::clearTextures()
+    void RenderManager::beginFrame()
     {
-        for(auto& obj : m_textureList)
+        m_frameIndex++;
+
+        // Evict before uploading, so assets that arrive this frame get drawn before they can be evicted
+        enforceGpuMemoryBudget();
+        processUploads();
+
+        // Uniform blocks changed since the last frame are uploaded once, before anything is drawn
+        UboBlock::flushAll();
+        m_uniformRing->beginFrame();
+    }
+
+    bool RenderManager::requestResidency(
+            const MeshHandle& obj,
+            const TextureHandle& texture,
+            bool needsPositions /* = false */
+    )
+    {
+        bool isResident = true;
+        if(obj)
         {
-            GLuint buffer[1] = { obj.second };
-            glDeleteBuffers(1, buffer);
+            if(obj->m_isResident)
+            {
+                obj->m_lastUsedFrame = m_frameIndex;
+                applyRetention(*obj, needsPositions);
+                if(needsPositions)
+                {
+                    restoreCpuDataAsync(obj);
+                }
+            }
+            else
+            {
+                // A failed load isn't retried every frame, the asset stays non-resident
+                if(!obj->m_isLoading && !obj->m_loadFailed)
+                {
+                    loadObjectAsync(obj);
+                }
+                isResident = false;
+            }
+        }
+
+        if(texture)
+        {
+            if(texture->m_isResident)
+            {
+                texture->m_lastUsedFrame = m_frameIndex;
+            }
+            else
+            {
+                if(!texture->m_isLoading && !texture->m_loadFailed)
+                {
+                    loadTextureAsync(texture);
+                }
+                isResident = false;
+            }
+        }
+
+        return isResident;
+    }
+
+    size_t RenderManager::getGpuMemoryUsage() const
+    {
+        size_t usage = 0;
+        for(const MeshHandle& object : getObjects())
+        {
+            usage += object->m_gpuBytes;
+        }
+        for(const TextureHandle& texture : getTextures())
+        {
+            usage += texture->m_gpuBytes;
+        }
+        return usage;
+    }
+
+    void RenderManager::enforceGpuMemoryBudget()
+    {
+        if(m_gpuMemoryBudget == 0)
+        {
+            return;
+        }
+
+        size_t usage = getGpuMemoryUsage();
+        if(usage <= m_gpuMemoryBudget)
+        {
+            return;
+        }
+
+        // Assets drawn last frame are still in use and never evicted
+        struct EvictionCandidate
+        {
+                uint64_t lastUsedFrame;
+                MeshHandle object;
+                TextureHandle texture;
+        };
+
+        std::vector<EvictionCandidate> candidates;
+        for(MeshHandle& object : getObjects())
+        {
+            if(object->m_isResident && object->m_lastUsedFrame + 1 < m_frameIndex)
+            {
+                candidates.push_back({ object->m_lastUsedFrame, std::move(object), nullptr });
+            }
+        }
+        for(TextureHandle& texture : getTextures())
+        {
+            if(texture->m_isResident && texture->m_lastUsedFrame + 1 < m_frameIndex)
+            {
+                candidates.push_back({ texture->m_lastUsedFrame, nullptr, std::move(texture) });
+            }
+        }
+
+        std::sort(
+                candidates.begin(),
+                candidates.end(),
+                [](const auto& a, const auto& b) { return a.lastUsedFrame < b.lastUsedFrame; }
+        );
+
+        for(const auto& candidate : candidates)
+        {
+            if(usage <= m_gpuMemoryBudget)
+            {
+                break;
+            }
+
+            if(candidate.object)
+            {
+                usage -= candidate.object->m_gpuBytes;
+                candidate.object->releaseBuffers();
+            }
+            else
+            {
+                usage -= candidate.texture->m_gpuBytes;
+                candidate.texture->releaseTexture();
+            }
+        }
+    }
+
+    void RenderManager::processUploads()
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        // At least one upload per frame, so a small budget can't stall loading entirely
+        UploadQueue::Upload upload;
+        while(m_uploadQueue->pop(upload))
+        {
+            if(!upload())
+            {
+                // The texture streamer is full until the GPU catches up, try again next frame
+                m_uploadQueue->push(std::move(upload));
+                break;
+            }
+
+            const std::chrono::duration<double> elapsed = std::chrono::steady_clock::now() - start;
+            if(elapsed.count() >= m_uploadBudget)
+            {
+                break;
+            }
         }
-        m_objectList.clear();
     }
 
-    std::pair<std::string, GLuint> RenderManager::registerShader(const std::string& shaderPath, std::string shaderName)
+    void RenderManager::deregisterTexture(TextureHandle& tex)
     {
-        if(m_shaderList.contains(shaderName))
+        tex.reset();
+        pruneAssets(m_textureList);
+    }
+
+    void RenderManager::clearTextures() { m_textureList.clear(); }
+
+    std::vector<TextureHandle> RenderManager::getTextures() const
+    {
+        std::vector<TextureHandle> textures;
+        for(const auto& elem : m_textureList)
         {
-            auto shader = m_shaderList.find(shaderName);
+            if(TextureHandle texture = elem.second.lock())
+            {
+                textures.push_back(std::move(texture));
+            }
+        }
+        return textures;
+    }
+
+    std::pair<std::string, GLuint> RenderManager::registerShader(
+            const std::string& shaderPath,
+            const std::string& shaderName,
+            uint32_t features /* = SHADER_FEATURE_NONE */
+    )
+    {
+        const std::string variantName = getShaderVariantName(shaderName, features);
+        if(m_shaderList.contains(variantName))
+        {
+            auto shader = m_shaderList.find(variantName);
             return *shader;
         }
 
+        const std::shared_ptr<StartupTrace> trace = SingletonManager::get<StartupTrace>();
+        StartupTrace::Scope phase(trace, "load shader " + variantName);
         std::pair<std::string, GLuint> newShader;
-        newShader.first = std::move(shaderName);
-        newShader.second = LoadShaders((shaderPath + ".vert").c_str(), (shaderPath + ".frag").c_str());
+        newShader.first = variantName;
+        newShader.second = 0;
+
+        // Each permutation is logged and cached on its own
+        const std::string variantPath = getShaderVariantName(shaderPath, features);
+        std::string vertexCode;
+        std::string fragmentCode;
+        if(ReadShaderSource((shaderPath + ".vert").c_str(), vertexCode) &&
+           ReadShaderSource((shaderPath + ".frag").c_str(), fragmentCode))
+        {
+            vertexCode = addShaderDefines(vertexCode, features);
+            fragmentCode = addShaderDefines(fragmentCode, features);
+
+            // Linked programs are cached as binaries, compiled again once a source or the driver changes
+            const uint64_t sourceHash = hashString(fragmentCode, hashString(vertexCode));
+            // Both are checked in finishShader, so the driver can load or compile the next shaders meanwhile
+            newShader.second = loadProgramCache(variantPath, sourceHash);
+            if(newShader.second != 0)
+            {
+                PendingShader pending { variantPath, sourceHash, true };
+                pending.vertexCode = std::move(vertexCode);
+                pending.fragmentCode = std::move(fragmentCode);
+                m_pendingShaders.emplace(newShader.second, std::move(pending));
+            }
+            else
+            {
+                StartupTrace::Scope compilePhase(trace, "submit shader " + variantPath);
+                newShader.second = SubmitShaders(vertexCode, fragmentCode);
+                m_pendingShaders.emplace(newShader.second, PendingShader { variantPath, sourceHash, false });
+            }
+        }
 
         m_shaderList.emplace(newShader);
 
         return newShader;
     }
 
+    uint32_t RenderManager::getLightingFeatures() const
+    {
+        uint32_t features = SHADER_FEATURE_NONE;
+        if(m_ambientLightUbo->isActive())
+        {
+            features |= SHADER_FEATURE_AMBIENT_LIGHT;
+        }
+        if(m_diffuseLightUbo->isActive())
+        {
+            features |= SHADER_FEATURE_DIFFUSE_LIGHT;
+        }
+        if(m_clusteredLighting->getLightCount() > 0)
+        {
+            features |= SHADER_FEATURE_CLUSTERED_LIGHTS;
+        }
+        return features;
+    }
+
+    bool RenderManager::finishShader(GLuint program)
+    {
+        const auto pending = m_pendingShaders.find(program);
+        if(pending == m_pendingShaders.end())
+        {
+            GLint linkStatus = GL_FALSE;
+            glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+            return linkStatus == GL_TRUE;
+        }
+
+        const PendingShader shader = std::move(pending->second);
+        m_pendingShaders.erase(pending);
+
+        const std::shared_ptr<StartupTrace> trace = SingletonManager::get<StartupTrace>();
+        StartupTrace::Scope phase(trace, "finish shader " + shader.shaderPath);
+        if(shader.isCached)
+        {
+            GLint linkStatus = GL_FALSE;
+            glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+            if(linkStatus == GL_TRUE)
+            {
+                return true;
+            }
+
+            // The driver rejected the binary, e.g. after an update, the program is linked from source instead
+            std::cout << "Couldn't load program cache [" << shader.shaderPath << "]" << std::endl;
+            SubmitShaders(shader.vertexCode, shader.fragmentCode, program);
+        }
+
+        if(!FinishShaders(program, shader.shaderPath.c_str()))
+        {
+            return false;
+        }
+
+        if(isProgramBinarySupported() && !writeProgramCache(shader.shaderPath, shader.sourceHash, program))
+        {
+            std::cout << "Couldn't write program cache [" << shader.shaderPath << "]" << std::endl;
+        }
+
+        return true;
+    }
+
+    bool RenderManager::isShaderReady(GLuint program) const
+    {
+        return !m_pendingShaders.contains(program) || IsShaderProgramReady(program);
+    }
+
     void RenderManager::deregisterShader(std::string shaderName /* = "" */, GLuint shaderId /* = -1 */)
     {
         if(shaderName.empty() && shaderId == -1)
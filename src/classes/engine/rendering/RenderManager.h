@@ -1,11 +1,24 @@
 #pragma once
 
+#include "../../helper/AssetKey.h"
+#include "../../helper/ImageData.h"
+#include "../../helper/ObjParser.h"
 #include "../../helper/ObjectData.h"
+#include "../../helper/ShaderPermutation.h"
+#include "../../helper/TextureAtlas.h"
+#include "../../helper/TextureData.h"
+#include "TextureStreamer.h"
+#include "UniformRing.h"
+#include "UploadQueue.h"
+#include "VertexLayout.h"
 #include "lighting/AmbientLightUbo.h"
+#include "lighting/ClusteredLighting.h"
 #include "lighting/DiffuseLightUbo.h"
 
 #include <map>
+#include <memory>
 #include <string>
+#include <unordered_map>
 #include <vector>
 
 #include <glm/gtc/matrix_transform.hpp>
@@ -13,52 +26,303 @@
 namespace Engine
 {
     class GeometryComponent;
+    class JobSystem;
     class Shader;
+    struct MeshImport;
 
     inline const glm::vec3 WORLD_UP = glm::vec3(0.f, 1.f, 0.f);
 
+    /**
+     * Registered assets by the hash of their path. Paths whose hashes collide share a key and are told apart
+     * by their stored path. The registry doesn't keep assets alive, an asset is freed as soon as its last
+     * handle is released.
+     */
+    template<typename T>
+    using AssetRegistry = std::unordered_multimap<AssetKey, std::weak_ptr<T>, AssetKeyHash>;
+
+    /**
+     * @brief Assets a scene declares up front, so they can load before the scene starts.
+     */
+    struct BootAssets
+    {
+            std::vector<std::string> meshes;
+            std::vector<std::string> textures;
+            // Have to match the RenderManager's settings once the assets are registered, else they load again
+            VertexFormat vertexFormat = VertexFormat::SNORM16_POSITIONS;
+            bool compressTextures = true;
+    };
+
     class RenderManager
     {
         public:
             RenderManager();
             ~RenderManager() = default;
 
-            std::shared_ptr<ObjectData> registerObject(const char* filePath);
-            void deregisterObject(std::shared_ptr<ObjectData>& obj);
+            /**
+             * Starts loading meshes and textures on the JobSystem. Needs no GL context, so it can run before
+             * the window exists. The first registerObject or registerTexture of a path takes its preloaded
+             * data, waiting for it if it's still loading, instead of reading the file again.
+             *
+             * @param assets The assets to load
+             */
+            static void preloadAssets(const BootAssets& assets);
+
+            /**
+             * Drops preloaded assets that haven't been registered, ones still loading are dropped once done.
+             */
+            static void clearPreloadedAssets();
+
+            /**
+             * Loads a mesh and uploads it into an interleaved vertex buffer.
+             * The imported mesh is written to a binary cache,
+             * later runs upload straight from the mapped file.
+             *
+             * @param filePath The path of the OBJ file
+             * @return The loaded object, nullptr if the file couldn't be loaded
+             */
+            MeshHandle registerObject(const char* filePath);
+
+            /**
+             * Returns the object right away and loads the mesh in the background.
+             * Parsing and encoding run on the JobSystem, the buffers are created by processUploads.
+             * The object stays empty until m_isResident is set, geometry using it isn't drawn until then.
+             *
+             * @param filePath The path of the OBJ file
+             * @return The object, filled once loading has finished
+             */
+            MeshHandle registerObjectAsync(const char* filePath);
+
+            /**
+             * Releases a handle, the mesh and its buffers are freed once no other handle refers to it.
+             *
+             * @param obj The handle to release, reset afterwards
+             */
+            void deregisterObject(MeshHandle& obj);
+
+            /**
+             * Forgets every registered mesh. Meshes still in use stay alive until their handles are released,
+             * registering them again loads a new copy.
+             */
             void clearObjects();
 
-            GLuint registerTexture(const char* filePath);
-            void deregisterTexture(GLuint tex);
+            /**
+             * Precomputes back to front triangle orders of a static mesh for a cube map of view directions.
+             * Translucent geometry using the object picks the nearest order instead of sorting every frame.
+             * The orders are baked on the JobSystem and uploaded with the next processUploads. They're cached
+             * in cache/triangleOrders/ and reused as long as the mesh doesn't change.
+             * Meshes above TRIANGLE_ORDER_MAX_TRIANGLES, or whose orders would take more than a quarter of
+             * the GPU memory budget, keep sorting at runtime.
+             *
+             * @param obj The object to precompute the triangle orders for
+             * @param resolution Direction cells along one edge of a cube face, stores 6 * resolution^2 orders
+             */
+            void bakeTriangleOrders(const MeshHandle& obj, int resolution = 4);
+
+            /**
+             * Loads a BMP, TGA, PNG, DDS or KTX2 file into a texture.
+             * DDS and KTX2 files may hold texture arrays and cube maps, see TextureData::m_target.
+             *
+             * @param filePath The path of the texture file
+             * @return The loaded texture, nullptr if the file couldn't be loaded
+             */
+            TextureHandle registerTexture(const char* filePath);
+
+            /**
+             * Returns the texture right away, decodes the image in the background
+             * and uploads it in processUploads.
+             *
+             * @param filePath The path of the BMP, TGA, PNG, DDS or KTX2 file
+             * @return The texture, m_textureId is valid once m_isResident is set
+             */
+            TextureHandle registerTextureAsync(const char* filePath);
+
+            /**
+             * Releases a handle, the texture is freed once no other handle refers to it.
+             *
+             * @param tex The handle to release, reset afterwards
+             */
+            void deregisterTexture(TextureHandle& tex);
+
+            /**
+             * Packs BMP, TGA and PNG files into one atlas, geometry using any of them binds the same texture.
+             * The atlas is written as a DDS file and registered like a texture loaded from it. Geometry
+             * picks its file with GeometryComponent::setTexture(atlas, filePath), its texture coordinates
+             * are mapped into the file's region and have to stay between 0 and 1.
+             *
+             * @param atlasPath The path the atlas is written to and registered as
+             * @param filePaths The files to pack
+             * @param maxSize The largest width and height of the atlas
+             * @return The atlas, its texture is nullptr if a file couldn't be loaded or they don't fit
+             */
+            TextureAtlas buildTextureAtlas(
+                    const std::string& atlasPath,
+                    const std::vector<std::string>& filePaths,
+                    int maxSize = 4096
+            );
+
+            /**
+             * Stacks BMP, TGA and PNG files of the same size into the layers of a texture array,
+             * written and registered like buildTextureAtlas. Texture coordinates may repeat.
+             *
+             * @param arrayPath The path the array is written to and registered as
+             * @param filePaths The files to stack, one layer each
+             * @return The array, its texture is nullptr if a file couldn't be loaded or the sizes differ
+             */
+            TextureAtlas buildTextureArray(
+                    const std::string& arrayPath,
+                    const std::vector<std::string>& filePaths
+            );
             void clearTextures();
 
+            /**
+             * Starts a new frame: evicts assets while the GPU memory budget is exceeded, runs the pending
+             * uploads and flushes changed uniform blocks. Has to be called on the main thread before anything
+             * is drawn.
+             */
+            void beginFrame();
+
+            /**
+             * Marks the assets of a draw as used this frame and reloads evicted ones in the background.
+             *
+             * @param obj The mesh to draw, may be nullptr
+             * @param texture The texture to draw, may be nullptr
+             * @param needsPositions Whether the draw reads the CPU positions of the mesh to sort triangles.
+             * Decides the CPU data an automatic MeshRetention keeps, released positions are restored in the
+             * background and the mesh is drawn unsorted until they arrive.
+             * @return True if both assets are resident and can be drawn
+             */
+            bool requestResidency(
+                    const MeshHandle& obj,
+                    const TextureHandle& texture,
+                    bool needsPositions = false
+            );
+
+            /**
+             * Runs the GPU uploads of finished asynchronous loads until the frame's upload budget is spent.
+             * Has to be called on the main thread, once per frame.
+             */
+            void processUploads();
+
+            double getUploadBudget() const { return m_uploadBudget; };
+
+            /**
+             * @param seconds The time processUploads may spend per frame, at least one upload always runs
+             */
+            void setUploadBudget(double seconds) { m_uploadBudget = seconds; };
+
+            size_t getPendingUploadCount() const { return m_uploadQueue->size(); };
+
+            /**
+             * @return The estimated bytes of all resident meshes and textures
+             */
+            size_t getGpuMemoryUsage() const;
+
+            size_t getGpuMemoryBudget() const { return m_gpuMemoryBudget; };
+
+            /**
+             * Limits the estimated video memory of meshes and textures. While the budget is exceeded,
+             * the assets drawn least recently are evicted. They're reloaded in the background from their
+             * source or binary cache once they're drawn again.
+             *
+             * @param bytes The budget in bytes, 0 disables eviction
+             */
+            void setGpuMemoryBudget(size_t bytes) { m_gpuMemoryBudget = bytes; };
+
+            uint64_t getFrameIndex() const { return m_frameIndex; };
+
             /**
              * Shader has to consist of one .frag & one .vert shader files
              *
              * @param shaderPath full file path, without extension
              * @param shaderName The name the shader should be given
-             * @return std::pair<std::string, GLuint> the loaded shaders name & ID
+             * @param features The ShaderFeature flags defined in the sources, every set is its own program
+             * @return std::pair<std::string, GLuint> the loaded shaders name, including its features, & ID
+             */
+            std::pair<std::string, GLuint> registerShader(
+                    const std::string& shaderPath,
+                    const std::string& shaderName,
+                    uint32_t features = SHADER_FEATURE_NONE
+            );
+
+            /**
+             * Programs compiled by registerShader are only submitted to the driver, which may compile them
+             * in parallel. This waits for one, prints its errors and writes it to the program cache.
+             * Programs loaded from the cache are only checked for whether the driver accepted the binary,
+             * they're compiled from source if it didn't. Call it before the program is first used.
+             *
+             * @param program The ID registerShader returned
+             * @return True if the program is linked
              */
-            std::pair<std::string, GLuint> registerShader(const std::string& shaderPath, std::string shaderName);
+            bool finishShader(GLuint program);
+
+            /**
+             * @return True if finishShader won't have to wait for the driver
+             */
+            bool isShaderReady(GLuint program) const;
 
             void deregisterShader(std::string shaderName = std::string(), GLuint shaderId = -1);
 
             std::map<std::string, GLuint> getShader() const { return m_shaderList; }
 
-            std::map<std::string, std::shared_ptr<ObjectData>> getObjects() { return m_objectList; };
+            /**
+             * @return Every registered mesh that still has handles
+             */
+            std::vector<MeshHandle> getObjects() const;
+
+            /**
+             * @return Every registered texture that still has handles
+             */
+            std::vector<TextureHandle> getTextures() const;
 
             std::shared_ptr<Lighting::AmbientLightUbo>& getAmbientLightUbo() { return m_ambientLightUbo; };
 
             std::shared_ptr<Lighting::DiffuseLightUbo>& getDiffuseLightUbo() { return m_diffuseLightUbo; };
 
+            /**
+             * @return The point and spot lights of the scene, updated by EngineManager::engineDraw each frame
+             */
+            const std::shared_ptr<Lighting::ClusteredLighting>& getClusteredLighting() const
+            {
+                return m_clusteredLighting;
+            };
+
+            /**
+             * @return The ShaderFeature flags of the lights that are active
+             */
+            uint32_t getLightingFeatures() const;
+
+            /**
+             * @return The ring per-draw uniform records are written to, it moves to a new segment every frame
+             */
+            const std::shared_ptr<UniformRing>& getUniformRing() const { return m_uniformRing; };
+
             bool getWireframeMode() const { return m_showWireframe; };
 
             void setWireframeMode(bool toggle);
 
-            template<typename T>
-            static GLuint createBuffer(std::vector<T>& data)
-            {
-                int dataSize = data.size() * sizeof(T);
+            VertexFormat getVertexFormat() const { return m_vertexFormat; };
+
+            /**
+             * Sets the format vertices of objects registered from now on are stored in.
+             * Cached meshes stored in another format are imported again.
+             *
+             * @param format The vertex format to use
+             */
+            void setVertexFormat(VertexFormat format) { m_vertexFormat = format; };
 
+            bool getTextureCompression() const { return m_compressTextures; };
+
+            /**
+             * Sets whether BMP, TGA and PNG textures registered from now on are block compressed to DXT1,
+             * or DXT5 if they contain transparency. The compressed images are cached as DDS files,
+             * later runs load them without decoding the source again.
+             *
+             * @param compress True to compress textures, false to upload them uncompressed
+             */
+            void setTextureCompression(bool compress) { m_compressTextures = compress; };
+
+            static GLuint createBuffer(const void* data, size_t dataSize)
+            {
                 // Identify the vertex buffer
                 GLuint vbo;
                 // Generate a buffer with our identifier
@@ -66,18 +330,121 @@ namespace Engine
                 glBindBuffer(GL_ARRAY_BUFFER, vbo);
 
                 // Give vertices to OpenGL
-                glBufferData(GL_ARRAY_BUFFER, dataSize, &data[0], GL_STATIC_DRAW);
+                glBufferData(GL_ARRAY_BUFFER, GLsizeiptr(dataSize), data, GL_STATIC_DRAW);
 
                 return vbo;
             };
 
+            template<typename T>
+            static GLuint createBuffer(std::vector<T>& data)
+            {
+                return createBuffer(data.data(), data.size() * sizeof(T));
+            };
+
         private:
+            /**
+             * A program registerShader handed out that finishShader didn't check yet.
+             */
+            struct PendingShader
+            {
+                    // The path and source hash the program is cached under
+                    std::string shaderPath;
+                    uint64_t sourceHash;
+                    // Programs loaded from the cache keep their sources in case the driver rejects the binary
+                    bool isCached;
+                    std::string vertexCode;
+                    std::string fragmentCode;
+            };
+
+            /**
+             * Runs the chunks of large OBJ files on the JobSystem. Singletons must not be looked up from
+             * jobs, so the callers resolve the JobSystem on the main thread and hand the runner to the job.
+             */
+            static ObjTaskRunner makeTaskRunner(std::shared_ptr<JobSystem> jobSystem);
+
+            /**
+             * Loads a mesh from its cache or imports it, touches no GL state and may run on any thread.
+             *
+             * @param runTasks Parses the chunks of large OBJ files, see makeTaskRunner
+             */
+            static bool importMesh(
+                    const char* filePath,
+                    VertexFormat vertexFormat,
+                    MeshImport& mesh,
+                    const ObjTaskRunner& runTasks
+            );
+
+            /**
+             * Creates the buffers of an imported mesh and moves its CPU data into the object.
+             */
+            static void uploadMesh(MeshImport& mesh, ObjectData& object);
+
+            /**
+             * Loads released positions and indices of a resident mesh again on the JobSystem, from its
+             * cache or source file. processUploads moves them into the object, until then it has none.
+             */
+            void restoreCpuDataAsync(const MeshHandle& obj);
+
+            static void applyRetention(ObjectData& object, bool needsPositions);
+
+            /**
+             * Decodes a texture file, touches no GL state and may run on any thread.
+             * BMP, TGA and PNG files are block compressed if compress is set and kept in the texture cache.
+             */
+            static bool decodeTexture(const char* filePath, bool compress, ImageData& image);
+
+            /**
+             * Creates the texture of a decoded image, through the texture streamer if one is given.
+             *
+             * @return False if the streamer is full and the upload has to be retried later
+             */
+            static bool uploadTexture(
+                    const ImageData& image,
+                    TextureData& texture,
+                    TextureStreamer* streamer = nullptr
+            );
+
+            /**
+             * Decodes image files on the JobSystem and the calling thread, all of them have to load.
+             * Only waits for its own decodes, so it may run on a worker and beside other queued jobs.
+             */
+            static bool decodeImageFiles(
+                    const std::vector<std::string>& filePaths,
+                    std::vector<ImageData>& images
+            );
+
+            /**
+             * Writes a texture built from other files to filePath, then registers and uploads it.
+             */
+            TextureHandle registerBuiltTexture(const std::string& filePath, ImageData& image);
+
+            /**
+             * Queues the import of a registered mesh on the JobSystem, its upload runs in processUploads.
+             */
+            void loadObjectAsync(const MeshHandle& obj);
+
+            void loadTextureAsync(const TextureHandle& tex);
+
+            void enforceGpuMemoryBudget();
+
             std::shared_ptr<Lighting::AmbientLightUbo> m_ambientLightUbo;
             std::shared_ptr<Lighting::DiffuseLightUbo> m_diffuseLightUbo;
+            std::shared_ptr<Lighting::ClusteredLighting> m_clusteredLighting;
             std::map<std::string, GLuint> m_shaderList;
-            std::map<std::string, std::shared_ptr<ObjectData>> m_objectList;
-            std::map<std::string, GLuint> m_textureList;
+            // Programs that weren't checked yet, by their ID
+            std::unordered_map<GLuint, PendingShader> m_pendingShaders;
+            AssetRegistry<ObjectData> m_objectList;
+            AssetRegistry<TextureData> m_textureList;
             bool m_showWireframe;
+            VertexFormat m_vertexFormat;
+            bool m_compressTextures;
+            // Shared with the loading jobs, which may outlive the RenderManager
+            std::shared_ptr<UploadQueue> m_uploadQueue;
+            std::shared_ptr<TextureStreamer> m_textureStreamer;
+            std::shared_ptr<UniformRing> m_uniformRing;
+            double m_uploadBudget;
+            size_t m_gpuMemoryBudget;
+            uint64_t m_frameIndex;
     };
 
 } // namespace Engine
@@ -3,40 +3,115 @@
 
 using namespace Engine;
 
-Shader::Shader() : m_passVisual(PASS_NONE) {}
+Shader::Shader() : m_passVisual(PASS_NONE), m_features(SHADER_FEATURE_NONE) {}
 
 Shader::~Shader()
 {
-    // TODO: check if this is the correct way to handle expired programms
-    GLint numShaders;
-    glGetProgramiv(m_shaderIdentifier.second, GL_ATTACHED_SHADERS, &numShaders);
+    for(const auto& [features, variant] : m_variants)
+    {
+        const GLuint programId = variant.identifier.second;
 
-    // Create an array to store the shader object IDs
-    auto* shaderIds = new GLuint[numShaders];
+        // TODO: check if this is the correct way to handle expired programms
+        GLint numShaders;
+        glGetProgramiv(programId, GL_ATTACHED_SHADERS, &numShaders);
 
-    // Get the attached shader primitives
-    glGetAttachedShaders(m_shaderIdentifier.second, numShaders, nullptr, shaderIds);
+        // Create an array to store the shader object IDs
+        auto* shaderIds = new GLuint[numShaders];
 
-    // Detach and delete the shader primitives if needed
-    for(int i = 0; i < numShaders; ++i)
-    {
-        GLuint shaderId = shaderIds[i];
-        glDetachShader(m_shaderIdentifier.second, shaderId);
-        glDeleteShader(shaderId);
-    }
+        // Get the attached shader primitives
+        glGetAttachedShaders(programId, numShaders, nullptr, shaderIds);
+
+        // Detach and delete the shader primitives if needed
+        for(int i = 0; i < numShaders; ++i)
+        {
+            GLuint shaderId = shaderIds[i];
+            glDetachShader(programId, shaderId);
+            glDeleteShader(shaderId);
+        }
 
-    // Finally, delete the program
-    glDeleteProgram(m_shaderIdentifier.second);
-    delete[](shaderIds);
+        // Finally, delete the program
+        glDeleteProgram(programId);
+        delete[](shaderIds);
+    }
 }
 
 void Shader::registerShader(
         const std::shared_ptr<RenderManager>& renderManager,
         const std::string& shaderPath,
-        const std::string& shaderName
+        const std::string& shaderName,
+        uint32_t features /* = SHADER_FEATURE_NONE */
 )
 {
-    m_shaderIdentifier = renderManager->registerShader(shaderPath, shaderName);
+    m_renderManager = renderManager;
+    m_uniformRing = renderManager->getUniformRing();
+    m_features = features;
+    m_variants.clear();
+
+    // Every combination of the lighting features is submitted now, so the driver compiles them in parallel
+    // and toggling a light doesn't stall a frame
+    const uint32_t lightingFeatures = features & SHADER_LIGHTING_FEATURES;
+    const uint32_t fixedFeatures = features & ~SHADER_LIGHTING_FEATURES;
+    for(uint32_t subset = lightingFeatures;; subset = (subset - 1) & lightingFeatures)
+    {
+        const uint32_t variantFeatures = fixedFeatures | subset;
+        const auto identifier = renderManager->registerShader(shaderPath, shaderName, variantFeatures);
+        m_variants[variantFeatures] = { identifier, false };
+        if(subset == 0)
+        {
+            break;
+        }
+    }
+
+    m_shaderIdentifier = m_variants[features].identifier;
+}
+
+void Shader::useProgram()
+{
+    uint32_t features = m_features;
+    if(const std::shared_ptr<RenderManager> renderManager = m_renderManager.lock())
+    {
+        features &= ~SHADER_LIGHTING_FEATURES | renderManager->getLightingFeatures();
+    }
+
+    const auto variant = m_variants.find(features);
+    if(variant != m_variants.end())
+    {
+        if(!variant->second.isLinked)
+        {
+            finishVariant(variant->second);
+        }
+        m_shaderIdentifier = variant->second.identifier;
+    }
+
+    glUseProgram(m_shaderIdentifier.second);
+}
+
+void Shader::finishVariant(Variant& variant)
+{
+    variant.isLinked = true;
+    if(const std::shared_ptr<RenderManager> renderManager = m_renderManager.lock())
+    {
+        renderManager->finishShader(variant.identifier.second);
+    }
+
+    const GLuint programId = variant.identifier.second;
+    applyUboBinding(programId, DRAW_BLOCK_POINT);
+    applyUboBinding(programId, CLUSTER_LIGHT_POINT);
+    for(const auto& ubo : m_boundUbos)
+    {
+        applyUboBinding(programId, ubo->getBindingPoint());
+    }
+
+    // Samplers of different types must never share a texture unit, even if one of them is unused
+    glProgramUniform1i(programId, glGetUniformLocation(programId, "textureSampler"), 0);
+    glProgramUniform1i(programId, glGetUniformLocation(programId, "textureArraySampler"), 1);
+    glProgramUniform1i(programId, glGetUniformLocation(programId, "lightData"), CLUSTER_LIGHT_DATA_UNIT);
+    glProgramUniform1i(programId, glGetUniformLocation(programId, "clusterRanges"), CLUSTER_RANGES_UNIT);
+    glProgramUniform1i(
+            programId,
+            glGetUniformLocation(programId, "clusterLightIndices"),
+            CLUSTER_LIGHT_INDICES_UNIT
+    );
 }
 
 void Shader::renderVertices(std::nullptr_t object, Engine::CameraComponent* camera)
@@ -47,27 +122,49 @@ void Shader::renderVertices(std::nullptr_t object, Engine::CameraComponent* came
 void Shader::renderVertices(const std::shared_ptr<GeometryComponent>& object, Engine::CameraComponent* camera)
 {
     const auto& objectData = object->getObjectData();
-    glm::mat4 mvp = camera->getProjectionMatrix() * camera->getViewMatrix() * object->getGlobalModelMatrix();
+    const VertexLayout layout = getVertexLayout(objectData->m_vertexFormat);
+    const glm::mat4 modelView = camera->getViewMatrix() * object->getGlobalModelMatrix();
+    glm::mat4 mvp = camera->getProjectionMatrix() * modelView * objectData->m_dequantization;
 
-    glUseProgram(getShaderIdentifier().second);
+    useProgram();
 
-    // Load MVP matrix into uniform
-    glUniformMatrix4fv(getActiveUniform("MVP"), 1, GL_FALSE, &mvp[0][0]);
-
-    // Load tint value into uniform
-    const glm::vec4 tint = object->getTint();
-    glUniform4f(getActiveUniform("tintColor"), tint.x, tint.y, tint.z, tint.w);
+    // Per-draw data is collected into one record, which is copied into the uniform ring before drawing
+    DrawBlock drawData {};
+    drawData.mvp = mvp;
+    drawData.modelView = modelView * objectData->m_dequantization;
+    drawData.normalMatrix = glm::transpose(glm::inverse(modelView));
+    drawData.tintColor = object->getTint();
+    drawData.uvTransform = glm::vec4(1.f, 1.f, 0.f, 0.f);
+    drawData.useOctNormals = layout.octahedralNormals;
 
     if(objectData->m_vertexBuffer != -1)
     {
-        bindVertexData(GLOBAL_ATTRIB_INDEX_VERTEXPOSITION, GL_ARRAY_BUFFER, objectData->m_vertexBuffer, 3, GL_FLOAT, false, 0);
+        bindVertexData(
+                GLOBAL_ATTRIB_INDEX_VERTEXPOSITION,
+                GL_ARRAY_BUFFER,
+                objectData->m_vertexBuffer,
+                layout.position.size,
+                layout.position.type,
+                layout.position.normalized,
+                layout.stride,
+                layout.position.offset
+        );
         m_usedAttribArrays.push_back(GLOBAL_ATTRIB_INDEX_VERTEXPOSITION);
-    }
 
-    if(objectData->m_normalBuffer != -1)
-    {
-        bindVertexData(GLOBAL_ATTRIB_INDEX_VERTEXNORMAL, GL_ARRAY_BUFFER, objectData->m_normalBuffer, 3, GL_FLOAT, false, 0);
-        m_usedAttribArrays.push_back(GLOBAL_ATTRIB_INDEX_VERTEXNORMAL);
+        if(objectData->m_hasNormals)
+        {
+            bindVertexData(
+                    GLOBAL_ATTRIB_INDEX_VERTEXNORMAL,
+                    GL_ARRAY_BUFFER,
+                    objectData->m_vertexBuffer,
+                    layout.normal.size,
+                    layout.normal.type,
+                    layout.normal.normalized,
+                    layout.stride,
+                    layout.normal.offset
+            );
+            m_usedAttribArrays.push_back(GLOBAL_ATTRIB_INDEX_VERTEXNORMAL);
+        }
     }
 
     if(object->getTextureBuffer() != -1)
@@ -79,24 +176,43 @@ void Shader::renderVertices(const std::shared_ptr<GeometryComponent>& object, En
         }
         else if(m_passVisual == PASS_TEXTURE)
         {
+            const TextureHandle& texture = object->getTexture();
+            const bool isArray = texture && texture->m_target == GL_TEXTURE_2D_ARRAY;
+            const TextureRegion& region = object->getTextureRegion();
+            const glm::vec2 uvScale = region.uvScale;
+            const glm::vec2 uvOffset = region.uvOffset;
+            drawData.uvTransform = glm::vec4(uvScale.x, uvScale.y, uvOffset.x, uvOffset.y);
+            drawData.useTextureArray = isArray;
+            drawData.textureLayer = float(region.layer);
+
+            // The sampler units are assigned once the program is linked, -1 leaves them untouched
             bindTexture(
                     GLOBAL_ATTRIB_INDEX_VERTEXCOLOR,
-                    objectData->m_uvBuffer,
+                    objectData->m_vertexBuffer,
                     object->getTextureBuffer(),
-                    getActiveUniform("textureSampler")
+                    -1,
+                    layout.uv,
+                    layout.stride,
+                    isArray ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D,
+                    isArray ? 1 : 0
             );
             m_usedAttribArrays.push_back(GLOBAL_ATTRIB_INDEX_VERTEXCOLOR);
         }
     }
 
+    if(m_uniformRing)
+    {
+        m_uniformRing->bindRecord(drawData, DRAW_BLOCK_POINT.second);
+    }
+
     glBindBuffer(GL_ELEMENT_ARRAY_BUFFER, object->getIndexBuffer());
 
     // Drawing the object
     glDrawElements(
-            GL_TRIANGLES,                 // mode
-            objectData->getVertexCount(), // count
-            GL_UNSIGNED_SHORT,            // type
-            nullptr                       // element array buffer offset
+            GL_TRIANGLES,                                           // mode
+            objectData->getVertexCount(),                           // count
+            objectData->getIndexType(),                             // type
+            reinterpret_cast<void*>(object->getIndexBufferOffset()) // element array buffer offset
     );
 
     loadCustomRenderData(object, camera);
@@ -128,17 +244,29 @@ GLint Shader::getActiveUniform(const std::string& uniform) const
 
 void Shader::bindUbo(const std::shared_ptr<UboBlock>& ubo)
 {
-    unsigned int index = glGetUniformBlockIndex(m_shaderIdentifier.second, ubo->getBindingPoint().first);
+    // Unlinked variants get their bindings in finishVariant, querying the block would wait for them
+    for(const auto& [features, variant] : m_variants)
+    {
+        if(variant.isLinked)
+        {
+            applyUboBinding(variant.identifier.second, ubo->getBindingPoint());
+        }
+    }
+
+    m_boundUbos.push_back(ubo);
+}
+
+void Shader::applyUboBinding(GLuint programId, std::pair<const char*, GLuint> bindingPoint)
+{
+    unsigned int index = glGetUniformBlockIndex(programId, bindingPoint.first);
 
+    // Variants compiled without a feature don't contain its block
     if(index == GL_INVALID_INDEX)
     {
-        fprintf(stderr, "Ubo index not found!");
         return;
     }
 
-    glUniformBlockBinding(m_shaderIdentifier.second, index, ubo->getBindingPoint().second);
-
-    m_boundUbos.push_back(ubo);
+    glUniformBlockBinding(programId, index, bindingPoint.second);
 }
 
 void Shader::removeBoundUbo(const std::shared_ptr<UboBlock>& ubo)
@@ -146,13 +274,31 @@ void Shader::removeBoundUbo(const std::shared_ptr<UboBlock>& ubo)
     m_boundUbos.erase(std::remove(m_boundUbos.begin(), m_boundUbos.end(), ubo), m_boundUbos.end());
 }
 
-void Shader::bindTexture(GLuint attribId, GLuint bufferId, GLuint textureBufferId, GLint textureSamplerUniformId)
+void Shader::bindTexture(
+        GLuint attribId,
+        GLuint bufferId,
+        GLuint textureBufferId,
+        GLint textureSamplerUniformId,
+        const VertexAttribute& uvAttribute,
+        int stride,
+        GLenum textureTarget,
+        GLint textureUnit
+)
 {
-    glActiveTexture(GL_TEXTURE0);
-    glBindTexture(GL_TEXTURE_2D, textureBufferId);
-    glUniform1i(textureSamplerUniformId, 0);
-
-    bindVertexData(attribId, GL_ARRAY_BUFFER, bufferId, 2, GL_FLOAT, false, 0);
+    glActiveTexture(GL_TEXTURE0 + textureUnit);
+    glBindTexture(textureTarget, textureBufferId);
+    glUniform1i(textureSamplerUniformId, textureUnit);
+
+    bindVertexData(
+            attribId,
+            GL_ARRAY_BUFFER,
+            bufferId,
+            uvAttribute.size,
+            uvAttribute.type,
+            uvAttribute.normalized,
+            stride,
+            uvAttribute.offset
+    );
 }
 
 void Shader::bindVertexData(
@@ -162,10 +308,11 @@ void Shader::bindVertexData(
         int size,
         GLenum dataType,
         bool normalized,
-        int stride
+        int stride,
+        size_t offset
 )
 {
     glEnableVertexAttribArray(attribId);
     glBindBuffer(targetType, bufferId);
-    glVertexAttribPointer(attribId, size, dataType, normalized, stride, (void*)nullptr);
+    glVertexAttribPointer(attribId, size, dataType, normalized, stride, reinterpret_cast<void*>(offset));
 }
\ No newline at end of file
@@ -1,9 +1,12 @@
 #pragma once
 
+#include "../../helper/ShaderPermutation.h"
 #include "../../nodeComponents/CameraComponent.h"
 #include "../../nodeComponents/GeometryComponent.h"
 #include "RenderManager.h"
 #include "UboBlock.h"
+#include "VertexLayout.h"
+#include <map>
 #include <utility>
 
 namespace Engine
@@ -25,10 +28,17 @@ namespace Engine
                 PASS_COLOR = 2
             };
 
+            /**
+             * Registers a program for every permutation the shader can be drawn with. The lighting features
+             * follow the state of the lights when drawing, the other features are always defined.
+             *
+             * @param features The ShaderFeature flags the shader supports
+             */
             void registerShader(
                     const std::shared_ptr<RenderManager>& renderManager,
                     const std::string& shaderPath,
-                    const std::string& shaderName
+                    const std::string& shaderName,
+                    uint32_t features = SHADER_FEATURE_NONE
             );
 
             virtual void renderVertices(std::nullptr_t object, CameraComponent* camera);
@@ -39,15 +49,33 @@ namespace Engine
 
             std::pair<std::string, GLuint> getShaderIdentifier() { return m_shaderIdentifier; }
 
+            /**
+             * Binds the variant matching the active lights, the first use of a variant waits for the driver
+             * to finish linking it.
+             */
+            void useProgram();
+
             GLint getActiveUniform(const std::string& uniform) const;
 
             std::vector<std::shared_ptr<UboBlock>> getBoundUbos() { return m_boundUbos; }
 
+            /**
+             * Bound to each variant once it's linked, until then the binding is only recorded.
+             */
             void bindUbo(const std::shared_ptr<UboBlock>& ubo);
 
             void removeBoundUbo(const std::shared_ptr<UboBlock>& ubo);
 
-            static void bindTexture(GLuint attribId, GLuint bufferId, GLuint textureBufferId, GLint textureSamplerUniformId);
+            static void bindTexture(
+                    GLuint attribId,
+                    GLuint bufferId,
+                    GLuint textureBufferId,
+                    GLint textureSamplerUniformId,
+                    const VertexAttribute& uvAttribute = { 2, GL_FLOAT, false, 0 },
+                    int stride = 0,
+                    GLenum textureTarget = GL_TEXTURE_2D,
+                    GLint textureUnit = 0
+            );
 
             static void bindVertexData(
                     GLuint attribId,
@@ -56,7 +84,8 @@ namespace Engine
                     int size,
                     GLenum dataType,
                     bool normalized,
-                    int stride
+                    int stride,
+                    size_t offset = 0
             );
 
             passVisual getVisualPassStyle() const { return m_passVisual; }
@@ -64,10 +93,28 @@ namespace Engine
             void setVisualPassStyle(passVisual passType) { m_passVisual = passType; }
 
         private:
+            struct Variant
+            {
+                    std::pair<std::string, GLuint> identifier;
+                    bool isLinked;
+            };
+
+            /**
+             * Waits for the variant to link, then binds its blocks and assigns its sampler units.
+             */
+            void finishVariant(Variant& variant);
+
+            static void applyUboBinding(GLuint programId, std::pair<const char*, GLuint> bindingPoint);
+
             std::vector<GLuint> m_usedAttribArrays;
             passVisual m_passVisual;
 
             std::pair<std::string, GLuint> m_shaderIdentifier;
             std::vector<std::shared_ptr<UboBlock>> m_boundUbos;
+            std::weak_ptr<RenderManager> m_renderManager;
+            std::shared_ptr<UniformRing> m_uniformRing;
+            // Keyed by the features each variant was compiled with
+            std::map<uint32_t, Variant> m_variants;
+            uint32_t m_features;
     };
 } // namespace Engine
\ No newline at end of file
@@ -1,90 +1,137 @@
 #include "ShaderLoader.h"
 
 #include <cstdio>
-#include <fstream>
 #include <iostream>
-#include <sstream>
+#include <string>
 #include <vector>
 
 #include <GL/glew.h>
 
+#include "../../helper/AssetFile.h"
+
 using namespace std;
 
-GLuint LoadShaders(const char* vertex_file_path, const char* fragment_file_path)
+bool ReadShaderSource(const char* file_path, std::string& source)
 {
-    // Create the shaders
-    GLuint VertexShaderID = glCreateShader(GL_VERTEX_SHADER);
-    GLuint FragmentShaderID = glCreateShader(GL_FRAGMENT_SHADER);
+    // Mounted asset packs are searched first
+    Engine::AssetFile ShaderFile(file_path);
+    if(!ShaderFile.isOpen())
+    {
+        printf("Impossible to open %s. Are you in the right directory ? Don't forget to read the FAQ !\n",
+               file_path);
+        return false;
+    }
+
+    source.assign(ShaderFile.data(), ShaderFile.size());
+    return true;
+}
 
+GLuint LoadShaders(const char* vertex_file_path, const char* fragment_file_path)
+{
     // Read the Vertex Shader code from the file
     std::string VertexShaderCode;
-    std::ifstream VertexShaderStream(vertex_file_path, std::ios::in);
-    if(VertexShaderStream.is_open())
-    {
-        std::stringstream sstr;
-        sstr << VertexShaderStream.rdbuf();
-        VertexShaderCode = sstr.str();
-        VertexShaderStream.close();
-    }
-    else
+    if(!ReadShaderSource(vertex_file_path, VertexShaderCode))
     {
-        printf("Impossible to open %s. Are you in the right directory ? Don't forget to read the FAQ !\n",
-               vertex_file_path);
         getchar();
         return 0;
     }
 
     // Read the Fragment Shader code from the file
     std::string FragmentShaderCode;
-    std::ifstream FragmentShaderStream(fragment_file_path, std::ios::in);
-    if(FragmentShaderStream.is_open())
+    ReadShaderSource(fragment_file_path, FragmentShaderCode);
+
+    return CompileShaders(VertexShaderCode, FragmentShaderCode, vertex_file_path);
+}
+
+GLuint CompileShaders(
+        const std::string& VertexShaderCode,
+        const std::string& FragmentShaderCode,
+        const char* name
+)
+{
+    const GLuint ProgramID = SubmitShaders(VertexShaderCode, FragmentShaderCode);
+    FinishShaders(ProgramID, name);
+    return ProgramID;
+}
+
+void EnableParallelShaderCompile()
+{
+    if(GLEW_KHR_parallel_shader_compile)
     {
-        std::stringstream sstr;
-        sstr << FragmentShaderStream.rdbuf();
-        FragmentShaderCode = sstr.str();
-        FragmentShaderStream.close();
+        // The driver picks the number of threads
+        glMaxShaderCompilerThreadsKHR(0xFFFFFFFF);
     }
+}
 
-    GLint Result = GL_FALSE;
-    int InfoLogLength;
+GLuint SubmitShaders(
+        const std::string& VertexShaderCode,
+        const std::string& FragmentShaderCode,
+        GLuint ProgramID
+)
+{
+    // Create the shaders
+    GLuint VertexShaderID = glCreateShader(GL_VERTEX_SHADER);
+    GLuint FragmentShaderID = glCreateShader(GL_FRAGMENT_SHADER);
 
     // Compile Vertex Shader
-    printf("Compiling and linking shader: %s\n", vertex_file_path);
     const char* VertexSourcePointer = VertexShaderCode.c_str();
     glShaderSource(VertexShaderID, 1, &VertexSourcePointer, nullptr);
     glCompileShader(VertexShaderID);
 
-    // Check Vertex Shader
-    glGetShaderiv(VertexShaderID, GL_COMPILE_STATUS, &Result);
-    glGetShaderiv(VertexShaderID, GL_INFO_LOG_LENGTH, &InfoLogLength);
-    if(InfoLogLength > 0)
-    {
-        std::vector<char> VertexShaderErrorMessage(InfoLogLength + 1);
-        glGetShaderInfoLog(VertexShaderID, InfoLogLength, nullptr, &VertexShaderErrorMessage[0]);
-        printf("%s\n", &VertexShaderErrorMessage[0]);
-    }
-
     // Compile Fragment Shader
     const char* FragmentSourcePointer = FragmentShaderCode.c_str();
     glShaderSource(FragmentShaderID, 1, &FragmentSourcePointer, nullptr);
     glCompileShader(FragmentShaderID);
 
-    // Check Fragment Shader
-    glGetShaderiv(FragmentShaderID, GL_COMPILE_STATUS, &Result);
-    glGetShaderiv(FragmentShaderID, GL_INFO_LOG_LENGTH, &InfoLogLength);
-    if(InfoLogLength > 0)
+    // Link the program, keeping its binary retrievable for the program cache
+    if(ProgramID == 0)
     {
-        std::vector<char> FragmentShaderErrorMessage(InfoLogLength + 1);
-        glGetShaderInfoLog(FragmentShaderID, InfoLogLength, nullptr, &FragmentShaderErrorMessage[0]);
-        printf("%s\n", &FragmentShaderErrorMessage[0]);
+        ProgramID = glCreateProgram();
     }
-
-    // Link the program
-    GLuint ProgramID = glCreateProgram();
+    glProgramParameteri(ProgramID, GL_PROGRAM_BINARY_RETRIEVABLE_HINT, GL_TRUE);
     glAttachShader(ProgramID, VertexShaderID);
     glAttachShader(ProgramID, FragmentShaderID);
     glLinkProgram(ProgramID);
 
+    return ProgramID;
+}
+
+bool IsShaderProgramReady(GLuint ProgramID)
+{
+    if(!GLEW_KHR_parallel_shader_compile)
+    {
+        return true;
+    }
+
+    GLint Completed = GL_FALSE;
+    glGetProgramiv(ProgramID, GL_COMPLETION_STATUS_KHR, &Completed);
+    return Completed == GL_TRUE;
+}
+
+bool FinishShaders(GLuint ProgramID, const char* name)
+{
+    GLint Result = GL_FALSE;
+    int InfoLogLength;
+
+    printf("Compiling and linking shader: %s\n", name);
+
+    GLint ShaderCount = 0;
+    glGetProgramiv(ProgramID, GL_ATTACHED_SHADERS, &ShaderCount);
+    std::vector<GLuint> ShaderIDs(ShaderCount);
+    glGetAttachedShaders(ProgramID, ShaderCount, nullptr, ShaderIDs.data());
+
+    // Check the shaders
+    for(const GLuint ShaderID : ShaderIDs)
+    {
+        glGetShaderiv(ShaderID, GL_INFO_LOG_LENGTH, &InfoLogLength);
+        if(InfoLogLength > 0)
+        {
+            std::vector<char> ShaderErrorMessage(InfoLogLength + 1);
+            glGetShaderInfoLog(ShaderID, InfoLogLength, nullptr, &ShaderErrorMessage[0]);
+            printf("%s\n", &ShaderErrorMessage[0]);
+        }
+    }
+
     // Check the program
     glGetProgramiv(ProgramID, GL_LINK_STATUS, &Result);
     glGetProgramiv(ProgramID, GL_INFO_LOG_LENGTH, &InfoLogLength);
@@ -95,11 +142,11 @@ GLuint LoadShaders(const char* vertex_file_path, const char* fragment_file_path)
         printf("%s\n", &ProgramErrorMessage[0]);
     }
 
-    glDetachShader(ProgramID, VertexShaderID);
-    glDetachShader(ProgramID, FragmentShaderID);
-
-    glDeleteShader(VertexShaderID);
-    glDeleteShader(FragmentShaderID);
+    for(const GLuint ShaderID : ShaderIDs)
+    {
+        glDetachShader(ProgramID, ShaderID);
+        glDeleteShader(ShaderID);
+    }
 
-    return ProgramID;
+    return Result == GL_TRUE;
 }
\ No newline at end of file
@@ -1,5 +1,60 @@
 #pragma once
 
+#include <string>
+
 #include <GL/glew.h>
 
+/**
+ * Reads a shader file, from a mounted asset pack if one contains it.
+ *
+ * @return False if the file couldn't be opened
+ */
+bool ReadShaderSource(const char* file_path, std::string& source);
+
+/**
+ * Compiles and links a program from the sources of its vertex and fragment shader.
+ *
+ * @param name Shown in the log, usually the path of the shader files
+ * @return The program ID, compile and link errors are printed
+ */
+GLuint CompileShaders(
+        const std::string& VertexShaderCode,
+        const std::string& FragmentShaderCode,
+        const char* name
+);
+
+/**
+ * Lets the driver compile shaders on its own threads, if it supports GL_KHR_parallel_shader_compile.
+ */
+void EnableParallelShaderCompile();
+
+/**
+ * Starts compiling and linking a program without querying any status, so the driver doesn't have to finish
+ * the work before returning. Submitting all programs before finishing the first lets them compile in
+ * parallel. The shaders stay attached until FinishShaders is called.
+ *
+ * @param ProgramID The program to link, 0 to create one. A program whose cached binary was rejected is
+ * linked again from source this way, keeping its ID
+ * @return The program ID
+ */
+GLuint SubmitShaders(
+        const std::string& VertexShaderCode,
+        const std::string& FragmentShaderCode,
+        GLuint ProgramID = 0
+);
+
+/**
+ * @return True if querying the program won't wait for the driver, always true without
+ * GL_KHR_parallel_shader_compile
+ */
+bool IsShaderProgramReady(GLuint ProgramID);
+
+/**
+ * Waits for a submitted program, prints its compile and link errors and deletes its shaders.
+ *
+ * @param name Shown in the log, usually the path of the shader files
+ * @return True if the program was linked
+ */
+bool FinishShaders(GLuint ProgramID, const char* name);
+
 GLuint LoadShaders(const char* vertex_file_path, const char* fragment_file_path);
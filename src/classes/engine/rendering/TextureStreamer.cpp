@@ -0,0 +1,151 @@
+#include "TextureStreamer.h"
+
+#include "../../helper/FileLoading.h"
+
+#include <cstring>
+
+#define TEXTURE_STREAMER_ALIGNMENT 256
+
+namespace Engine
+{
+    TextureStreamer::TextureStreamer(size_t capacity)
+        : m_capacity(capacity)
+        , m_head(0)
+        , m_buffer(0)
+        , m_mappedData(nullptr)
+        , m_regions(std::deque<Region>())
+    {
+    }
+
+    TextureStreamer::~TextureStreamer()
+    {
+        for(const Region& region : m_regions)
+        {
+            glDeleteSync(region.fence);
+        }
+
+        if(m_buffer != 0)
+        {
+            if(m_mappedData)
+            {
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_buffer);
+                glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            }
+            glDeleteBuffers(1, &m_buffer);
+        }
+    }
+
+    bool TextureStreamer::upload(const ImageData& image, GLuint& textureId)
+    {
+        const size_t size = image.getPixelDataSize();
+        if(size > m_capacity)
+        {
+            textureId = uploadImage(image);
+            return true;
+        }
+
+        if(m_buffer == 0)
+        {
+            createBuffer();
+        }
+
+        size_t offset;
+        if(!allocate(size, offset))
+        {
+            return false;
+        }
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_buffer);
+        if(m_mappedData)
+        {
+            memcpy(m_mappedData + offset, image.getPixelData(), size);
+        }
+        else
+        {
+            // The fences guarantee the GPU is done with the region, no need for the driver to synchronize
+            void* region = glMapBufferRange(
+                    GL_PIXEL_UNPACK_BUFFER,
+                    GLintptr(offset),
+                    GLsizeiptr(size),
+                    GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT
+            );
+            if(region == nullptr)
+            {
+                glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+                textureId = uploadImage(image);
+                return true;
+            }
+
+            memcpy(region, image.getPixelData(), size);
+            glUnmapBuffer(GL_PIXEL_UNPACK_BUFFER);
+        }
+
+        // With a pixel unpack buffer bound the pixel pointer is an offset into the buffer
+        textureId = uploadImage(image, reinterpret_cast<const unsigned char*>(offset));
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+
+        m_regions.push_back({ offset, size, glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0) });
+        return true;
+    }
+
+    void TextureStreamer::createBuffer()
+    {
+        glGenBuffers(1, &m_buffer);
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, m_buffer);
+
+        if(GLEW_ARB_buffer_storage)
+        {
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_PIXEL_UNPACK_BUFFER, GLsizeiptr(m_capacity), nullptr, flags);
+            m_mappedData = static_cast<unsigned char*>(
+                    glMapBufferRange(GL_PIXEL_UNPACK_BUFFER, 0, GLsizeiptr(m_capacity), flags)
+            );
+        }
+        else
+        {
+            glBufferData(GL_PIXEL_UNPACK_BUFFER, GLsizeiptr(m_capacity), nullptr, GL_STREAM_DRAW);
+        }
+
+        glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+    }
+
+    void TextureStreamer::retireRegions()
+    {
+        // Regions are fenced in order, the GPU finishes them in order as well
+        while(!m_regions.empty())
+        {
+            const GLenum status = glClientWaitSync(m_regions.front().fence, 0, 0);
+            if(status != GL_ALREADY_SIGNALED && status != GL_CONDITION_SATISFIED)
+            {
+                return;
+            }
+
+            glDeleteSync(m_regions.front().fence);
+            m_regions.pop_front();
+        }
+    }
+
+    bool TextureStreamer::allocate(size_t size, size_t& offset)
+    {
+        retireRegions();
+
+        size_t start = m_head;
+        if(start + size > m_capacity)
+        {
+            start = 0;
+        }
+
+        for(const Region& region : m_regions)
+        {
+            if(start < region.offset + region.size && region.offset < start + size)
+            {
+                return false;
+            }
+        }
+
+        offset = start;
+        m_head = (start + size + TEXTURE_STREAMER_ALIGNMENT - 1) & ~size_t(TEXTURE_STREAMER_ALIGNMENT - 1);
+        return true;
+    }
+} // namespace Engine
@@ -0,0 +1,64 @@
+#pragma once
+
+#include "../../helper/ImageData.h"
+
+#include <deque>
+
+#include <GL/glew.h>
+
+namespace Engine
+{
+    /**
+     * @brief Uploads textures through a ring of pixel buffer memory, so the driver copies the texels
+     * asynchronously instead of stalling the main thread inside glTexImage2D.
+     *
+     * Every upload takes a region of the ring and fences it,
+     * regions are reused once their fence has signaled.
+     * The ring is mapped persistently where GL_ARB_buffer_storage is available,
+     * otherwise every region is mapped unsynchronized for the copy.
+     */
+    class TextureStreamer
+    {
+        public:
+            /**
+             * @param capacity Size of the ring in bytes, larger images bypass it and are uploaded directly
+             */
+            explicit TextureStreamer(size_t capacity = 16 * 1024 * 1024);
+            ~TextureStreamer();
+
+            TextureStreamer(const TextureStreamer&) = delete;
+            TextureStreamer& operator=(const TextureStreamer&) = delete;
+
+            /**
+             * Copies the image into the ring and creates a texture from it.
+             * Has to be called on the thread owning the GL context.
+             *
+             * @param image The decoded image
+             * @param textureId Receives the texture ID if the upload was issued
+             * @return False if the ring is full of uploads the GPU hasn't consumed yet, retry next frame
+             */
+            bool upload(const ImageData& image, GLuint& textureId);
+
+            size_t getCapacity() const { return m_capacity; };
+
+            size_t getInFlightCount() const { return m_regions.size(); };
+
+        private:
+            struct Region
+            {
+                    size_t offset;
+                    size_t size;
+                    GLsync fence;
+            };
+
+            void createBuffer();
+            void retireRegions();
+            bool allocate(size_t size, size_t& offset);
+
+            size_t m_capacity;
+            size_t m_head;
+            GLuint m_buffer;
+            unsigned char* m_mappedData;
+            std::deque<Region> m_regions;
+    };
+} // namespace Engine
@@ -1,15 +1,31 @@
 #pragma once
 
 #include <GL/glew.h>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
 #include <utility>
+#include <vector>
 
 namespace Engine
 {
+    /**
+     * @brief Uniform buffer with a CPU shadow copy of its std140 contents.
+     * LoadVariable only writes the shadow copy and tracks the changed bytes, flushAll uploads them with one
+     * call per changed block. Subclasses describe their block with a struct mirroring the std140 layout and
+     * static_assert its offsets, which LoadVariable is then called with.
+     */
     class UboBlock
     {
         public:
             UboBlock() = default;
-            ~UboBlock() = default;
+
+            virtual ~UboBlock() { std::erase(s_blocks, this); }
+
+            UboBlock(const UboBlock&) = delete;
+            UboBlock& operator=(const UboBlock&) = delete;
 
             void setupUbo()
             {
@@ -19,25 +35,85 @@ namespace Engine
                     return;
                 }
 
+                m_shadow.assign(m_size, 0);
+                UpdateUbo();
+
+                // The initial contents are uploaded with the buffer, nothing is left to flush
                 glGenBuffers(1, &m_uboId);
                 glBindBuffer(GL_UNIFORM_BUFFER, m_uboId);
-                glBufferData(GL_UNIFORM_BUFFER, m_size, nullptr, GL_STATIC_DRAW);
+                glBufferData(GL_UNIFORM_BUFFER, m_size, m_shadow.data(), GL_DYNAMIC_DRAW);
                 glBindBuffer(GL_UNIFORM_BUFFER, 0);
                 glBindBufferBase(GL_UNIFORM_BUFFER, m_bindingPoint.second, m_uboId);
+                m_dirtyBegin = SIZE_MAX;
+                m_dirtyEnd = 0;
 
-                UpdateUbo();
+                s_blocks.push_back(this);
             }
 
             virtual void UpdateUbo() = 0;
 
+            /**
+             * Writes a variable into the shadow copy, it's uploaded by the next flush.
+             *
+             * @param byteOffset The std140 offset of the variable, usually offsetof the block's layout struct
+             */
             template<typename T>
-            void LoadVariable(T data, int byteOffset)
+            void LoadVariable(const T& data, size_t byteOffset)
+            {
+                if(byteOffset + sizeof(T) > m_shadow.size())
+                {
+                    fprintf(stderr, "Ubo variable out of range!");
+                    return;
+                }
+
+                // Unchanged values don't need an upload
+                uint8_t* target = m_shadow.data() + byteOffset;
+                if(memcmp(target, &data, sizeof(T)) == 0)
+                {
+                    return;
+                }
+
+                memcpy(target, &data, sizeof(T));
+                m_dirtyBegin = std::min(m_dirtyBegin, byteOffset);
+                m_dirtyEnd = std::max(m_dirtyEnd, byteOffset + sizeof(T));
+            }
+
+            /**
+             * Uploads the range of the shadow copy that changed since the last flush, if any.
+             */
+            void flush()
             {
+                if(m_dirtyBegin >= m_dirtyEnd)
+                {
+                    return;
+                }
+
                 glBindBuffer(GL_UNIFORM_BUFFER, m_uboId);
-                glBufferSubData(GL_UNIFORM_BUFFER, byteOffset, sizeof(T), &data);
+                glBufferSubData(
+                        GL_UNIFORM_BUFFER,
+                        GLintptr(m_dirtyBegin),
+                        GLsizeiptr(m_dirtyEnd - m_dirtyBegin),
+                        m_shadow.data() + m_dirtyBegin
+                );
                 glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+                m_dirtyBegin = SIZE_MAX;
+                m_dirtyEnd = 0;
             }
 
+            /**
+             * Flushes every block that was set up. Called once per frame by RenderManager::beginFrame.
+             */
+            static void flushAll()
+            {
+                for(UboBlock* block : s_blocks)
+                {
+                    block->flush();
+                }
+            }
+
+            bool isDirty() const { return m_dirtyBegin < m_dirtyEnd; }
+
             void setBindingPoint(std::pair<const char*, GLuint> point) { m_bindingPoint = point; }
 
             std::pair<const char*, GLuint> getBindingPoint() { return m_bindingPoint; }
@@ -49,8 +125,14 @@ namespace Engine
             GLuint getId() const { return m_uboId; }
 
         private:
+            // Every block that was set up, flushAll runs on the main thread only
+            static inline std::vector<UboBlock*> s_blocks;
+
             std::pair<const char*, GLuint> m_bindingPoint;
             GLuint m_size = 0;
             GLuint m_uboId = -1;
+            std::vector<uint8_t> m_shadow;
+            size_t m_dirtyBegin = SIZE_MAX;
+            size_t m_dirtyEnd = 0;
     };
-} // namespace Engine
\ No newline at end of file
+} // namespace Engine
@@ -0,0 +1,161 @@
+#include "UniformRing.h"
+
+#include <cstring>
+
+// Waits are repeated until the fence signals, one second at a time
+#define UNIFORM_RING_WAIT_TIMEOUT 1000000000ull
+
+namespace Engine
+{
+    UniformRing::UniformRing(size_t segmentSize, size_t segmentCount)
+        : m_segmentSize(segmentSize)
+        , m_alignment(256)
+        , m_segment(0)
+        , m_head(0)
+        , m_buffer(0)
+        , m_mappedData(nullptr)
+        , m_fences(std::vector<GLsync>(segmentCount, nullptr))
+    {
+    }
+
+    UniformRing::~UniformRing()
+    {
+        for(const GLsync fence : m_fences)
+        {
+            if(fence)
+            {
+                glDeleteSync(fence);
+            }
+        }
+
+        if(m_buffer != 0)
+        {
+            if(m_mappedData)
+            {
+                glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+                glUnmapBuffer(GL_UNIFORM_BUFFER);
+                glBindBuffer(GL_UNIFORM_BUFFER, 0);
+            }
+            glDeleteBuffers(1, &m_buffer);
+        }
+    }
+
+    void UniformRing::beginFrame()
+    {
+        if(m_buffer != 0)
+        {
+            nextSegment();
+        }
+    }
+
+    bool UniformRing::bindRecord(const void* data, size_t size, GLuint bindingPoint)
+    {
+        if(m_buffer == 0)
+        {
+            createBuffer();
+        }
+
+        if(size > m_segmentSize)
+        {
+            return false;
+        }
+
+        if(m_head + size > (m_segment + 1) * m_segmentSize)
+        {
+            nextSegment();
+        }
+
+        const size_t offset = m_head;
+        if(m_mappedData)
+        {
+            memcpy(m_mappedData + offset, data, size);
+        }
+        else
+        {
+            // The fences guarantee the GPU is done with the segment, no need for the driver to synchronize
+            glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+            void* record = glMapBufferRange(
+                    GL_UNIFORM_BUFFER,
+                    GLintptr(offset),
+                    GLsizeiptr(size),
+                    GL_MAP_WRITE_BIT | GL_MAP_INVALIDATE_RANGE_BIT | GL_MAP_UNSYNCHRONIZED_BIT
+            );
+            if(record == nullptr)
+            {
+                glBindBuffer(GL_UNIFORM_BUFFER, 0);
+                return false;
+            }
+
+            memcpy(record, data, size);
+            glUnmapBuffer(GL_UNIFORM_BUFFER);
+            glBindBuffer(GL_UNIFORM_BUFFER, 0);
+        }
+
+        glBindBufferRange(GL_UNIFORM_BUFFER, bindingPoint, m_buffer, GLintptr(offset), GLsizeiptr(size));
+
+        m_head = (offset + size + m_alignment - 1) / m_alignment * m_alignment;
+        return true;
+    }
+
+    void UniformRing::createBuffer()
+    {
+        // Bound ranges have to start at a multiple of the alignment, segments as well
+        GLint alignment = 0;
+        glGetIntegerv(GL_UNIFORM_BUFFER_OFFSET_ALIGNMENT, &alignment);
+        if(alignment > 0)
+        {
+            m_alignment = size_t(alignment);
+        }
+        m_segmentSize = (m_segmentSize + m_alignment - 1) / m_alignment * m_alignment;
+
+        const size_t capacity = m_segmentSize * m_fences.size();
+        glGenBuffers(1, &m_buffer);
+        glBindBuffer(GL_UNIFORM_BUFFER, m_buffer);
+
+        if(GLEW_ARB_buffer_storage)
+        {
+            const GLbitfield flags = GL_MAP_WRITE_BIT | GL_MAP_PERSISTENT_BIT | GL_MAP_COHERENT_BIT;
+            glBufferStorage(GL_UNIFORM_BUFFER, GLsizeiptr(capacity), nullptr, flags);
+            m_mappedData = static_cast<unsigned char*>(
+                    glMapBufferRange(GL_UNIFORM_BUFFER, 0, GLsizeiptr(capacity), flags)
+            );
+        }
+        else
+        {
+            glBufferData(GL_UNIFORM_BUFFER, GLsizeiptr(capacity), nullptr, GL_STREAM_DRAW);
+        }
+
+        glBindBuffer(GL_UNIFORM_BUFFER, 0);
+
+        m_segment = 0;
+        m_head = 0;
+    }
+
+    void UniformRing::nextSegment()
+    {
+        if(m_fences[m_segment])
+        {
+            glDeleteSync(m_fences[m_segment]);
+        }
+        m_fences[m_segment] = glFenceSync(GL_SYNC_GPU_COMMANDS_COMPLETE, 0);
+
+        m_segment = (m_segment + 1) % m_fences.size();
+        m_head = m_segment * m_segmentSize;
+
+        GLsync& fence = m_fences[m_segment];
+        if(fence == nullptr)
+        {
+            return;
+        }
+
+        // The first wait flushes the commands, so the fence is guaranteed to signal eventually
+        GLenum status = glClientWaitSync(fence, GL_SYNC_FLUSH_COMMANDS_BIT, 0);
+        while(status == GL_TIMEOUT_EXPIRED)
+        {
+            status = glClientWaitSync(fence, 0, UNIFORM_RING_WAIT_TIMEOUT);
+        }
+
+        glDeleteSync(fence);
+        fence = nullptr;
+    }
+} // namespace Engine
@@ -0,0 +1,105 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <utility>
+#include <vector>
+
+#include <GL/glew.h>
+#include <glm/glm.hpp>
+
+namespace Engine
+{
+    inline const std::pair<const char*, GLuint> DRAW_BLOCK_POINT =
+            std::pair<const char*, GLuint>("DrawBlock", 0);
+
+    /**
+     * std140 layout of the DrawBlock in the shaders, the per-draw data written by Shader::renderVertices
+     */
+    struct DrawBlock
+    {
+            glm::mat4 mvp;
+            // View space of the clustered lights, including the dequantization of the positions
+            glm::mat4 modelView;
+            // Inverse transpose of the view and model matrix, turning normals into view space
+            glm::mat4 normalMatrix;
+            glm::vec4 tintColor;
+            // Scale in xy and offset in zw mapping the UVs into the geometry's region of a texture atlas
+            glm::vec4 uvTransform;
+            int32_t useOctNormals;
+            int32_t useTextureArray;
+            float textureLayer;
+            float padding;
+    };
+
+    static_assert(offsetof(DrawBlock, mvp) == 0, "DrawBlock doesn't match std140");
+    static_assert(offsetof(DrawBlock, modelView) == 64, "DrawBlock doesn't match std140");
+    static_assert(offsetof(DrawBlock, normalMatrix) == 128, "DrawBlock doesn't match std140");
+    static_assert(offsetof(DrawBlock, tintColor) == 192, "DrawBlock doesn't match std140");
+    static_assert(offsetof(DrawBlock, uvTransform) == 208, "DrawBlock doesn't match std140");
+    static_assert(offsetof(DrawBlock, useOctNormals) == 224, "DrawBlock doesn't match std140");
+    static_assert(offsetof(DrawBlock, useTextureArray) == 228, "DrawBlock doesn't match std140");
+    static_assert(offsetof(DrawBlock, textureLayer) == 232, "DrawBlock doesn't match std140");
+    static_assert(sizeof(DrawBlock) == 240, "DrawBlock doesn't match std140");
+
+    /**
+     * @brief Hands out per-draw uniform records from a ring of uniform buffer memory, so setting the data of
+     * a draw is a copy and a glBindBufferRange instead of one call per uniform.
+     *
+     * The ring is split into segments, every frame writes its records into a new one. A segment is fenced
+     * once it's left and only written again after its fence has signaled, so the GPU never reads a record
+     * that's being overwritten. A frame filling its segment continues in the next one.
+     * The ring is mapped persistently where GL_ARB_buffer_storage is available,
+     * otherwise every record is mapped unsynchronized for the copy.
+     */
+    class UniformRing
+    {
+        public:
+            /**
+             * @param segmentSize Bytes of records per segment
+             * @param segmentCount Segments in the ring, three let the GPU read two frames while one is filled
+             */
+            explicit UniformRing(size_t segmentSize = 256 * 1024, size_t segmentCount = 3);
+            ~UniformRing();
+
+            UniformRing(const UniformRing&) = delete;
+            UniformRing& operator=(const UniformRing&) = delete;
+
+            /**
+             * Fences the current segment and moves on to the next one, waits if the GPU still reads that.
+             * Called once per frame by RenderManager::beginFrame.
+             */
+            void beginFrame();
+
+            /**
+             * Copies a record into the ring and binds its range to the uniform buffer binding point.
+             * Has to be called on the thread owning the GL context.
+             *
+             * @return False if the record couldn't be written, the binding point is left unchanged then
+             */
+            bool bindRecord(const void* data, size_t size, GLuint bindingPoint);
+
+            template<typename T>
+            bool bindRecord(const T& record, GLuint bindingPoint)
+            {
+                return bindRecord(&record, sizeof(T), bindingPoint);
+            }
+
+            size_t getSegmentSize() const { return m_segmentSize; };
+
+            size_t getSegmentCount() const { return m_fences.size(); };
+
+        private:
+            void createBuffer();
+            void nextSegment();
+
+            size_t m_segmentSize;
+            size_t m_alignment;
+            size_t m_segment;
+            size_t m_head;
+            GLuint m_buffer;
+            unsigned char* m_mappedData;
+            // The fence of every segment the GPU may still read, nullptr once it's free
+            std::vector<GLsync> m_fences;
+    };
+} // namespace Engine
@@ -0,0 +1,48 @@
+#pragma once
+
+#include <deque>
+#include <functional>
+#include <mutex>
+
+namespace Engine
+{
+    /**
+     * @brief Thread safe queue of GPU uploads. Worker threads push the uploads of the assets they decoded,
+     * the main thread runs them with its GL context current.
+     * An upload returns false if it couldn't run yet and has to be retried later.
+     */
+    class UploadQueue
+    {
+        public:
+            using Upload = std::function<bool()>;
+
+            void push(Upload upload)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                m_uploads.push_back(std::move(upload));
+            }
+
+            bool pop(Upload& upload)
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                if(m_uploads.empty())
+                {
+                    return false;
+                }
+
+                upload = std::move(m_uploads.front());
+                m_uploads.pop_front();
+                return true;
+            }
+
+            size_t size()
+            {
+                std::lock_guard<std::mutex> lock(m_mutex);
+                return m_uploads.size();
+            }
+
+        private:
+            std::deque<Upload> m_uploads;
+            std::mutex m_mutex;
+    };
+} // namespace Engine
@@ -0,0 +1,85 @@
+#pragma once
+
+#include "../../helper/VertexEncodingHelper.h"
+
+#include <cstddef>
+
+#include <GL/glew.h>
+#include <glm/gtc/matrix_transform.hpp>
+
+namespace Engine
+{
+    /**
+     * @brief How one attribute is read from the interleaved vertex buffer.
+     */
+    struct VertexAttribute
+    {
+            GLint size;
+            GLenum type;
+            bool normalized;
+            size_t offset;
+    };
+
+    /**
+     * @brief Stride and attribute formats of one VertexFormat.
+     */
+    struct VertexLayout
+    {
+            GLsizei stride;
+            VertexAttribute position;
+            VertexAttribute uv;
+            VertexAttribute normal;
+            // Normals are two component octahedral encodings, the vertex shader has to decode them
+            bool octahedralNormals;
+    };
+
+    static VertexLayout getVertexLayout(VertexFormat format)
+    {
+        switch(format)
+        {
+            case VertexFormat::HALF_POSITIONS:
+                return { sizeof(QuantizedVertex),
+                         { 3, GL_HALF_FLOAT, false, offsetof(QuantizedVertex, position) },
+                         { 2, GL_HALF_FLOAT, false, offsetof(QuantizedVertex, uv) },
+                         { 2, GL_SHORT, true, offsetof(QuantizedVertex, normal) },
+                         true };
+            case VertexFormat::SNORM16_POSITIONS:
+                return { sizeof(QuantizedVertex),
+                         { 3, GL_SHORT, true, offsetof(QuantizedVertex, position) },
+                         { 2, GL_HALF_FLOAT, false, offsetof(QuantizedVertex, uv) },
+                         { 2, GL_SHORT, true, offsetof(QuantizedVertex, normal) },
+                         true };
+            default:
+                return { sizeof(PackedVertex),
+                         { 3, GL_FLOAT, false, offsetof(PackedVertex, position) },
+                         { 2, GL_FLOAT, false, offsetof(PackedVertex, uv) },
+                         { 3, GL_FLOAT, false, offsetof(PackedVertex, normal) },
+                         false };
+        }
+    }
+
+    /**
+     * Snorm16 positions are read as values in [-1, 1] relative to the bounds of the mesh.
+     * The returned matrix maps them back into model space and is folded into the MVP matrix.
+     *
+     * @param format The vertex format of the mesh.
+     * @param boundsMin The minimum corner of the meshes bounds.
+     * @param boundsMax The maximum corner of the meshes bounds.
+     * @return The dequantization transform, identity for formats storing model space positions.
+     */
+    static glm::mat4 getDequantizationMatrix(
+            VertexFormat format,
+            const glm::vec3& boundsMin,
+            const glm::vec3& boundsMax
+    )
+    {
+        if(format != VertexFormat::SNORM16_POSITIONS)
+        {
+            return glm::mat4(1.f);
+        }
+
+        glm::vec3 center, extent;
+        getQuantizationRange(boundsMin, boundsMax, center, extent);
+        return glm::scale(glm::translate(glm::mat4(1.f), center), extent);
+    }
+} // namespace Engine
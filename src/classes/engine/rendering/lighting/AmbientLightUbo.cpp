@@ -5,7 +5,7 @@ using namespace Engine::Lighting;
 
 AmbientLightUbo::AmbientLightUbo() : m_intensity(.5f), m_useAmbient(true), m_color(glm::vec3(1.f, 1.f, 1.f))
 {
-    setSize(32);
+    setSize(sizeof(AmbientLightBlock));
     setBindingPoint(AMBIENT_LIGHT_POINT);
 
     setupUbo();
@@ -13,25 +13,25 @@ AmbientLightUbo::AmbientLightUbo() : m_intensity(.5f), m_useAmbient(true), m_col
 
 void AmbientLightUbo::UpdateUbo()
 {
-    LoadVariable(m_useAmbient, 0);
-    LoadVariable(m_intensity, 4);
-    LoadVariable(m_color, 16);
+    LoadVariable(m_useAmbient, offsetof(AmbientLightBlock, useAmbient));
+    LoadVariable(m_intensity, offsetof(AmbientLightBlock, intensity));
+    LoadVariable(m_color, offsetof(AmbientLightBlock, color));
 }
 
 void AmbientLightUbo::setIsActive(bool useAmbient)
 {
     m_useAmbient = useAmbient;
-    LoadVariable(m_useAmbient, 0);
+    LoadVariable(m_useAmbient, offsetof(AmbientLightBlock, useAmbient));
 }
 
 void AmbientLightUbo::setColor(glm::vec3 color)
 {
     m_color = color;
-    LoadVariable(m_color, 16);
+    LoadVariable(m_color, offsetof(AmbientLightBlock, color));
 }
 
 void AmbientLightUbo::setIntensity(float intensity)
 {
     m_intensity = intensity;
-    LoadVariable(m_intensity, 4);
+    LoadVariable(m_intensity, offsetof(AmbientLightBlock, intensity));
 }
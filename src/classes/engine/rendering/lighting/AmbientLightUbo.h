@@ -1,10 +1,30 @@
 #include "../UboBlock.h"
 #include "LightingPoints.h"
 
+#include <cstddef>
+#include <cstdint>
+
 #include <glm/vec3.hpp>
 
 namespace Engine::Lighting
 {
+    /**
+     * std140 layout of the AmbientLightBlock in the shaders
+     */
+    struct AmbientLightBlock
+    {
+            int32_t useAmbient;
+            float intensity;
+            float padding[2];
+            glm::vec3 color;
+            float padding2;
+    };
+
+    static_assert(offsetof(AmbientLightBlock, useAmbient) == 0, "AmbientLightBlock doesn't match std140");
+    static_assert(offsetof(AmbientLightBlock, intensity) == 4, "AmbientLightBlock doesn't match std140");
+    static_assert(offsetof(AmbientLightBlock, color) == 16, "AmbientLightBlock doesn't match std140");
+    static_assert(sizeof(AmbientLightBlock) == 32, "AmbientLightBlock doesn't match std140");
+
     class AmbientLightUbo : public UboBlock
     {
         public:
@@ -0,0 +1,39 @@
+#include "ClusterLightUbo.h"
+
+using namespace Engine::Lighting;
+
+ClusterLightUbo::ClusterLightUbo()
+    : m_grid(glm::ivec4(1, 1, 1, 0))
+    , m_depth(glm::vec4(0.1f, 100.f, 1.f, 0.f))
+    , m_tile(glm::vec4(1.f, 1.f, 0.f, 0.f))
+{
+    setSize(sizeof(ClusterBlock));
+    setBindingPoint(CLUSTER_LIGHT_POINT);
+
+    setupUbo();
+}
+
+void ClusterLightUbo::UpdateUbo()
+{
+    LoadVariable(m_grid, offsetof(ClusterBlock, grid));
+    LoadVariable(m_depth, offsetof(ClusterBlock, depth));
+    LoadVariable(m_tile, offsetof(ClusterBlock, tile));
+}
+
+void ClusterLightUbo::setGrid(glm::ivec4 grid)
+{
+    m_grid = grid;
+    LoadVariable(m_grid, offsetof(ClusterBlock, grid));
+}
+
+void ClusterLightUbo::setDepth(glm::vec4 depth)
+{
+    m_depth = depth;
+    LoadVariable(m_depth, offsetof(ClusterBlock, depth));
+}
+
+void ClusterLightUbo::setTile(glm::vec4 tile)
+{
+    m_tile = tile;
+    LoadVariable(m_tile, offsetof(ClusterBlock, tile));
+}
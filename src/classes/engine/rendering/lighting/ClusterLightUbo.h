@@ -0,0 +1,56 @@
+#pragma once
+
+#include "../UboBlock.h"
+#include "LightingPoints.h"
+
+#include <cstddef>
+#include <cstdint>
+
+#include <glm/vec4.hpp>
+
+namespace Engine::Lighting
+{
+    /**
+     * std140 layout of the ClusterBlock in the shaders, describing how fragments find their cluster
+     */
+    struct ClusterBlock
+    {
+            // Clusters along x, y and z, the light count in w
+            glm::ivec4 grid;
+            // zNear, zFar and the scale and bias turning log(depth) into the slice
+            glm::vec4 depth;
+            // Size of a tile in pixels in xy, the viewport's origin in zw
+            glm::vec4 tile;
+    };
+
+    static_assert(offsetof(ClusterBlock, grid) == 0, "ClusterBlock doesn't match std140");
+    static_assert(offsetof(ClusterBlock, depth) == 16, "ClusterBlock doesn't match std140");
+    static_assert(offsetof(ClusterBlock, tile) == 32, "ClusterBlock doesn't match std140");
+    static_assert(sizeof(ClusterBlock) == 48, "ClusterBlock doesn't match std140");
+
+    class ClusterLightUbo : public UboBlock
+    {
+        public:
+            ClusterLightUbo();
+            ~ClusterLightUbo() = default;
+
+            void UpdateUbo() override;
+
+            glm::ivec4 getGrid() const { return m_grid; };
+
+            void setGrid(glm::ivec4 grid);
+
+            glm::vec4 getDepth() const { return m_depth; };
+
+            void setDepth(glm::vec4 depth);
+
+            glm::vec4 getTile() const { return m_tile; };
+
+            void setTile(glm::vec4 tile);
+
+        private:
+            glm::ivec4 m_grid;
+            glm::vec4 m_depth;
+            glm::vec4 m_tile;
+    };
+} // namespace Engine::Lighting
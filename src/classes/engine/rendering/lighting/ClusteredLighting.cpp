@@ -0,0 +1,273 @@
+#include "ClusteredLighting.h"
+
+#include "../../../nodeComponents/CameraComponent.h"
+#include "../../../nodeComponents/LightComponent.h"
+#include "../../JobSystem.h"
+
+#include <atomic>
+#include <cmath>
+#include <condition_variable>
+#include <mutex>
+
+#include <glm/gtc/matrix_transform.hpp>
+
+// Fewer lights are assigned on the main thread, handing them to the workers would cost more than it saves
+#define CLUSTERED_LIGHTING_JOB_THRESHOLD 32
+
+namespace Engine::Lighting
+{
+    namespace
+    {
+        /**
+         * The slices of one frame. Workers take slices until none are left, jobs that only start once the
+         * frame has been assigned find nothing to do, so the pointers are never used after update returns.
+         */
+        struct SliceAssignment
+        {
+                std::atomic<int> nextSlice = 0;
+                int sliceCount = 0;
+                int finishedSlices = 0;
+                std::mutex mutex;
+                std::condition_variable finished;
+                const ClusterBounds* bounds = nullptr;
+                const std::vector<ClusterLight>* lights = nullptr;
+                std::vector<LightClusterSlice>* slices = nullptr;
+        };
+
+        void assignRemainingSlices(SliceAssignment& assignment)
+        {
+            int slice = assignment.nextSlice++;
+            for(; slice < assignment.sliceCount; slice = assignment.nextSlice++)
+            {
+                LightClusterSlice& out = (*assignment.slices)[size_t(slice)];
+                assignClusterSlice(*assignment.bounds, *assignment.lights, slice, out);
+
+                std::lock_guard<std::mutex> lock(assignment.mutex);
+                if(++assignment.finishedSlices == assignment.sliceCount)
+                {
+                    assignment.finished.notify_all();
+                }
+            }
+        }
+    } // namespace
+
+    ClusteredLighting::ClusteredLighting(glm::ivec3 gridSize)
+        : m_gridSize(gridSize)
+        , m_boundsTanHalfFov(glm::vec2(0.f))
+        , m_maxTexels(0)
+        , m_clusterLightUbo(std::make_shared<ClusterLightUbo>())
+    {
+    }
+
+    ClusteredLighting::~ClusteredLighting()
+    {
+        deleteTextureBuffer(m_lightBuffer);
+        deleteTextureBuffer(m_rangeBuffer);
+        deleteTextureBuffer(m_indexBuffer);
+    }
+
+    void ClusteredLighting::update(
+            CameraComponent* camera,
+            const std::vector<std::shared_ptr<LightComponent>>& lights
+    )
+    {
+        // Scenes without lights skip everything, the lit shaders don't read the clusters then
+        if(lights.empty() && m_uploadedLightData.empty())
+        {
+            return;
+        }
+
+        if(m_maxTexels == 0)
+        {
+            GLint maxTexels = 0;
+            glGetIntegerv(GL_MAX_TEXTURE_BUFFER_SIZE, &maxTexels);
+            m_maxTexels = size_t(std::max(maxTexels, 65536));
+        }
+
+        const float tanHalfFovY = std::tan(glm::radians(camera->getFov()) * 0.5f);
+        const glm::vec2 tanHalfFov = glm::vec2(tanHalfFovY * camera->getAspectRatio(), tanHalfFovY);
+        const bool boundsChanged = tanHalfFov != m_boundsTanHalfFov || m_gridSize != m_bounds.grid.size ||
+                camera->getZNear() != m_bounds.grid.zNear || camera->getZFar() != m_bounds.grid.zFar;
+        if(boundsChanged)
+        {
+            ClusterGrid grid;
+            grid.size = m_gridSize;
+            grid.zNear = camera->getZNear();
+            grid.zFar = camera->getZFar();
+            buildClusterBounds(grid, tanHalfFov.x, tanHalfFov.y, m_bounds);
+            m_boundsTanHalfFov = tanHalfFov;
+        }
+
+        // Lights entirely outside the depth range can't touch any cluster and aren't uploaded
+        const glm::mat4 view = camera->getViewMatrix();
+        const size_t maxLights = m_maxTexels / 3;
+        m_lights.clear();
+        m_lightData.clear();
+        for(const std::shared_ptr<LightComponent>& light : lights)
+        {
+            if(!light->isActive() || light->getRange() <= 0.f || m_lights.size() == maxLights)
+            {
+                continue;
+            }
+
+            const glm::vec3 position = glm::vec3(view * glm::vec4(light->getGlobalPosition(), 1.f));
+            const float range = light->getRange();
+            if(position.z - range > -m_bounds.grid.zNear || position.z + range < -m_bounds.grid.zFar)
+            {
+                continue;
+            }
+
+            const bool isSpot = light->getLightType() == LIGHT_SPOT;
+            const glm::vec3 direction = glm::normalize(glm::vec3(view * glm::vec4(light->getForward(), 0.f)));
+            const float cosOuterAngle = std::cos(glm::radians(light->getOuterAngle()));
+            // smoothstep needs the inner edge to be above the outer one
+            const float cosInnerAngle =
+                    std::max(std::cos(glm::radians(light->getInnerAngle())), cosOuterAngle + 0.0001f);
+
+            m_lights.push_back({ position, range, direction, cosOuterAngle, isSpot });
+            m_lightData.emplace_back(position, range);
+            m_lightData.emplace_back(light->getColor() * light->getIntensity(), cosInnerAngle);
+            m_lightData.emplace_back(direction, isSpot ? cosOuterAngle : -2.f);
+        }
+
+        // Once the removal of the last light has been uploaded, nothing is left to do
+        if(m_lights.empty() && m_uploadedLightData.empty())
+        {
+            return;
+        }
+
+        // The lights are stored in view space, so they also change with the camera.
+        // If they and the bounds are unchanged, so are the clusters and the buffers are left alone.
+        if(boundsChanged || m_lightData != m_uploadedLightData || m_lightBuffer.texture == 0)
+        {
+            uploadClusters();
+        }
+
+        glActiveTexture(GL_TEXTURE0 + CLUSTER_LIGHT_DATA_UNIT);
+        glBindTexture(GL_TEXTURE_BUFFER, m_lightBuffer.texture);
+        glActiveTexture(GL_TEXTURE0 + CLUSTER_RANGES_UNIT);
+        glBindTexture(GL_TEXTURE_BUFFER, m_rangeBuffer.texture);
+        glActiveTexture(GL_TEXTURE0 + CLUSTER_LIGHT_INDICES_UNIT);
+        glBindTexture(GL_TEXTURE_BUFFER, m_indexBuffer.texture);
+        glActiveTexture(GL_TEXTURE0);
+
+        // The slice of a depth is floor(log(depth) * scale + bias), the inverse of getClusterSliceDepth
+        const float zNear = m_bounds.grid.zNear;
+        const float zFar = m_bounds.grid.zFar;
+        const float sliceScale = float(m_gridSize.z) / std::log(zFar / zNear);
+        const float sliceBias = -std::log(zNear) * sliceScale;
+
+        GLint viewport[4];
+        glGetIntegerv(GL_VIEWPORT, viewport);
+        const glm::vec2 tileSize =
+                glm::vec2(float(viewport[2]) / float(m_gridSize.x), float(viewport[3]) / float(m_gridSize.y));
+
+        const int lightCount = int(m_lights.size());
+        m_clusterLightUbo->setGrid(glm::ivec4(m_gridSize.x, m_gridSize.y, m_gridSize.z, lightCount));
+        m_clusterLightUbo->setDepth(glm::vec4(zNear, zFar, sliceScale, sliceBias));
+        m_clusterLightUbo->setTile(glm::vec4(tileSize.x, tileSize.y, float(viewport[0]), float(viewport[1])));
+
+        // RenderManager::beginFrame already flushed this frame's blocks
+        m_clusterLightUbo->flush();
+    }
+
+    void ClusteredLighting::uploadClusters()
+    {
+        if(m_lightBuffer.texture == 0)
+        {
+            createTextureBuffer(m_lightBuffer, GL_RGBA32F);
+            createTextureBuffer(m_rangeBuffer, GL_RG32UI);
+            createTextureBuffer(m_indexBuffer, GL_R32UI);
+        }
+
+        assignSlices();
+        mergeClusterSlices(m_slices, m_clusterRanges, m_lightIndices, m_maxTexels);
+        m_uploadedLightData = m_lightData;
+
+        // Empty buffers can't back a texture, the shaders never read this element
+        if(m_lightIndices.empty())
+        {
+            m_lightIndices.push_back(0);
+        }
+        const glm::vec4 noLight = glm::vec4(0.f);
+        const glm::vec4* lightData = m_lightData.empty() ? &noLight : m_lightData.data();
+        const size_t lightDataSize = std::max(m_lightData.size(), size_t(1)) * sizeof(glm::vec4);
+
+        uploadTextureBuffer(m_lightBuffer, lightData, lightDataSize);
+        uploadTextureBuffer(m_rangeBuffer, m_clusterRanges.data(), m_clusterRanges.size() * sizeof(uint32_t));
+        uploadTextureBuffer(m_indexBuffer, m_lightIndices.data(), m_lightIndices.size() * sizeof(uint32_t));
+    }
+
+    void ClusteredLighting::assignSlices()
+    {
+        const int sliceCount = m_bounds.grid.size.z;
+        m_slices.resize(size_t(sliceCount));
+
+        const std::shared_ptr<JobSystem> jobSystem = SingletonManager::get<JobSystem>();
+        if(m_lights.size() < CLUSTERED_LIGHTING_JOB_THRESHOLD || jobSystem->getWorkerCount() == 0)
+        {
+            for(int slice = 0; slice < sliceCount; slice++)
+            {
+                assignClusterSlice(m_bounds, m_lights, slice, m_slices[size_t(slice)]);
+            }
+            return;
+        }
+
+        auto assignment = std::make_shared<SliceAssignment>();
+        assignment->sliceCount = sliceCount;
+        assignment->bounds = &m_bounds;
+        assignment->lights = &m_lights;
+        assignment->slices = &m_slices;
+
+        // Workers busy with other jobs don't hold up the frame, the main thread takes the slices they don't
+        const size_t jobCount = std::min(jobSystem->getWorkerCount(), size_t(sliceCount - 1));
+        for(size_t i = 0; i < jobCount; i++)
+        {
+            jobSystem->addJob([assignment]() { assignRemainingSlices(*assignment); });
+        }
+        assignRemainingSlices(*assignment);
+
+        std::unique_lock<std::mutex> lock(assignment->mutex);
+        assignment->finished.wait(
+                lock,
+                [&assignment]() { return assignment->finishedSlices == assignment->sliceCount; }
+        );
+    }
+
+    void ClusteredLighting::createTextureBuffer(TextureBuffer& textureBuffer, GLenum format)
+    {
+        glGenBuffers(1, &textureBuffer.buffer);
+        glBindBuffer(GL_TEXTURE_BUFFER, textureBuffer.buffer);
+        glBufferData(GL_TEXTURE_BUFFER, 16, nullptr, GL_STREAM_DRAW);
+        textureBuffer.capacity = 16;
+
+        glGenTextures(1, &textureBuffer.texture);
+        glBindTexture(GL_TEXTURE_BUFFER, textureBuffer.texture);
+        glTexBuffer(GL_TEXTURE_BUFFER, format, textureBuffer.buffer);
+        glBindTexture(GL_TEXTURE_BUFFER, 0);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    void ClusteredLighting::uploadTextureBuffer(TextureBuffer& textureBuffer, const void* data, size_t size)
+    {
+        // Orphaning lets the driver hand out new memory while the last frame still reads the old one
+        glBindBuffer(GL_TEXTURE_BUFFER, textureBuffer.buffer);
+        textureBuffer.capacity = std::max(textureBuffer.capacity, size);
+        glBufferData(GL_TEXTURE_BUFFER, GLsizeiptr(textureBuffer.capacity), nullptr, GL_STREAM_DRAW);
+        glBufferSubData(GL_TEXTURE_BUFFER, 0, GLsizeiptr(size), data);
+        glBindBuffer(GL_TEXTURE_BUFFER, 0);
+    }
+
+    void ClusteredLighting::deleteTextureBuffer(TextureBuffer& textureBuffer)
+    {
+        if(textureBuffer.texture != 0)
+        {
+            glDeleteTextures(1, &textureBuffer.texture);
+        }
+        if(textureBuffer.buffer != 0)
+        {
+            glDeleteBuffers(1, &textureBuffer.buffer);
+        }
+        textureBuffer = TextureBuffer();
+    }
+} // namespace Engine::Lighting
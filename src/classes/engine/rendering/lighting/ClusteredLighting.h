@@ -0,0 +1,117 @@
+#pragma once
+
+#include "../../../helper/LightClustering.h"
+#include "ClusterLightUbo.h"
+
+#include <memory>
+#include <vector>
+
+#include <GL/glew.h>
+
+namespace Engine
+{
+    class CameraComponent;
+    class LightComponent;
+
+    // Texture units of the buffers the lit shaders read the clustered lights from
+    inline const GLint CLUSTER_LIGHT_DATA_UNIT = 2;
+    inline const GLint CLUSTER_RANGES_UNIT = 3;
+    inline const GLint CLUSTER_LIGHT_INDICES_UNIT = 4;
+} // namespace Engine
+
+namespace Engine::Lighting
+{
+    /**
+     * @brief Forward shading of many point and spot lights. Each frame the lights are assigned to the
+     * clusters of the view frustum on the JobSystem, one depth slice per job. The lights, the range of every
+     * cluster and the concatenated light indices are uploaded to texture buffers, a fragment only evaluates
+     * the lights of its cluster.
+     *
+     * Every light takes three texels of lightData: view position and range, color times intensity and the
+     * cosine of the inner angle, view direction and the cosine of the outer angle or -2 for point lights.
+     */
+    class ClusteredLighting
+    {
+        public:
+            explicit ClusteredLighting(glm::ivec3 gridSize = glm::ivec3(16, 9, 24));
+            ~ClusteredLighting();
+
+            ClusteredLighting(const ClusteredLighting&) = delete;
+            ClusteredLighting& operator=(const ClusteredLighting&) = delete;
+
+            /**
+             * Assigns the active lights to the clusters of the camera's frustum, uploads them and binds the
+             * buffers to their texture units. Has to be called on the main thread before anything is drawn.
+             * Does nothing without lights, the buffers are only uploaded if the lights or the camera changed.
+             *
+             * @param camera The camera the frame is drawn with
+             * @param lights The lights of the scene
+             */
+            void update(CameraComponent* camera, const std::vector<std::shared_ptr<LightComponent>>& lights);
+
+            /**
+             * @return The lights uploaded by the last update, the lit shaders skip them if there are none
+             */
+            size_t getLightCount() const { return m_lights.size(); };
+
+            glm::ivec3 getGridSize() const { return m_gridSize; };
+
+            /**
+             * @param gridSize Clusters along x, y and z, more clusters cull finer but cost more to assign
+             */
+            void setGridSize(glm::ivec3 gridSize) { m_gridSize = gridSize; };
+
+            /**
+             * @return The most light indices all clusters together can hold, clusters past it lose lights
+             */
+            size_t getMaxLightIndices() const { return m_maxTexels; };
+
+            std::shared_ptr<ClusterLightUbo>& getClusterLightUbo() { return m_clusterLightUbo; };
+
+        private:
+            struct TextureBuffer
+            {
+                    GLuint buffer = 0;
+                    GLuint texture = 0;
+                    size_t capacity = 0;
+            };
+
+            /**
+             * Assigns the gathered lights to the clusters and uploads the buffers.
+             */
+            void uploadClusters();
+
+            /**
+             * Assigns every depth slice, on the JobSystem if there are enough lights to be worth it.
+             */
+            void assignSlices();
+
+            static void createTextureBuffer(TextureBuffer& textureBuffer, GLenum format);
+
+            /**
+             * Orphans the buffer and writes the data, growing it if needed.
+             */
+            static void uploadTextureBuffer(TextureBuffer& textureBuffer, const void* data, size_t size);
+
+            static void deleteTextureBuffer(TextureBuffer& textureBuffer);
+
+            glm::ivec3 m_gridSize;
+            // The bounds only change with the projection, they're rebuilt when it does
+            ClusterBounds m_bounds;
+            glm::vec2 m_boundsTanHalfFov;
+            size_t m_maxTexels;
+
+            std::vector<ClusterLight> m_lights;
+            std::vector<LightClusterSlice> m_slices;
+            std::vector<glm::vec4> m_lightData;
+            // The light data of the last upload, the buffers are only written again if it changes
+            std::vector<glm::vec4> m_uploadedLightData;
+            std::vector<uint32_t> m_clusterRanges;
+            std::vector<uint32_t> m_lightIndices;
+
+            TextureBuffer m_lightBuffer;
+            TextureBuffer m_rangeBuffer;
+            TextureBuffer m_indexBuffer;
+            std::shared_ptr<ClusterLightUbo> m_clusterLightUbo;
+    };
+} // namespace Engine::Lighting
@@ -9,7 +9,7 @@ DiffuseLightUbo::DiffuseLightUbo()
     , m_color(glm::vec3(1.f))
     , m_direction(glm::vec3(1.f))
 {
-    setSize(48);
+    setSize(sizeof(DiffuseLightBlock));
     setBindingPoint(DIFFUSE_LIGHT_POINT);
 
     setupUbo();
@@ -17,8 +17,32 @@ DiffuseLightUbo::DiffuseLightUbo()
 
 void DiffuseLightUbo::UpdateUbo()
 {
-    LoadVariable(m_useDiffuse, 0);
-    LoadVariable(m_intensity, 4);
-    LoadVariable(m_direction, 16);
-    LoadVariable(m_color, 32);
+    LoadVariable(m_useDiffuse, offsetof(DiffuseLightBlock, useDiffuse));
+    LoadVariable(m_intensity, offsetof(DiffuseLightBlock, intensity));
+    LoadVariable(m_direction, offsetof(DiffuseLightBlock, direction));
+    LoadVariable(m_color, offsetof(DiffuseLightBlock, color));
+}
+
+void DiffuseLightUbo::setIsActive(bool useDiffuse)
+{
+    m_useDiffuse = useDiffuse;
+    LoadVariable(m_useDiffuse, offsetof(DiffuseLightBlock, useDiffuse));
+}
+
+void DiffuseLightUbo::setDir(glm::vec3 dir)
+{
+    m_direction = dir;
+    LoadVariable(m_direction, offsetof(DiffuseLightBlock, direction));
+}
+
+void DiffuseLightUbo::setColor(glm::vec3 color)
+{
+    m_color = color;
+    LoadVariable(m_color, offsetof(DiffuseLightBlock, color));
+}
+
+void DiffuseLightUbo::setIntensity(float intensity)
+{
+    m_intensity = intensity;
+    LoadVariable(m_intensity, offsetof(DiffuseLightBlock, intensity));
 }
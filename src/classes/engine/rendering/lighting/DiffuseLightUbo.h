@@ -1,10 +1,33 @@
 #include "../UboBlock.h"
 #include "LightingPoints.h"
 
+#include <cstddef>
+#include <cstdint>
+
 #include <glm/vec3.hpp>
 
 namespace Engine::Lighting
 {
+    /**
+     * std140 layout of the DiffuseLightBlock in the shaders
+     */
+    struct DiffuseLightBlock
+    {
+            int32_t useDiffuse;
+            float intensity;
+            float padding[2];
+            glm::vec3 direction;
+            float padding2;
+            glm::vec3 color;
+            float padding3;
+    };
+
+    static_assert(offsetof(DiffuseLightBlock, useDiffuse) == 0, "DiffuseLightBlock doesn't match std140");
+    static_assert(offsetof(DiffuseLightBlock, intensity) == 4, "DiffuseLightBlock doesn't match std140");
+    static_assert(offsetof(DiffuseLightBlock, direction) == 16, "DiffuseLightBlock doesn't match std140");
+    static_assert(offsetof(DiffuseLightBlock, color) == 32, "DiffuseLightBlock doesn't match std140");
+    static_assert(sizeof(DiffuseLightBlock) == 48, "DiffuseLightBlock doesn't match std140");
+
     class DiffuseLightUbo : public UboBlock
     {
         public:
@@ -15,19 +38,19 @@ namespace Engine::Lighting
 
             bool isActive() const { return m_useDiffuse; };
 
-            void setIsActive(bool useDiffuse) { m_useDiffuse = useDiffuse; };
+            void setIsActive(bool useDiffuse);
 
             glm::vec3 getDir() const { return m_direction; };
 
-            void setDir(glm::vec3 dir) { m_direction = dir; };
+            void setDir(glm::vec3 dir);
 
             glm::vec3 getColor() const { return m_color; };
 
-            void setColor(glm::vec3 color) { m_color = color; };
+            void setColor(glm::vec3 color);
 
             float getIntensity() const { return m_intensity; };
 
-            void setIntensity(float intensity) { m_intensity = intensity; };
+            void setIntensity(float intensity);
 
         private:
             int m_useDiffuse;
@@ -6,4 +6,6 @@ namespace Engine
             std::pair<const char*, GLuint>("AmbientLightBlock", 45);
     inline const std::pair<const char*, GLuint> DIFFUSE_LIGHT_POINT =
             std::pair<const char*, GLuint>("DiffuseLightBlock", 47);
+    inline const std::pair<const char*, GLuint> CLUSTER_LIGHT_POINT =
+            std::pair<const char*, GLuint>("ClusterBlock", 48);
 } // namespace Engine
\ No newline at end of file
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <cstddef>
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <vector>
+
+#include <sys/stat.h>
+
+#include "AssetPack.h"
+#include "HashUtils.h"
+#include "MappedFile.h"
+
+namespace Engine
+{
+    /**
+     * @brief Read only contents of an asset, looked up in the mounted asset packs before the filesystem.
+     * Files stored uncompressed in a pack and loose files are used straight from their mapping,
+     * compressed pack entries are decompressed into memory owned by the object.
+     */
+    class AssetFile
+    {
+        public:
+            AssetFile() = default;
+
+            explicit AssetFile(const char* filePath) { open(filePath); }
+
+            AssetFile(const AssetFile&) = delete;
+            AssetFile& operator=(const AssetFile&) = delete;
+
+            /**
+             * @brief Opens an asset, replacing any previously opened one.
+             * @param filePath The path of the asset, relative to the working directory.
+             * @return True if the asset could be opened, false otherwise.
+             */
+            bool open(const char* filePath)
+            {
+                close();
+
+                const AssetPackEntry* entry = nullptr;
+                std::shared_ptr<const AssetPack> pack = AssetPack::findMounted(filePath, entry);
+                if(!pack)
+                {
+                    if(!m_file.open(filePath))
+                    {
+                        return false;
+                    }
+
+                    m_data = m_file.data();
+                    m_size = m_file.size();
+                    m_modificationTime = m_file.getModificationTime();
+                    m_isOpen = true;
+                    return true;
+                }
+
+                if(entry->flags & ASSET_PACK_FLAG_LZ4)
+                {
+                    if(!pack->read(*entry, m_buffer))
+                    {
+                        std::cout << "Asset pack entry is not correct [" << filePath << "]" << std::endl;
+                        m_buffer.clear();
+                        return false;
+                    }
+                    m_data = m_buffer.data();
+                }
+                else
+                {
+                    // The pack stays mapped as long as the data is used
+                    m_data = pack->getStoredData(*entry);
+                    m_pack = std::move(pack);
+                }
+
+                m_size = entry->size;
+                m_modificationTime = time_t(entry->modificationTime);
+                m_isOpen = true;
+                return true;
+            }
+
+            /**
+             * @brief Looks up size and modification time of an asset without reading it, from the mounted
+             * asset packs before the filesystem like open.
+             * @return False if the asset doesn't exist.
+             */
+            static bool getInfo(const char* filePath, size_t& size, time_t& modificationTime)
+            {
+                const AssetPackEntry* entry = nullptr;
+                if(AssetPack::findMounted(filePath, entry))
+                {
+                    size = size_t(entry->size);
+                    modificationTime = time_t(entry->modificationTime);
+                    return true;
+                }
+
+                struct stat fileStat {};
+                if(stat(filePath, &fileStat) != 0)
+                {
+                    return false;
+                }
+
+                size = size_t(fileStat.st_size);
+                modificationTime = fileStat.st_mtime;
+                return true;
+            }
+
+            void close()
+            {
+                m_file.close();
+                m_pack.reset();
+                m_buffer = std::vector<char>();
+                m_data = nullptr;
+                m_size = 0;
+                m_modificationTime = 0;
+                m_isOpen = false;
+            }
+
+            bool isOpen() const { return m_isOpen; };
+
+            const char* data() const { return m_data; };
+
+            const char* end() const { return m_data + m_size; };
+
+            size_t size() const { return m_size; };
+
+            time_t getModificationTime() const { return m_modificationTime; };
+
+        private:
+            MappedFile m_file;
+            std::shared_ptr<const AssetPack> m_pack;
+            std::vector<char> m_buffer;
+            const char* m_data = nullptr;
+            size_t m_size = 0;
+            time_t m_modificationTime = 0;
+            bool m_isOpen = false;
+    };
+
+    /**
+     * Checks whether an asset still matches what a cache was created from, reading it the same way the
+     * loaders do. It's unchanged if size and modification time match, if only the modification time
+     * differs the asset is hashed and compared instead. A missing asset counts as unchanged.
+     *
+     * @param filePath The path of the asset.
+     * @param size The size of the asset the cache was created from.
+     * @param modificationTime Its modification time.
+     * @param hash The hashBytes of its contents.
+     * @return True if the cache can be used, false if it has to be created again.
+     */
+    static bool isAssetUnchanged(const char* filePath, uint64_t size, int64_t modificationTime, uint64_t hash)
+    {
+        size_t currentSize = 0;
+        time_t currentModificationTime = 0;
+        if(!AssetFile::getInfo(filePath, currentSize, currentModificationTime))
+        {
+            return true;
+        }
+
+        if(uint64_t(currentSize) != size)
+        {
+            return false;
+        }
+
+        if(int64_t(currentModificationTime) != modificationTime)
+        {
+            AssetFile source(filePath);
+            return source.isOpen() && hashBytes(source.data(), source.size()) == hash;
+        }
+
+        return true;
+    }
+} // namespace Engine
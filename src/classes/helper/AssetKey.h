@@ -0,0 +1,29 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string_view>
+
+#include "HashUtils.h"
+
+namespace Engine
+{
+    /**
+     * @brief Identifies an asset by the hash of its path, so lookups compare one integer instead of strings.
+     * The key isn't unique, different paths can hash to the same key. The path itself is only stored once,
+     * inside the asset, and compared on lookup to tell colliding assets apart.
+     */
+    struct AssetKey
+    {
+            uint64_t m_hash;
+
+            bool operator==(const AssetKey& that) const { return m_hash == that.m_hash; }
+    };
+
+    static inline AssetKey makeAssetKey(std::string_view filePath) { return { hashString(filePath) }; }
+
+    struct AssetKeyHash
+    {
+            size_t operator()(const AssetKey& key) const { return size_t(key.m_hash); }
+    };
+} // namespace Engine
@@ -0,0 +1,397 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <iostream>
+#include <memory>
+#include <mutex>
+#include <shared_mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include "HashUtils.h"
+#include "Lz4Compression.h"
+#include "MappedFile.h"
+
+#define ASSET_PACK_MAGIC 0x4B415041 // Equivalent to "APAK" in ASCII
+#define ASSET_PACK_VERSION 1
+#define ASSET_PACK_ALIGNMENT 16
+#define DEFAULT_ASSET_PACK_PATH "resources.pack"
+
+namespace Engine
+{
+    inline constexpr uint32_t ASSET_PACK_FLAG_LZ4 = 1 << 0;
+
+    /**
+     * Layout of an asset pack:
+     * the header, a hash table of slotCount entries, the paths of the entries and their data.
+     * The data of every entry starts on an ASSET_PACK_ALIGNMENT boundary so it can be used from the mapping.
+     */
+    struct AssetPackHeader
+    {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t entryCount;
+            // Power of two, empty slots have a pathLength of zero
+            uint32_t slotCount;
+            uint64_t tableOffset;
+            uint64_t fileSize;
+    };
+
+    static_assert(sizeof(AssetPackHeader) == 32, "AssetPackHeader must not contain padding");
+
+    struct AssetPackEntry
+    {
+            uint64_t pathHash;
+            uint64_t offset;
+            // Size of the file, storedSize differs if the entry is compressed
+            uint64_t size;
+            uint64_t storedSize;
+            int64_t modificationTime;
+            uint32_t pathOffset;
+            uint32_t pathLength;
+            uint32_t flags;
+            uint32_t padding;
+    };
+
+    static_assert(sizeof(AssetPackEntry) == 56, "AssetPackEntry must not contain padding");
+
+    /**
+     * @brief A file to store in an asset pack.
+     */
+    struct AssetPackSource
+    {
+            // The path the file is looked up by, like "resources/shader/lit.vert"
+            std::string path;
+            std::string filePath;
+    };
+
+    static inline uint64_t alignAssetPackOffset(uint64_t offset)
+    {
+        return (offset + ASSET_PACK_ALIGNMENT - 1) & ~uint64_t(ASSET_PACK_ALIGNMENT - 1);
+    }
+
+    /**
+     * Paths are looked up without a leading "./", so "./resources/a.obj" and "resources/a.obj" match.
+     */
+    static inline std::string_view normalizeAssetPath(std::string_view path)
+    {
+        while(path.size() >= 2 && path[0] == '.' && path[1] == '/')
+        {
+            path.remove_prefix(2);
+        }
+        return path;
+    }
+
+    /**
+     * Writes files into an asset pack. Entries are LZ4 compressed if that saves at least an eighth of their
+     * size, others are stored as is and can be used straight from the mapped pack.
+     * The pack is written to a temporary path first and moved into place once complete.
+     *
+     * @param packPath The path of the pack.
+     * @param sources The files to store, their paths have to be unique.
+     * @return True if the pack was written, false otherwise.
+     */
+    static bool writeAssetPack(const char* packPath, const std::vector<AssetPackSource>& sources)
+    {
+        uint32_t slotCount = 1;
+        while(slotCount < sources.size() * 2)
+        {
+            slotCount *= 2;
+        }
+
+        std::vector<AssetPackEntry> table(slotCount, AssetPackEntry {});
+        std::vector<std::vector<uint8_t>> blobs(sources.size());
+        std::vector<AssetPackEntry> entries(sources.size(), AssetPackEntry {});
+
+        std::string paths;
+        const uint64_t pathsOffset = sizeof(AssetPackHeader) + uint64_t(slotCount) * sizeof(AssetPackEntry);
+        uint64_t dataOffset = 0;
+        for(size_t i = 0; i < sources.size(); i++)
+        {
+            MappedFile file(sources[i].filePath.c_str());
+            if(!file.isOpen())
+            {
+                std::cout << "Couldn't open file [" << sources[i].filePath << "]" << std::endl;
+                return false;
+            }
+
+            const auto* data = reinterpret_cast<const uint8_t*>(file.data());
+            AssetPackEntry& entry = entries[i];
+            entry.size = file.size();
+            entry.modificationTime = int64_t(file.getModificationTime());
+
+            compressLz4(data, file.size(), blobs[i]);
+            if(blobs[i].size() <= file.size() - file.size() / 8)
+            {
+                entry.flags |= ASSET_PACK_FLAG_LZ4;
+            }
+            else
+            {
+                blobs[i].assign(data, data + file.size());
+            }
+            entry.storedSize = blobs[i].size();
+
+            const std::string_view path = normalizeAssetPath(sources[i].path);
+            entry.pathHash = hashString(path);
+            entry.pathOffset = uint32_t(pathsOffset + paths.size());
+            entry.pathLength = uint32_t(path.size());
+            paths += path;
+
+            entry.offset = dataOffset;
+            dataOffset = alignAssetPackOffset(dataOffset + entry.storedSize);
+        }
+
+        const uint64_t firstDataOffset = alignAssetPackOffset(pathsOffset + paths.size());
+        for(AssetPackEntry& entry : entries)
+        {
+            entry.offset += firstDataOffset;
+
+            uint32_t slot = uint32_t(entry.pathHash) & (slotCount - 1);
+            while(table[slot].pathLength != 0)
+            {
+                slot = (slot + 1) & (slotCount - 1);
+            }
+            table[slot] = entry;
+        }
+
+        AssetPackHeader header {};
+        header.magic = ASSET_PACK_MAGIC;
+        header.version = ASSET_PACK_VERSION;
+        header.entryCount = uint32_t(sources.size());
+        header.slotCount = slotCount;
+        header.tableOffset = sizeof(AssetPackHeader);
+        header.fileSize = firstDataOffset + dataOffset;
+
+        std::error_code error;
+        const std::filesystem::path parentPath = std::filesystem::path(packPath).parent_path();
+        if(!parentPath.empty())
+        {
+            std::filesystem::create_directories(parentPath, error);
+        }
+
+        const std::string tempPath = std::string(packPath) + ".tmp";
+        FILE* file = fopen(tempPath.c_str(), "wb");
+        if(file == nullptr)
+        {
+            return false;
+        }
+
+        const char padding[ASSET_PACK_ALIGNMENT] = {};
+        const size_t pathsPadding = firstDataOffset - pathsOffset - paths.size();
+
+        bool success = fwrite(&header, sizeof(header), 1, file) == 1;
+        success = success && fwrite(table.data(), sizeof(AssetPackEntry), slotCount, file) == slotCount;
+        success = success && fwrite(paths.data(), 1, paths.size(), file) == paths.size();
+        success = success && fwrite(padding, 1, pathsPadding, file) == pathsPadding;
+        for(size_t i = 0; i < blobs.size() && success; i++)
+        {
+            const size_t blobPadding = alignAssetPackOffset(blobs[i].size()) - blobs[i].size();
+            success = fwrite(blobs[i].data(), 1, blobs[i].size(), file) == blobs[i].size();
+            success = success && fwrite(padding, 1, blobPadding, file) == blobPadding;
+        }
+        success = fclose(file) == 0 && success;
+
+        if(!success || std::rename(tempPath.c_str(), packPath) != 0)
+        {
+            std::remove(tempPath.c_str());
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Memory mapped asset pack. Opening it maps one file instead of opening every asset on its own.
+     * Mounted packs are searched by AssetFile before the filesystem.
+     */
+    class AssetPack
+    {
+        public:
+            /**
+             * Maps a pack and checks that its table and every entry lie inside the file.
+             *
+             * @param packPath The path of the pack.
+             * @return True if the pack can be used, false otherwise.
+             */
+            bool open(const char* packPath)
+            {
+                if(!m_file.open(packPath) || !validateLayout())
+                {
+                    m_file.close();
+                    return false;
+                }
+
+                return true;
+            }
+
+            bool isOpen() const { return m_file.isOpen(); };
+
+            size_t getEntryCount() const { return m_header.entryCount; };
+
+            /**
+             * @param path The path of the file, like "resources/shader/lit.vert".
+             * @return The entry of the file, nullptr if the pack doesn't contain it.
+             */
+            const AssetPackEntry* find(std::string_view path) const
+            {
+                if(!isOpen())
+                {
+                    return nullptr;
+                }
+
+                path = normalizeAssetPath(path);
+                const uint64_t pathHash = hashString(path);
+                const uint32_t mask = m_header.slotCount - 1;
+                for(uint32_t slot = uint32_t(pathHash) & mask;; slot = (slot + 1) & mask)
+                {
+                    const AssetPackEntry& entry = getTable()[slot];
+                    if(entry.pathLength == 0)
+                    {
+                        return nullptr;
+                    }
+
+                    if(entry.pathHash == pathHash && getPath(entry) == path)
+                    {
+                        return &entry;
+                    }
+                }
+            }
+
+            /**
+             * @return The data of an entry as stored in the pack, LZ4 compressed if its flags say so.
+             */
+            const char* getStoredData(const AssetPackEntry& entry) const
+            {
+                return m_file.data() + entry.offset;
+            };
+
+            /**
+             * Copies the data of an entry, decompressing it if needed.
+             *
+             * @param entry The entry, from find.
+             * @param data Receives the file's data.
+             * @return False if the entry is corrupt.
+             */
+            bool read(const AssetPackEntry& entry, std::vector<char>& data) const
+            {
+                const auto* stored = reinterpret_cast<const uint8_t*>(getStoredData(entry));
+                data.resize(entry.size);
+                if(!(entry.flags & ASSET_PACK_FLAG_LZ4))
+                {
+                    memcpy(data.data(), stored, entry.size);
+                    return true;
+                }
+
+                auto* target = reinterpret_cast<uint8_t*>(data.data());
+                return decompressLz4(stored, entry.storedSize, target, entry.size);
+            }
+
+            /**
+             * Maps a pack and searches it for assets from now on, before the packs mounted earlier.
+             *
+             * @param packPath The path of the pack.
+             * @return False if the pack doesn't exist or is corrupt.
+             */
+            static bool mount(const char* packPath)
+            {
+                auto pack = std::make_shared<AssetPack>();
+                if(!pack->open(packPath))
+                {
+                    if(std::filesystem::exists(packPath))
+                    {
+                        std::cout << "Asset pack is not correct [" << packPath << "]" << std::endl;
+                    }
+                    return false;
+                }
+
+                std::unique_lock lock(s_mountMutex);
+                s_mountedPacks.insert(s_mountedPacks.begin(), std::move(pack));
+                return true;
+            }
+
+            /**
+             * Stops searching mounted packs. Files opened from them stay valid, they keep their pack mapped.
+             */
+            static void unmountAll()
+            {
+                std::unique_lock lock(s_mountMutex);
+                s_mountedPacks.clear();
+            }
+
+            /**
+             * @param path The path of the file.
+             * @param entry Receives the entry of the file.
+             * @return The most recently mounted pack containing the file, nullptr if none does.
+             */
+            static std::shared_ptr<const AssetPack> findMounted(
+                    std::string_view path,
+                    const AssetPackEntry*& entry
+            )
+            {
+                std::shared_lock lock(s_mountMutex);
+                for(const auto& pack : s_mountedPacks)
+                {
+                    entry = pack->find(path);
+                    if(entry)
+                    {
+                        return pack;
+                    }
+                }
+
+                return nullptr;
+            }
+
+        private:
+            const AssetPackEntry* getTable() const
+            {
+                return reinterpret_cast<const AssetPackEntry*>(m_file.data() + m_header.tableOffset);
+            }
+
+            std::string_view getPath(const AssetPackEntry& entry) const
+            {
+                return { m_file.data() + entry.pathOffset, entry.pathLength };
+            }
+
+            bool validateLayout()
+            {
+                if(m_file.size() < sizeof(AssetPackHeader))
+                {
+                    return false;
+                }
+
+                memcpy(&m_header, m_file.data(), sizeof(AssetPackHeader));
+                const uint32_t slotCount = m_header.slotCount;
+                if(m_header.magic != ASSET_PACK_MAGIC || m_header.version != ASSET_PACK_VERSION ||
+                   m_header.fileSize != m_file.size() || slotCount == 0 ||
+                   (slotCount & (slotCount - 1)) != 0 || m_header.entryCount >= slotCount ||
+                   m_header.tableOffset % alignof(AssetPackEntry) != 0 ||
+                   m_header.tableOffset + uint64_t(slotCount) * sizeof(AssetPackEntry) > m_file.size())
+                {
+                    return false;
+                }
+
+                for(uint32_t slot = 0; slot < slotCount; slot++)
+                {
+                    const AssetPackEntry& entry = getTable()[slot];
+                    if(entry.pathLength != 0 &&
+                       (uint64_t(entry.pathOffset) + entry.pathLength > m_file.size() ||
+                        entry.offset > m_file.size() || entry.storedSize > m_file.size() - entry.offset ||
+                        (!(entry.flags & ASSET_PACK_FLAG_LZ4) && entry.storedSize != entry.size)))
+                    {
+                        return false;
+                    }
+                }
+
+                return true;
+            }
+
+            MappedFile m_file;
+            AssetPackHeader m_header {};
+
+            static inline std::vector<std::shared_ptr<const AssetPack>> s_mountedPacks;
+            static inline std::shared_mutex s_mountMutex;
+    };
+} // namespace Engine
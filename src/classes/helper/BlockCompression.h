@@ -0,0 +1,294 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define BLOCK_COMPRESSION_SSE2 1
+#endif
+
+#include "ImageData.h"
+
+namespace Engine
+{
+    inline constexpr size_t BC1_BLOCK_SIZE = 8;
+    inline constexpr size_t BC3_BLOCK_SIZE = 16;
+
+    static inline uint16_t packColor565(const uint8_t* color)
+    {
+        return uint16_t(((color[0] >> 3) << 11) | ((color[1] >> 2) << 5) | (color[2] >> 3));
+    }
+
+    static inline void unpackColor565(uint16_t packed, int* color)
+    {
+        const int red = (packed >> 11) & 31;
+        const int green = (packed >> 5) & 63;
+        const int blue = packed & 31;
+        color[0] = (red << 3) | (red >> 2);
+        color[1] = (green << 2) | (green >> 4);
+        color[2] = (blue << 3) | (blue >> 2);
+    }
+
+    /**
+     * Computes the per channel minimum and maximum of a block of 16 RGBA8 texels.
+     *
+     * @param texels The 64 bytes of the block.
+     * @param minimum Receives the smallest value of every channel.
+     * @param maximum Receives the largest value of every channel.
+     * @param useSimd Whether to use SSE2 where available, the result is identical either way.
+     */
+    static void getBlockBounds(const uint8_t* texels, uint8_t* minimum, uint8_t* maximum, bool useSimd = true)
+    {
+#ifdef BLOCK_COMPRESSION_SSE2
+        if(useSimd)
+        {
+            const auto* rows = reinterpret_cast<const __m128i*>(texels);
+            __m128i low = _mm_min_epu8(
+                    _mm_min_epu8(_mm_loadu_si128(rows), _mm_loadu_si128(rows + 1)),
+                    _mm_min_epu8(_mm_loadu_si128(rows + 2), _mm_loadu_si128(rows + 3))
+            );
+            __m128i high = _mm_max_epu8(
+                    _mm_max_epu8(_mm_loadu_si128(rows), _mm_loadu_si128(rows + 1)),
+                    _mm_max_epu8(_mm_loadu_si128(rows + 2), _mm_loadu_si128(rows + 3))
+            );
+
+            // Fold the four texels of each register onto the first one
+            low = _mm_min_epu8(low, _mm_srli_si128(low, 8));
+            low = _mm_min_epu8(low, _mm_srli_si128(low, 4));
+            high = _mm_max_epu8(high, _mm_srli_si128(high, 8));
+            high = _mm_max_epu8(high, _mm_srli_si128(high, 4));
+
+            const uint32_t lowTexel = uint32_t(_mm_cvtsi128_si32(low));
+            const uint32_t highTexel = uint32_t(_mm_cvtsi128_si32(high));
+            memcpy(minimum, &lowTexel, 4);
+            memcpy(maximum, &highTexel, 4);
+            return;
+        }
+#endif
+
+        memcpy(minimum, texels, 4);
+        memcpy(maximum, texels, 4);
+        for(int texel = 1; texel < 16; texel++)
+        {
+            for(int channel = 0; channel < 4; channel++)
+            {
+                minimum[channel] = std::min(minimum[channel], texels[texel * 4 + channel]);
+                maximum[channel] = std::max(maximum[channel], texels[texel * 4 + channel]);
+            }
+        }
+    }
+
+    /**
+     * Encodes the colors of a block of 16 RGBA8 texels as BC1 (DXT1) in four color mode.
+     * The endpoints are the bounding box of the colors, inset by 1/16 to reduce the error of the extremes.
+     *
+     * @param texels The 64 bytes of the block, rows packed tightly.
+     * @param block Receives the 8 byte color block.
+     * @param useSimd Whether to use SSE2 where available, the result is identical either way.
+     */
+    static void compressColorBlock(const uint8_t* texels, uint8_t* block, bool useSimd = true)
+    {
+        uint8_t minimum[4], maximum[4];
+        getBlockBounds(texels, minimum, maximum, useSimd);
+        for(int channel = 0; channel < 3; channel++)
+        {
+            const int inset = (maximum[channel] - minimum[channel]) >> 4;
+            minimum[channel] = uint8_t(std::min(minimum[channel] + inset, 255));
+            maximum[channel] = uint8_t(std::max(maximum[channel] - inset, 0));
+        }
+
+        uint16_t color0 = packColor565(maximum);
+        uint16_t color1 = packColor565(minimum);
+        uint32_t indices = 0;
+        if(color0 != color1)
+        {
+            // color0 > color1 selects the four color mode without transparency
+            if(color0 < color1)
+            {
+                std::swap(color0, color1);
+            }
+
+            int palette[4][3];
+            unpackColor565(color0, palette[0]);
+            unpackColor565(color1, palette[1]);
+            for(int channel = 0; channel < 3; channel++)
+            {
+                palette[2][channel] = (2 * palette[0][channel] + palette[1][channel]) / 3;
+                palette[3][channel] = (palette[0][channel] + 2 * palette[1][channel]) / 3;
+            }
+
+            for(int texel = 0; texel < 16; texel++)
+            {
+                const uint8_t* color = texels + texel * 4;
+                int bestIndex = 0;
+                int bestDistance = INT32_MAX;
+                for(int index = 0; index < 4; index++)
+                {
+                    const int red = color[0] - palette[index][0];
+                    const int green = color[1] - palette[index][1];
+                    const int blue = color[2] - palette[index][2];
+                    const int distance = red * red + green * green + blue * blue;
+                    if(distance < bestDistance)
+                    {
+                        bestDistance = distance;
+                        bestIndex = index;
+                    }
+                }
+                indices |= uint32_t(bestIndex) << (texel * 2);
+            }
+        }
+
+        block[0] = uint8_t(color0 & 0xFF);
+        block[1] = uint8_t(color0 >> 8);
+        block[2] = uint8_t(color1 & 0xFF);
+        block[3] = uint8_t(color1 >> 8);
+        memcpy(block + 4, &indices, 4);
+    }
+
+    /**
+     * Encodes the alpha channel of a block of 16 RGBA8 texels as a BC3 (DXT5) alpha block
+     * with eight interpolated values between the smallest and largest alpha.
+     *
+     * @param texels The 64 bytes of the block, rows packed tightly.
+     * @param block Receives the 8 byte alpha block.
+     */
+    static void compressAlphaBlock(const uint8_t* texels, uint8_t* block)
+    {
+        int alpha0 = 0;
+        int alpha1 = 255;
+        for(int texel = 0; texel < 16; texel++)
+        {
+            alpha0 = std::max(alpha0, int(texels[texel * 4 + 3]));
+            alpha1 = std::min(alpha1, int(texels[texel * 4 + 3]));
+        }
+
+        uint64_t indices = 0;
+        if(alpha0 != alpha1)
+        {
+            int palette[8] = { alpha0, alpha1 };
+            for(int step = 1; step < 7; step++)
+            {
+                palette[step + 1] = ((7 - step) * alpha0 + step * alpha1) / 7;
+            }
+
+            for(int texel = 0; texel < 16; texel++)
+            {
+                const int alpha = texels[texel * 4 + 3];
+                int bestIndex = 0;
+                for(int index = 1; index < 8; index++)
+                {
+                    if(std::abs(alpha - palette[index]) < std::abs(alpha - palette[bestIndex]))
+                    {
+                        bestIndex = index;
+                    }
+                }
+                indices |= uint64_t(bestIndex) << (texel * 3);
+            }
+        }
+
+        block[0] = uint8_t(alpha0);
+        block[1] = uint8_t(alpha1);
+        for(int byte = 0; byte < 6; byte++)
+        {
+            block[2 + byte] = uint8_t(indices >> (byte * 8));
+        }
+    }
+
+    /**
+     * Block compresses one RGBA8 image level, texels beyond the edges repeat the last row and column.
+     *
+     * @param texels The texels of the level, rows packed tightly.
+     * @param width The width of the level.
+     * @param height The height of the level.
+     * @param withAlpha Encodes BC3 (DXT5) if true, BC1 (DXT1) without alpha otherwise.
+     * @param output The blocks are appended to this vector, row by row.
+     */
+    static void compressLevel(
+            const uint8_t* texels,
+            int width,
+            int height,
+            bool withAlpha,
+            std::vector<uint8_t>& output
+    )
+    {
+        const int blocksX = (width + 3) / 4;
+        const int blocksY = (height + 3) / 4;
+        const size_t blockSize = withAlpha ? BC3_BLOCK_SIZE : BC1_BLOCK_SIZE;
+        size_t offset = output.size();
+        output.resize(offset + size_t(blocksX) * size_t(blocksY) * blockSize);
+
+        uint8_t blockTexels[64];
+        for(int blockY = 0; blockY < blocksY; blockY++)
+        {
+            for(int blockX = 0; blockX < blocksX; blockX++)
+            {
+                for(int y = 0; y < 4; y++)
+                {
+                    const int sourceY = std::min(blockY * 4 + y, height - 1);
+                    for(int x = 0; x < 4; x++)
+                    {
+                        const int sourceX = std::min(blockX * 4 + x, width - 1);
+                        memcpy(blockTexels + (y * 4 + x) * 4,
+                               texels + (size_t(sourceY) * size_t(width) + size_t(sourceX)) * 4,
+                               4);
+                    }
+                }
+
+                uint8_t* block = output.data() + offset;
+                if(withAlpha)
+                {
+                    compressAlphaBlock(blockTexels, block);
+                    block += 8;
+                }
+                compressColorBlock(blockTexels, block);
+                offset += blockSize;
+            }
+        }
+    }
+
+    /**
+     * Replaces the levels and layers of an uncompressed RGBA8 image by their BC1 (DXT1) encoding,
+     * or BC3 (DXT5) if any texel isn't fully opaque. Cuts the size of the image to 1/8 or 1/4.
+     *
+     * @param image The image, converted in place.
+     * @return True if the image was compressed, false if it isn't an RGBA8 image.
+     */
+    static bool compressImage(ImageData& image)
+    {
+        if(image.isCompressed || image.levels.empty() || image.format != GL_RGBA ||
+           image.type != GL_UNSIGNED_BYTE || image.file)
+        {
+            return false;
+        }
+
+        bool withAlpha = false;
+        for(const ImageLevel& base : image.levels)
+        {
+            for(size_t texel = 0; base.level == 0 && texel < base.size / 4 && !withAlpha; texel++)
+            {
+                withAlpha = image.pixels[base.offset + texel * 4 + 3] != 255;
+            }
+        }
+
+        std::vector<uint8_t> blocks;
+        std::vector<ImageLevel> levels;
+        for(const ImageLevel& level : image.levels)
+        {
+            const size_t offset = blocks.size();
+            compressLevel(image.pixels.data() + level.offset, level.width, level.height, withAlpha, blocks);
+            const size_t size = blocks.size() - offset;
+            levels.push_back({ offset, size, level.width, level.height, level.level, level.layer });
+        }
+
+        image.internalFormat =
+                withAlpha ? GL_COMPRESSED_RGBA_S3TC_DXT5_EXT : GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+        image.isCompressed = true;
+        image.pixels.swap(blocks);
+        image.levels.swap(levels);
+        return true;
+    }
+} // namespace Engine
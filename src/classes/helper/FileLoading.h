@@ -3,388 +3,398 @@
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 
+#include <algorithm>
+#include <cstring>
 #include <iostream>
+#include <memory>
 #include <vector>
 
-#define FOURCC_DXT1 0x31545844 // Equivalent to "DXT1" in ASCII
-#define FOURCC_DXT3 0x33545844 // Equivalent to "DXT3" in ASCII
-#define FOURCC_DXT5 0x35545844 // Equivalent to "DXT5" in ASCII
+#include <stb_image.h>
+
+#include "AssetFile.h"
+#include "ImageData.h"
+#include "MipmapGenerator.h"
+#include "ObjParser.h"
+#include "TextureFileParser.h"
 
 namespace Engine
 {
     /**
      * Loads an OBJ file and extracts the vertex positions, texture coordinates, and normals.
+     * The file is memory mapped and parsed in place, faces with more than three corners are triangulated.
      *
      * @param filePath The path to the OBJ file.
      * @param vertices The vector to store the vertex positions.
      * @param uvs The vector to store the texture coordinates.
      * @param normals The vector to store the normals.
+     * @param runTasks Parses the chunks of large files concurrently, see parseObj.
      * @return True if the file was loaded successfully, false otherwise.
      */
     static bool loadFileOBJ(
             const char* filePath,
             std::vector<glm::vec3>& vertices,
             std::vector<glm::vec2>& uvs,
-            std::vector<glm::vec3>& normals
+            std::vector<glm::vec3>& normals,
+            const ObjTaskRunner& runTasks = nullptr
     )
     {
-        std::vector<unsigned int> vertexIndices, uvIndices, normalIndices;
-        std::vector<glm::vec3> temp_vertices, temp_normals;
-        std::vector<glm::vec2> temp_uvs;
-
-        FILE* file = fopen(filePath, "r");
-        if(file == nullptr)
+        AssetFile file(filePath);
+        if(!file.isOpen())
         {
             std::cout << "Couldn't open file [" << filePath << "]" << std::endl;
             return false;
         }
 
-        while(true)
-        {
-            char line[128];
-            if(fgets(line, 128, file) == nullptr)
-            {
-                break;
-            }
+        ObjMeshData mesh;
+        parseObj(file.data(), file.end(), mesh, 0, runTasks);
 
-            // read first word
-            char firstWord[128];
-            sscanf(line, "%s", firstWord);
+        return expandObjCorners(mesh, vertices, uvs, normals, filePath);
+    }
 
-            if(strcmp(firstWord, "v") == 0)
-            {
-                glm::vec3 vertex;
-                sscanf(line, "v %f %f %f", &vertex.x, &vertex.y, &vertex.z);
-                temp_vertices.push_back(vertex);
-            }
-            else if(strcmp(firstWord, "vt") == 0)
-            {
-                glm::vec2 uv;
-                sscanf(line, "vt %f %f", &uv.x, &uv.y);
-                temp_uvs.push_back(uv);
-            }
-            else if(strcmp(firstWord, "vn") == 0)
-            {
-                glm::vec3 normal;
-                sscanf(line, "vn %f %f %f", &normal.x, &normal.y, &normal.z);
-                temp_normals.push_back(normal);
-            }
-            else if(strcmp(firstWord, "f") == 0)
-            {
-                unsigned int vertexIndex[3], uvIndex[3], normalIndex[3];
-                int matches =
-                        sscanf(line,
-                               "f %d/%d/%d %d/%d/%d %d/%d/%d",
-                               &vertexIndex[0],
-                               &uvIndex[0],
-                               &normalIndex[0],
-                               &vertexIndex[1],
-                               &uvIndex[1],
-                               &normalIndex[1],
-                               &vertexIndex[2],
-                               &uvIndex[2],
-                               &normalIndex[2]);
-                if(matches != 9)
-                {
-                    matches =
-                            sscanf(line,
-                                   "f %i//%i %i//%i %i//%i",
-                                   &vertexIndex[0],
-                                   &normalIndex[0],
-                                   &vertexIndex[1],
-                                   &normalIndex[1],
-                                   &vertexIndex[2],
-                                   &normalIndex[2]);
-                    if(matches != 6)
-                    {
-                        matches =
-                                sscanf(line,
-                                       "f %i/%i %i/%i %i/%i",
-                                       &vertexIndex[0],
-                                       &uvIndex[0],
-                                       &vertexIndex[1],
-                                       &uvIndex[1],
-                                       &vertexIndex[2],
-                                       &uvIndex[2]);
-                        if(matches != 6)
-                        {
-                            sscanf(line, "f %i %i %i", &vertexIndex[0], &vertexIndex[1], &vertexIndex[2]);
-                            vertexIndices.push_back(vertexIndex[0]);
-                            vertexIndices.push_back(vertexIndex[1]);
-                            vertexIndices.push_back(vertexIndex[2]);
-                            continue;
-                        }
-                        vertexIndices.push_back(vertexIndex[0]);
-                        vertexIndices.push_back(vertexIndex[1]);
-                        vertexIndices.push_back(vertexIndex[2]);
-                        uvIndices.push_back(uvIndex[0]);
-                        uvIndices.push_back(uvIndex[1]);
-                        uvIndices.push_back(uvIndex[2]);
-                        continue;
-                    }
-                    vertexIndices.push_back(vertexIndex[0]);
-                    vertexIndices.push_back(vertexIndex[1]);
-                    vertexIndices.push_back(vertexIndex[2]);
-                    normalIndices.push_back(normalIndex[0]);
-                    normalIndices.push_back(normalIndex[1]);
-                    normalIndices.push_back(normalIndex[2]);
-                    continue;
-                }
-                vertexIndices.push_back(vertexIndex[0]);
-                vertexIndices.push_back(vertexIndex[1]);
-                vertexIndices.push_back(vertexIndex[2]);
-                uvIndices.push_back(uvIndex[0]);
-                uvIndices.push_back(uvIndex[1]);
-                uvIndices.push_back(uvIndex[2]);
-                normalIndices.push_back(normalIndex[0]);
-                normalIndices.push_back(normalIndex[1]);
-                normalIndices.push_back(normalIndex[2]);
-                continue;
-            }
+    /**
+     * BC6H and BC7 need OpenGL 4.2 or ARB_texture_compression_bptc, which macOS doesn't provide.
+     *
+     * @return True if textures of the image's format can be created on this system
+     */
+    static bool isImageFormatSupported(const ImageData& image)
+    {
+        switch(image.internalFormat)
+        {
+            case GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT:
+            case GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT:
+            case GL_COMPRESSED_RGBA_BPTC_UNORM:
+            case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+                return GLEW_ARB_texture_compression_bptc;
+            default:
+                return true;
         }
+    }
 
-        for(unsigned int i = 0; i < vertexIndices.size(); i++)
+    /**
+     * Maps a DDS or KTX2 file and describes its texture. The image keeps the file mapped,
+     * its levels are uploaded straight from the mapping without copying them first.
+     *
+     * @param filePath The path to the texture file.
+     * @param image Receives the image.
+     * @param parse parseDDS or parseKTX2.
+     * @return True if the file was decoded successfully, false otherwise.
+     */
+    static bool decodeMappedTexture(
+            const char* filePath,
+            ImageData& image,
+            bool (*parse)(const unsigned char*, size_t, ImageData&, const char*)
+    )
+    {
+        auto file = std::make_shared<AssetFile>(filePath);
+        if(!file->isOpen())
         {
-            unsigned int vertexIndex = vertexIndices[i];
-            glm::vec3 vertex = temp_vertices[vertexIndex - 1];
-            vertices.push_back(vertex);
+            std::cout << "Couldn't open file [" << filePath << "]" << std::endl;
+            return false;
+        }
 
-            if(uvIndices.size() > i)
-            {
-                unsigned int uvIndex = uvIndices[i];
-                glm::vec2 uv = temp_uvs[uvIndex - 1];
-                uvs.push_back(uv);
-            }
+        const auto* data = reinterpret_cast<const unsigned char*>(file->data());
+        if(!parse(data, file->size(), image, filePath))
+        {
+            return false;
+        }
 
-            if(normalIndices.size() > i)
-            {
-                unsigned int normalIndex = normalIndices[i];
-                glm::vec3 normal = temp_normals[normalIndex - 1];
-                normals.push_back(normal);
-            }
+        if(!isImageFormatSupported(image))
+        {
+            std::cout << "Texture format not supported by the GPU [" << filePath << "]" << std::endl;
+            return false;
         }
 
+        image.file = std::move(file);
         return true;
     }
 
     /**
-     * Loads a DDS file and returns the OpenGL texture ID.
+     * Reads a DDS file including its mip levels, array layers and cube map faces.
      *
      * @param filePath The path to the DDS file.
-     * @return The OpenGL texture ID if the file was loaded successfully, -1 otherwise.
+     * @param image Receives the image, mapped from the file.
+     * @return True if the file was decoded successfully, false otherwise.
      */
-    static GLuint loadFileDDS(const char* filePath)
+    static bool decodeFileDDS(const char* filePath, ImageData& image)
     {
-        unsigned char header[124];
+        return decodeMappedTexture(filePath, image, parseDDS);
+    }
 
-        FILE* fp;
+    /**
+     * Reads a KTX2 file including its mip levels, array layers and cube map faces.
+     *
+     * @param filePath The path to the KTX2 file.
+     * @param image Receives the image, mapped from the file.
+     * @return True if the file was decoded successfully, false otherwise.
+     */
+    static bool decodeFileKTX2(const char* filePath, ImageData& image)
+    {
+        return decodeMappedTexture(filePath, image, parseKTX2);
+    }
 
-        /* try to open the file */
-        fp = fopen(filePath, "rb");
-        if(fp == nullptr)
+    /**
+     * Reads a BMP, TGA or PNG file through stb_image and generates its mip chain on the CPU.
+     * Only touches the given image, so any number of files can be decoded on worker threads at once.
+     *
+     * @param filePath The path to the image file.
+     * @param image Receives the RGBA pixels of all mip levels, bottom row first like OpenGL expects.
+     * @return True if the file was decoded successfully, false otherwise.
+     */
+    static bool decodeFileImage(const char* filePath, ImageData& image)
+    {
+        AssetFile file(filePath);
+        if(!file.isOpen())
         {
-            printf("%s could not be opened. Are you in the right directory ? Don't forget to read the FAQ !\n",
-                   filePath);
-            getchar();
-            return -1;
+            std::cout << "Couldn't open file [" << filePath << "]" << std::endl;
+            return false;
         }
 
-        /* verify the type of file */
-        char filecode[4];
-        fread(filecode, 1, 4, fp);
-        if(strncmp(filecode, "DDS ", 4) != 0)
+        int width, height, channels;
+        stbi_uc* texels = stbi_load_from_memory(
+                reinterpret_cast<const stbi_uc*>(file.data()),
+                int(file.size()),
+                &width,
+                &height,
+                &channels,
+                STBI_rgb_alpha
+        );
+        if(texels == nullptr)
         {
-            fclose(fp);
-            return -1;
+            std::cout << "Image file is not correct [" << filePath << "] " << stbi_failure_reason()
+                      << std::endl;
+            return false;
         }
 
-        /* get the surface desc */
-        fread(&header, 124, 1, fp);
-
-        unsigned int height = *(unsigned int*)&(header[8]);
-        unsigned int width = *(unsigned int*)&(header[12]);
-        unsigned int linearSize = *(unsigned int*)&(header[16]);
-        unsigned int mipMapCount = *(unsigned int*)&(header[24]);
-        unsigned int fourCC = *(unsigned int*)&(header[80]);
-
-        unsigned char* buffer;
-        unsigned int bufsize;
-        /* how big is it going to be including all mipmaps? */
-        bufsize = mipMapCount > 1 ? linearSize * 2 : linearSize;
-        buffer = (unsigned char*)malloc(bufsize * sizeof(unsigned char));
-        fread(buffer, 1, bufsize, fp);
-        /* close the file pointer */
-        fclose(fp);
-
-        unsigned int format;
-        switch(fourCC)
+        // stb_image returns the top row first, textures start with the bottom row
+        const size_t rowSize = size_t(width) * 4;
+        image.pixels.resize(rowSize * size_t(height));
+        for(int row = 0; row < height; row++)
         {
-            case FOURCC_DXT1:
-                format = GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
-                break;
-            case FOURCC_DXT3:
-                format = GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
-                break;
-            case FOURCC_DXT5:
-                format = GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
-                break;
-            default:
-                free(buffer);
-                return 0;
+            memcpy(image.pixels.data() + size_t(height - 1 - row) * rowSize,
+                   texels + size_t(row) * rowSize,
+                   rowSize);
         }
+        stbi_image_free(texels);
+
+        image.internalFormat = GL_RGBA8;
+        image.format = GL_RGBA;
+        image.type = GL_UNSIGNED_BYTE;
+        image.isCompressed = false;
+        image.generateMipmaps = false;
+        image.levels = { { 0, image.pixels.size(), GLsizei(width), GLsizei(height) } };
+
+        generateMipChain(image);
+        return true;
+    }
+
+    /**
+     * Creates a texture from a decoded image, has to be called on the thread owning the GL context.
+     *
+     * @param image The decoded image.
+     * @param pixels Where the pixel data of the image starts, either client memory or an offset into the
+     * bound GL_PIXEL_UNPACK_BUFFER.
+     * @return The OpenGL texture ID.
+     */
+    static GLuint uploadImage(const ImageData& image, const unsigned char* pixels)
+    {
+        const GLenum target = image.target;
+        const bool isArray = target == GL_TEXTURE_2D_ARRAY || target == GL_TEXTURE_CUBE_MAP_ARRAY;
 
         // Create one OpenGL texture
         GLuint textureID;
         glGenTextures(1, &textureID);
 
         // "Bind" the newly created texture : all future texture functions will modify this texture
-        glBindTexture(GL_TEXTURE_2D, textureID);
+        glBindTexture(target, textureID);
         glPixelStorei(GL_UNPACK_ALIGNMENT, 1);
 
-        unsigned int blockSize = (format == GL_COMPRESSED_RGBA_S3TC_DXT1_EXT) ? 8 : 16;
-        unsigned int offset = 0;
+        GLint maxLevel = 0;
+        if(isArray)
+        {
+            // Array levels are allocated for all layers first, without reading from a bound unpack buffer
+            GLint unpackBuffer = 0;
+            glGetIntegerv(GL_PIXEL_UNPACK_BUFFER_BINDING, &unpackBuffer);
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, 0);
+            for(const ImageLevel& mip : image.levels)
+            {
+                if(mip.layer != 0)
+                {
+                    continue;
+                }
+
+                if(image.isCompressed)
+                {
+                    glCompressedTexImage3D(
+                            target,
+                            mip.level,
+                            image.internalFormat,
+                            mip.width,
+                            mip.height,
+                            image.layerCount,
+                            0,
+                            GLsizei(mip.size * size_t(image.layerCount)),
+                            nullptr
+                    );
+                }
+                else
+                {
+                    glTexImage3D(
+                            target,
+                            mip.level,
+                            GLint(image.internalFormat),
+                            mip.width,
+                            mip.height,
+                            image.layerCount,
+                            0,
+                            image.format,
+                            image.type,
+                            nullptr
+                    );
+                }
+            }
+            glBindBuffer(GL_PIXEL_UNPACK_BUFFER, GLuint(unpackBuffer));
+        }
 
-        /* load the mipmaps */
-        for(unsigned int level = 0; level < mipMapCount && (width || height); ++level)
+        for(const ImageLevel& mip : image.levels)
         {
-            unsigned int size = ((width + 3) / 4) * ((height + 3) / 4) * blockSize;
-            glCompressedTexImage2D(
-                    GL_TEXTURE_2D,
-                    GLint(level),
-                    format,
-                    GLsizei(width),
-                    GLsizei(height),
-                    0,
-                    GLsizei(size),
-                    buffer + offset
-            );
-
-            offset += size;
-            width /= 2;
-            height /= 2;
-
-            // Deal with Non-Power-Of-Two textures. This code is not included in the webpage to reduce clutter.
-            if(width < 1)
+            maxLevel = std::max(maxLevel, mip.level);
+            if(isArray)
+            {
+                if(image.isCompressed)
+                {
+                    glCompressedTexSubImage3D(
+                            target,
+                            mip.level,
+                            0,
+                            0,
+                            mip.layer,
+                            mip.width,
+                            mip.height,
+                            1,
+                            image.internalFormat,
+                            GLsizei(mip.size),
+                            pixels + mip.offset
+                    );
+                }
+                else
+                {
+                    glTexSubImage3D(
+                            target,
+                            mip.level,
+                            0,
+                            0,
+                            mip.layer,
+                            mip.width,
+                            mip.height,
+                            1,
+                            image.format,
+                            image.type,
+                            pixels + mip.offset
+                    );
+                }
+                continue;
+            }
+
+            // Cube map faces are uploaded to their own targets
+            GLenum imageTarget = target;
+            if(target == GL_TEXTURE_CUBE_MAP)
+            {
+                imageTarget = GL_TEXTURE_CUBE_MAP_POSITIVE_X + GLenum(mip.layer);
+            }
+            if(image.isCompressed)
             {
-                width = 1;
+                glCompressedTexImage2D(
+                        imageTarget,
+                        mip.level,
+                        image.internalFormat,
+                        mip.width,
+                        mip.height,
+                        0,
+                        GLsizei(mip.size),
+                        pixels + mip.offset
+                );
             }
-            if(height < 1)
+            else
             {
-                height = 1;
+                glTexImage2D(
+                        imageTarget,
+                        mip.level,
+                        GLint(image.internalFormat),
+                        mip.width,
+                        mip.height,
+                        0,
+                        image.format,
+                        image.type,
+                        pixels + mip.offset
+                );
             }
         }
 
-        free(buffer);
+        const bool isCubeMap = target == GL_TEXTURE_CUBE_MAP || target == GL_TEXTURE_CUBE_MAP_ARRAY;
+        const GLint wrapMode = isCubeMap ? GL_CLAMP_TO_EDGE : GL_REPEAT;
+        glTexParameteri(target, GL_TEXTURE_WRAP_S, wrapMode);
+        glTexParameteri(target, GL_TEXTURE_WRAP_T, wrapMode);
+        glTexParameteri(target, GL_TEXTURE_WRAP_R, wrapMode);
+        if(image.generateMipmaps || maxLevel > 0)
+        {
+            // Nice trilinear filtering ...
+            glTexParameteri(target, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
+            glTexParameteri(target, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
+        }
+        if(image.generateMipmaps)
+        {
+            // ... which requires mipmaps. Generate them automatically unless they were decoded.
+            glGenerateMipmap(target);
+        }
+        else
+        {
+            // Files may stop before the 1x1 level, the texture is complete with the levels it has
+            glTexParameteri(target, GL_TEXTURE_MAX_LEVEL, maxLevel);
+        }
 
+        // Return the ID of the texture we just created
         return textureID;
     }
 
     /**
-     * Loads a BMP file and returns the OpenGL texture ID.
+     * Creates a texture from a decoded image, has to be called on the thread owning the GL context.
      *
-     * @param filePath The path to the BMP file.
+     * @param image The decoded image.
+     * @return The OpenGL texture ID.
+     */
+    static GLuint uploadImage(const ImageData& image) { return uploadImage(image, image.getPixelData()); }
+
+    /**
+     * Loads a DDS file and returns the OpenGL texture ID.
+     *
+     * @param filePath The path to the DDS file.
      * @return The OpenGL texture ID if the file was loaded successfully, -1 otherwise.
      */
-    static GLuint loadFileBMP(const char* filePath)
+    static GLuint loadFileDDS(const char* filePath)
     {
-        // Data read from the header of the BMP file
-        unsigned int width, height;
-        unsigned char* data;
-        unsigned char header[54];
-        unsigned int dataPos;
-        unsigned int imageSize;
-
-        // Open the file
-        FILE* file = fopen(filePath, "rb");
-        if(!file)
+        ImageData image;
+        if(!decodeFileDDS(filePath, image))
         {
-            std::cout << "Couldn't open file [" << filePath << "]" << std::endl;
             return -1;
         }
 
-        // Read the header, i.e. the 54 first bytes
+        return uploadImage(image);
+    }
 
-        // If less than 54 bytes are read, problem
-        if(fread(header, 1, 54, file) != 54)
-        {
-            std::cout << "BMP file is not correct [" << filePath << "]" << std::endl;
-            fclose(file);
-            return -1;
-        }
-        // A BMP files always begins with "BM"
-        if(header[0] != 'B' || header[1] != 'M')
-        {
-            std::cout << "BMP file is not correct [" << filePath << "]" << std::endl;
-            fclose(file);
-            return -1;
-        }
-        // Make sure this is a 24bpp file
-        if(*(int*)&(header[0x1E]) != 0)
-        {
-            std::cout << "BMP file is not correct [" << filePath << "]" << std::endl;
-            fclose(file);
-            return -1;
-        }
-        if(*(int*)&(header[0x1C]) != 24)
+    /**
+     * Loads a BMP, TGA or PNG file and returns the OpenGL texture ID.
+     *
+     * @param filePath The path to the image file.
+     * @return The OpenGL texture ID if the file was loaded successfully, -1 otherwise.
+     */
+    static GLuint loadFileImage(const char* filePath)
+    {
+        ImageData image;
+        if(!decodeFileImage(filePath, image))
         {
-            std::cout << "BMP file is not correct [" << filePath << "]" << std::endl;
-            fclose(file);
             return -1;
         }
 
-        // Read the information about the image
-        dataPos = *(int*)&(header[0x0A]);
-        imageSize = *(int*)&(header[0x22]) * 3;
-        width = *(int*)&(header[0x12]);
-        height = *(int*)&(header[0x16]);
-
-        // Some BMP files are misformatted, guess missing information
-        if(imageSize == 0)
-        {
-            imageSize = width * height * 3; // 3 : one byte for each Red, Green and Blue component
-        }
-        if(dataPos == 0)
-        {
-            dataPos = 54; // The BMP header is done that way
-        }
-
-        // Create a buffer
-        data = new unsigned char[imageSize];
-
-        // Read the actual data from the file into the buffer
-        fseek(file, dataPos, SEEK_SET);
-        fread(data, 1, imageSize, file);
-
-        // Everything is in memory now, the file can be closed.
-        fclose(file);
-
-        // TODO: read up what all of this does in more detail
-        // Create one OpenGL texture
-        GLuint textureID;
-        glGenTextures(1, &textureID);
-
-        // "Bind" the newly created texture : all future texture functions will modify this texture
-        glBindTexture(GL_TEXTURE_2D, textureID);
-
-        // Give the image to OpenGL
-        glTexImage2D(GL_TEXTURE_2D, 0, GL_RGB, GLsizei(width), GLsizei(height), 0, GL_BGR, GL_UNSIGNED_BYTE, data);
-
-        // OpenGL has now copied the data. Free our own version
-        delete[] data;
-
-        // Poor filtering...
-        // glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_NEAREST);
-        // glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_NEAREST);
-
-        // Nice trilinear filtering ...
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_S, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_WRAP_T, GL_REPEAT);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MAG_FILTER, GL_LINEAR);
-        glTexParameteri(GL_TEXTURE_2D, GL_TEXTURE_MIN_FILTER, GL_LINEAR_MIPMAP_LINEAR);
-        // ... which requires mipmaps. Generate them automatically.
-        glGenerateMipmap(GL_TEXTURE_2D);
-
-        // Return the ID of the texture we just created
-        return textureID;
+        return uploadImage(image);
     }
-} // namespace Engine
\ No newline at end of file
+} // namespace Engine
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+#include <vector>
+
+namespace Engine
+{
+    inline constexpr uint64_t HASH_PRIME_1 = 0x9E3779B185EBCA87ull;
+    inline constexpr uint64_t HASH_PRIME_2 = 0xC2B2AE3D27D4EB4Full;
+    inline constexpr uint64_t HASH_PRIME_3 = 0x165667B19E3779F9ull;
+    inline constexpr uint64_t HASH_PRIME_4 = 0x85EBCA77C2B2AE63ull;
+    inline constexpr uint64_t HASH_PRIME_5 = 0x27D4EB2F165667C5ull;
+
+    static inline uint64_t hashRotateLeft(uint64_t value, int bits)
+    {
+        return (value << bits) | (value >> (64 - bits));
+    }
+
+    static inline uint64_t hashRound(uint64_t acc, uint64_t input)
+    {
+        acc += input * HASH_PRIME_2;
+        acc = hashRotateLeft(acc, 31);
+        return acc * HASH_PRIME_1;
+    }
+
+    static inline uint64_t hashMergeRound(uint64_t acc, uint64_t value)
+    {
+        acc ^= hashRound(0, value);
+        return acc * HASH_PRIME_1 + HASH_PRIME_4;
+    }
+
+    static inline uint64_t hashRead64(const unsigned char* data)
+    {
+        uint64_t value;
+        memcpy(&value, data, sizeof(uint64_t));
+        return value;
+    }
+
+    static inline uint32_t hashRead32(const unsigned char* data)
+    {
+        uint32_t value;
+        memcpy(&value, data, sizeof(uint32_t));
+        return value;
+    }
+
+    /**
+     * Hashes a block of memory with the 64 bit xxHash algorithm.
+     * Passing the result of a previous call as the seed chains multiple blocks into one hash.
+     *
+     * @param data Pointer to the first byte to hash.
+     * @param size The amount of bytes to hash.
+     * @param seed The seed of the hash.
+     * @return The 64 bit hash value.
+     */
+    static uint64_t hashBytes(const void* data, size_t size, uint64_t seed = 0)
+    {
+        const auto* pos = static_cast<const unsigned char*>(data);
+        const unsigned char* end = pos + size;
+        uint64_t hash;
+
+        if(size >= 32)
+        {
+            uint64_t v1 = seed + HASH_PRIME_1 + HASH_PRIME_2;
+            uint64_t v2 = seed + HASH_PRIME_2;
+            uint64_t v3 = seed;
+            uint64_t v4 = seed - HASH_PRIME_1;
+
+            const unsigned char* limit = end - 32;
+            do
+            {
+                v1 = hashRound(v1, hashRead64(pos));
+                v2 = hashRound(v2, hashRead64(pos + 8));
+                v3 = hashRound(v3, hashRead64(pos + 16));
+                v4 = hashRound(v4, hashRead64(pos + 24));
+                pos += 32;
+            } while(pos <= limit);
+
+            hash = hashRotateLeft(v1, 1) + hashRotateLeft(v2, 7);
+            hash += hashRotateLeft(v3, 12) + hashRotateLeft(v4, 18);
+            hash = hashMergeRound(hash, v1);
+            hash = hashMergeRound(hash, v2);
+            hash = hashMergeRound(hash, v3);
+            hash = hashMergeRound(hash, v4);
+        }
+        else
+        {
+            hash = seed + HASH_PRIME_5;
+        }
+
+        hash += uint64_t(size);
+
+        while(pos + 8 <= end)
+        {
+            hash ^= hashRound(0, hashRead64(pos));
+            hash = hashRotateLeft(hash, 27) * HASH_PRIME_1 + HASH_PRIME_4;
+            pos += 8;
+        }
+
+        if(pos + 4 <= end)
+        {
+            hash ^= uint64_t(hashRead32(pos)) * HASH_PRIME_1;
+            hash = hashRotateLeft(hash, 23) * HASH_PRIME_2 + HASH_PRIME_3;
+            pos += 4;
+        }
+
+        while(pos < end)
+        {
+            hash ^= uint64_t(*pos) * HASH_PRIME_5;
+            hash = hashRotateLeft(hash, 11) * HASH_PRIME_1;
+            pos++;
+        }
+
+        hash ^= hash >> 33;
+        hash *= HASH_PRIME_2;
+        hash ^= hash >> 29;
+        hash *= HASH_PRIME_3;
+        hash ^= hash >> 32;
+
+        return hash;
+    }
+
+    static uint64_t hashString(std::string_view string, uint64_t seed = 0)
+    {
+        return hashBytes(string.data(), string.size(), seed);
+    }
+
+    template<typename T>
+    static uint64_t hashVector(const std::vector<T>& data, uint64_t seed = 0)
+    {
+        return hashBytes(data.data(), data.size() * sizeof(T), seed);
+    }
+} // namespace Engine
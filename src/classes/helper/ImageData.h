@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "AssetFile.h"
+
+namespace Engine
+{
+    /**
+     * @brief One mip level of an ImageData, stored at offset inside its pixel data.
+     */
+    struct ImageLevel
+    {
+            size_t offset;
+            size_t size;
+            GLsizei width;
+            GLsizei height;
+            // Mip level and array layer the image belongs to, cube map faces count as layers
+            GLint level = 0;
+            GLint layer = 0;
+    };
+
+    /**
+     * @brief A decoded image in CPU memory, ready to be uploaded into a texture.
+     * Decoding doesn't need a GL context, so it can happen on any thread.
+     */
+    struct ImageData
+    {
+            // Internal format of the texture, a compressed format if isCompressed is set
+            GLenum internalFormat = GL_RGB;
+            // Pixel format and type of uncompressed data
+            GLenum format = GL_RGB;
+            GLenum type = GL_UNSIGNED_BYTE;
+            bool isCompressed = false;
+            // Create the remaining mip levels after uploading the ones in levels
+            bool generateMipmaps = false;
+
+            // GL_TEXTURE_2D, GL_TEXTURE_2D_ARRAY, GL_TEXTURE_CUBE_MAP or GL_TEXTURE_CUBE_MAP_ARRAY
+            GLenum target = GL_TEXTURE_2D;
+            // Images per mip level, array layers times cube faces
+            GLsizei layerCount = 1;
+
+            std::vector<unsigned char> pixels;
+            // Set instead of pixels if the levels point straight into a mapped file or asset pack
+            std::shared_ptr<const AssetFile> file;
+            std::vector<ImageLevel> levels;
+
+            /**
+             * @return The data the offsets of the levels refer to
+             */
+            const unsigned char* getPixelData() const
+            {
+                return file ? reinterpret_cast<const unsigned char*>(file->data()) : pixels.data();
+            }
+
+            size_t getPixelDataSize() const { return file ? file->size() : pixels.size(); }
+    };
+
+    /**
+     * Estimates the video memory a texture created from the image takes. Uncompressed formats are counted
+     * with four bytes per texel since drivers pad RGB textures, generated mip levels add a third.
+     *
+     * @param image The decoded image.
+     * @return The estimated size in bytes.
+     */
+    static size_t estimateImageBytes(const ImageData& image)
+    {
+        size_t bytes = 0;
+        for(const ImageLevel& level : image.levels)
+        {
+            bytes += image.isCompressed ? level.size : size_t(level.width) * size_t(level.height) * 4;
+        }
+
+        return image.generateMipmaps ? bytes + bytes / 3 : bytes;
+    }
+} // namespace Engine
@@ -0,0 +1,348 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define LIGHT_CLUSTERING_SSE2 1
+#endif
+
+#include <glm/glm.hpp>
+
+namespace Engine
+{
+    /**
+     * Froxel grid the view frustum is split into. Tiles split the screen evenly, slices split the depth
+     * exponentially between zNear and zFar, so clusters far away aren't much deeper than they're wide.
+     */
+    struct ClusterGrid
+    {
+            glm::ivec3 size = glm::ivec3(16, 9, 24);
+            float zNear = 0.1f;
+            float zFar = 100.f;
+    };
+
+    /**
+     * A light in view space, as the cluster tests see it.
+     */
+    struct ClusterLight
+    {
+            glm::vec3 position;
+            float range;
+            // Only used by spot lights, normalized
+            glm::vec3 direction;
+            float cosOuterAngle;
+            bool isSpot;
+    };
+
+    /**
+     * View space bounds of every cluster, each box also as its bounding sphere for the cone test.
+     * Stored as one array per component.
+     * Cluster x, y, z has the index x + size.x * (y + size.y * z).
+     */
+    struct ClusterBounds
+    {
+            ClusterGrid grid;
+            std::vector<float> minX, minY, minZ;
+            std::vector<float> maxX, maxY, maxZ;
+            std::vector<float> centerX, centerY, centerZ;
+            std::vector<float> radius;
+    };
+
+    /**
+     * The lights of the clusters of one depth slice.
+     */
+    struct LightClusterSlice
+    {
+            // Lights per cluster of the slice, in the order of the clusters
+            std::vector<uint32_t> counts;
+            // The light indices of all clusters of the slice, one run per cluster
+            std::vector<uint32_t> indices;
+    };
+
+    /**
+     * @return The view space distance the depth slice starts at, slice size.z is where the last one ends
+     */
+    static float getClusterSliceDepth(const ClusterGrid& grid, int slice)
+    {
+        return grid.zNear * std::pow(grid.zFar / grid.zNear, float(slice) / float(grid.size.z));
+    }
+
+    /**
+     * Computes the view space bounds of the clusters of a symmetric perspective projection.
+     * The camera looks along -z, tile 0, 0 is the bottom left corner of the screen like gl_FragCoord.
+     *
+     * @param grid The grid to split the frustum into
+     * @param tanHalfFovX tan of half the horizontal field of view
+     * @param tanHalfFovY tan of half the vertical field of view
+     * @param bounds Receives the bounds of every cluster
+     */
+    static void buildClusterBounds(
+            const ClusterGrid& grid,
+            float tanHalfFovX,
+            float tanHalfFovY,
+            ClusterBounds& bounds
+    )
+    {
+        const size_t clusterCount = size_t(grid.size.x) * size_t(grid.size.y) * size_t(grid.size.z);
+        bounds.grid = grid;
+        for(std::vector<float>* component : { &bounds.minX, &bounds.minY, &bounds.minZ, &bounds.maxX,
+                                              &bounds.maxY, &bounds.maxZ, &bounds.centerX, &bounds.centerY,
+                                              &bounds.centerZ, &bounds.radius })
+        {
+            component->resize(clusterCount);
+        }
+
+        size_t cluster = 0;
+        for(int z = 0; z < grid.size.z; z++)
+        {
+            const float near = getClusterSliceDepth(grid, z);
+            const float far = getClusterSliceDepth(grid, z + 1);
+            for(int y = 0; y < grid.size.y; y++)
+            {
+                const float bottom = (-1.f + 2.f * float(y) / float(grid.size.y)) * tanHalfFovY;
+                const float top = (-1.f + 2.f * float(y + 1) / float(grid.size.y)) * tanHalfFovY;
+                for(int x = 0; x < grid.size.x; x++, cluster++)
+                {
+                    const float left = (-1.f + 2.f * float(x) / float(grid.size.x)) * tanHalfFovX;
+                    const float right = (-1.f + 2.f * float(x + 1) / float(grid.size.x)) * tanHalfFovX;
+
+                    // The tile's edges widen with the depth, the box has to hold them at both ends
+                    const glm::vec3 min = glm::vec3(
+                            std::min(left * near, left * far), std::min(bottom * near, bottom * far), -far
+                    );
+                    const glm::vec3 max = glm::vec3(
+                            std::max(right * near, right * far), std::max(top * near, top * far), -near
+                    );
+                    const glm::vec3 center = (min + max) * 0.5f;
+
+                    bounds.minX[cluster] = min.x;
+                    bounds.minY[cluster] = min.y;
+                    bounds.minZ[cluster] = min.z;
+                    bounds.maxX[cluster] = max.x;
+                    bounds.maxY[cluster] = max.y;
+                    bounds.maxZ[cluster] = max.z;
+                    bounds.centerX[cluster] = center.x;
+                    bounds.centerY[cluster] = center.y;
+                    bounds.centerZ[cluster] = center.z;
+                    bounds.radius[cluster] = glm::length(max - center);
+                }
+            }
+        }
+    }
+
+    /**
+     * Finds the lights touching each cluster of a depth slice. Every light is tested as a sphere against
+     * the cluster's box, spot lights additionally as a cone against the cluster's bounding sphere.
+     * Slices don't share any data, so they can be assigned on different threads.
+     *
+     * @param bounds The bounds built by buildClusterBounds
+     * @param lights The lights in view space
+     * @param slice The depth slice to assign
+     * @param out Receives the lights of the slice's clusters, its memory is reused between calls
+     * @param useSimd Whether to use SSE2 where available, the result is identical either way.
+     */
+    static void assignClusterSlice(
+            const ClusterBounds& bounds,
+            const std::vector<ClusterLight>& lights,
+            int slice,
+            LightClusterSlice& out,
+            bool useSimd = true
+    )
+    {
+        const size_t tileCount = size_t(bounds.grid.size.x) * size_t(bounds.grid.size.y);
+        const size_t firstCluster = size_t(slice) * tileCount;
+        out.counts.assign(tileCount, 0);
+        out.indices.clear();
+        if(tileCount == 0 || lights.empty())
+        {
+            return;
+        }
+
+        // Only lights reaching into the slice's depth range are tested, one array per component
+        const float sliceMinZ = bounds.minZ[firstCluster];
+        const float sliceMaxZ = bounds.maxZ[firstCluster];
+        std::vector<uint32_t> indices;
+        std::vector<float> positionX, positionY, positionZ, range;
+        std::vector<float> directionX, directionY, directionZ, cosOuterAngle, sinOuterAngle;
+        std::vector<float> isSpot;
+        for(size_t i = 0; i < lights.size(); i++)
+        {
+            const ClusterLight& light = lights[i];
+            if(light.position.z - light.range > sliceMaxZ || light.position.z + light.range < sliceMinZ)
+            {
+                continue;
+            }
+
+            indices.push_back(uint32_t(i));
+            positionX.push_back(light.position.x);
+            positionY.push_back(light.position.y);
+            positionZ.push_back(light.position.z);
+            range.push_back(light.range);
+            directionX.push_back(light.direction.x);
+            directionY.push_back(light.direction.y);
+            directionZ.push_back(light.direction.z);
+            cosOuterAngle.push_back(light.cosOuterAngle);
+            const float cosSquared = light.cosOuterAngle * light.cosOuterAngle;
+            sinOuterAngle.push_back(std::sqrt(std::max(1.f - cosSquared, 0.f)));
+            isSpot.push_back(light.isSpot ? 1.f : 0.f);
+        }
+        const size_t lightCount = indices.size();
+
+        for(size_t tile = 0; tile < tileCount; tile++)
+        {
+            const size_t cluster = firstCluster + tile;
+            const size_t indexCount = out.indices.size();
+            size_t i = 0;
+
+#ifdef LIGHT_CLUSTERING_SSE2
+            // Four lights per iteration against the same cluster
+            const __m128 zero = _mm_setzero_ps();
+            const __m128 minX = _mm_set1_ps(bounds.minX[cluster]);
+            const __m128 minY = _mm_set1_ps(bounds.minY[cluster]);
+            const __m128 minZ = _mm_set1_ps(bounds.minZ[cluster]);
+            const __m128 maxX = _mm_set1_ps(bounds.maxX[cluster]);
+            const __m128 maxY = _mm_set1_ps(bounds.maxY[cluster]);
+            const __m128 maxZ = _mm_set1_ps(bounds.maxZ[cluster]);
+            const __m128 centerX = _mm_set1_ps(bounds.centerX[cluster]);
+            const __m128 centerY = _mm_set1_ps(bounds.centerY[cluster]);
+            const __m128 centerZ = _mm_set1_ps(bounds.centerZ[cluster]);
+            const __m128 sphereRadius = _mm_set1_ps(bounds.radius[cluster]);
+            for(; useSimd && i + 4 <= lightCount; i += 4)
+            {
+                const __m128 px = _mm_loadu_ps(positionX.data() + i);
+                const __m128 py = _mm_loadu_ps(positionY.data() + i);
+                const __m128 pz = _mm_loadu_ps(positionZ.data() + i);
+                const __m128 lightRange = _mm_loadu_ps(range.data() + i);
+
+                const __m128 dx = _mm_max_ps(_mm_max_ps(_mm_sub_ps(minX, px), zero), _mm_sub_ps(px, maxX));
+                const __m128 dy = _mm_max_ps(_mm_max_ps(_mm_sub_ps(minY, py), zero), _mm_sub_ps(py, maxY));
+                const __m128 dz = _mm_max_ps(_mm_max_ps(_mm_sub_ps(minZ, pz), zero), _mm_sub_ps(pz, maxZ));
+                const __m128 boxDistance =
+                        _mm_add_ps(_mm_add_ps(_mm_mul_ps(dx, dx), _mm_mul_ps(dy, dy)), _mm_mul_ps(dz, dz));
+                const __m128 sphereHit = _mm_cmple_ps(boxDistance, _mm_mul_ps(lightRange, lightRange));
+
+                const __m128 vx = _mm_sub_ps(centerX, px);
+                const __m128 vy = _mm_sub_ps(centerY, py);
+                const __m128 vz = _mm_sub_ps(centerZ, pz);
+                const __m128 lengthSquared =
+                        _mm_add_ps(_mm_add_ps(_mm_mul_ps(vx, vx), _mm_mul_ps(vy, vy)), _mm_mul_ps(vz, vz));
+                const __m128 alongAxis = _mm_add_ps(
+                        _mm_add_ps(
+                                _mm_mul_ps(vx, _mm_loadu_ps(directionX.data() + i)),
+                                _mm_mul_ps(vy, _mm_loadu_ps(directionY.data() + i))
+                        ),
+                        _mm_mul_ps(vz, _mm_loadu_ps(directionZ.data() + i))
+                );
+                const __m128 axisSquared = _mm_mul_ps(alongAxis, alongAxis);
+                const __m128 toAxis = _mm_sqrt_ps(_mm_max_ps(_mm_sub_ps(lengthSquared, axisSquared), zero));
+                const __m128 coneDistance = _mm_sub_ps(
+                        _mm_mul_ps(_mm_loadu_ps(cosOuterAngle.data() + i), toAxis),
+                        _mm_mul_ps(alongAxis, _mm_loadu_ps(sinOuterAngle.data() + i))
+                );
+                const __m128 coneCulled = _mm_or_ps(
+                        _mm_or_ps(
+                                _mm_cmpgt_ps(coneDistance, sphereRadius),
+                                _mm_cmpgt_ps(alongAxis, _mm_add_ps(sphereRadius, lightRange))
+                        ),
+                        _mm_cmplt_ps(alongAxis, _mm_sub_ps(zero, sphereRadius))
+                );
+                const __m128 spot = _mm_cmpneq_ps(_mm_loadu_ps(isSpot.data() + i), zero);
+                const __m128 spotCulled = _mm_and_ps(coneCulled, spot);
+
+                const int hits = _mm_movemask_ps(_mm_andnot_ps(spotCulled, sphereHit));
+                for(size_t lane = 0; lane < 4; lane++)
+                {
+                    if(hits & (1 << lane))
+                    {
+                        out.indices.push_back(indices[i + lane]);
+                    }
+                }
+            }
+#endif
+
+            for(; i < lightCount; i++)
+            {
+                // Squared distance from the light to the closest point of the box
+                const float dx = std::max(
+                        std::max(bounds.minX[cluster] - positionX[i], 0.f),
+                        positionX[i] - bounds.maxX[cluster]
+                );
+                const float dy = std::max(
+                        std::max(bounds.minY[cluster] - positionY[i], 0.f),
+                        positionY[i] - bounds.maxY[cluster]
+                );
+                const float dz = std::max(
+                        std::max(bounds.minZ[cluster] - positionZ[i], 0.f),
+                        positionZ[i] - bounds.maxZ[cluster]
+                );
+                if(!(dx * dx + dy * dy + dz * dz <= range[i] * range[i]))
+                {
+                    continue;
+                }
+
+                if(isSpot[i] != 0.f)
+                {
+                    // Distance of the bounding sphere to the cone, see "Cull that cone" by B. Wronski
+                    const float vx = bounds.centerX[cluster] - positionX[i];
+                    const float vy = bounds.centerY[cluster] - positionY[i];
+                    const float vz = bounds.centerZ[cluster] - positionZ[i];
+                    const float lengthSquared = vx * vx + vy * vy + vz * vz;
+                    const float alongAxis = vx * directionX[i] + vy * directionY[i] + vz * directionZ[i];
+                    const float toAxis = std::sqrt(std::max(lengthSquared - alongAxis * alongAxis, 0.f));
+                    const float coneDistance = cosOuterAngle[i] * toAxis - alongAxis * sinOuterAngle[i];
+
+                    const float sphereRadius = bounds.radius[cluster];
+                    if(coneDistance > sphereRadius || alongAxis > sphereRadius + range[i] ||
+                       alongAxis < -sphereRadius)
+                    {
+                        continue;
+                    }
+                }
+
+                out.indices.push_back(indices[i]);
+            }
+
+            out.counts[tile] = uint32_t(out.indices.size() - indexCount);
+        }
+    }
+
+    /**
+     * Concatenates the lights of all slices into one index list.
+     *
+     * @param slices The slices in order, as assigned by assignClusterSlice
+     * @param clusterRanges Receives the offset into lightIndices and the light count of every cluster
+     * @param lightIndices Receives the light indices of all clusters
+     * @param maxIndices Clusters past this many indices lose their remaining lights
+     */
+    static void mergeClusterSlices(
+            const std::vector<LightClusterSlice>& slices,
+            std::vector<uint32_t>& clusterRanges,
+            std::vector<uint32_t>& lightIndices,
+            size_t maxIndices = SIZE_MAX
+    )
+    {
+        clusterRanges.clear();
+        lightIndices.clear();
+        for(const LightClusterSlice& slice : slices)
+        {
+            size_t offset = 0;
+            for(const uint32_t count : slice.counts)
+            {
+                const size_t space = maxIndices - std::min(lightIndices.size(), maxIndices);
+                const size_t kept = std::min(size_t(count), space);
+                clusterRanges.push_back(uint32_t(lightIndices.size()));
+                clusterRanges.push_back(uint32_t(kept));
+                lightIndices.insert(
+                        lightIndices.end(),
+                        slice.indices.begin() + std::ptrdiff_t(offset),
+                        slice.indices.begin() + std::ptrdiff_t(offset + kept)
+                );
+                offset += count;
+            }
+        }
+    }
+} // namespace Engine
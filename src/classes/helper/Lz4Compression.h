@@ -0,0 +1,184 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+namespace Engine
+{
+    inline constexpr int LZ4_HASH_BITS = 12;
+    inline constexpr size_t LZ4_MIN_MATCH = 4;
+    inline constexpr size_t LZ4_MAX_OFFSET = 65535;
+    // The block format ends with literals: the last match starts 12 bytes and ends 5 bytes before the end
+    inline constexpr size_t LZ4_MATCH_START_LIMIT = 12;
+    inline constexpr size_t LZ4_LAST_LITERALS = 5;
+
+    static inline void writeLz4Length(std::vector<uint8_t>& compressed, size_t length)
+    {
+        while(length >= 255)
+        {
+            compressed.push_back(255);
+            length -= 255;
+        }
+        compressed.push_back(uint8_t(length));
+    }
+
+    static inline bool readLz4Length(const uint8_t*& pos, const uint8_t* end, size_t& length)
+    {
+        uint8_t value;
+        do
+        {
+            if(pos == end)
+            {
+                return false;
+            }
+            value = *pos++;
+            length += value;
+        } while(value == 255);
+
+        return true;
+    }
+
+    /**
+     * Compresses data into a single LZ4 block, readable by any LZ4 block decoder.
+     * Greedy matching against the last position of every 4 byte hash, fast but not the smallest output.
+     *
+     * @param data The data to compress.
+     * @param size The size of the data in bytes.
+     * @param compressed Receives the compressed block.
+     */
+    static void compressLz4(const uint8_t* data, size_t size, std::vector<uint8_t>& compressed)
+    {
+        compressed.clear();
+        compressed.reserve(size + size / 255 + 16);
+
+        std::vector<uint32_t> table(size_t(1) << LZ4_HASH_BITS, 0);
+        const size_t matchStartLimit = size > LZ4_MATCH_START_LIMIT ? size - LZ4_MATCH_START_LIMIT : 0;
+        size_t anchor = 0;
+        size_t pos = 0;
+        while(pos < matchStartLimit)
+        {
+            uint32_t sequence;
+            memcpy(&sequence, data + pos, sizeof(sequence));
+            const uint32_t hash = (sequence * 2654435761u) >> (32 - LZ4_HASH_BITS);
+            const size_t candidate = table[hash];
+            table[hash] = uint32_t(pos);
+
+            if(candidate >= pos || pos - candidate > LZ4_MAX_OFFSET ||
+               memcmp(data + candidate, data + pos, LZ4_MIN_MATCH) != 0)
+            {
+                pos++;
+                continue;
+            }
+
+            size_t length = LZ4_MIN_MATCH;
+            const size_t lengthLimit = size - LZ4_LAST_LITERALS - pos;
+            while(length < lengthLimit && data[candidate + length] == data[pos + length])
+            {
+                length++;
+            }
+
+            const size_t literalLength = pos - anchor;
+            const size_t matchLength = length - LZ4_MIN_MATCH;
+            compressed.push_back(
+                    uint8_t((std::min<size_t>(literalLength, 15) << 4) | std::min<size_t>(matchLength, 15))
+            );
+            if(literalLength >= 15)
+            {
+                writeLz4Length(compressed, literalLength - 15);
+            }
+            compressed.insert(compressed.end(), data + anchor, data + pos);
+
+            const size_t offset = pos - candidate;
+            compressed.push_back(uint8_t(offset));
+            compressed.push_back(uint8_t(offset >> 8));
+            if(matchLength >= 15)
+            {
+                writeLz4Length(compressed, matchLength - 15);
+            }
+
+            pos += length;
+            anchor = pos;
+        }
+
+        const size_t literalLength = size - anchor;
+        compressed.push_back(uint8_t(std::min<size_t>(literalLength, 15) << 4));
+        if(literalLength >= 15)
+        {
+            writeLz4Length(compressed, literalLength - 15);
+        }
+        compressed.insert(compressed.end(), data + anchor, data + size);
+    }
+
+    /**
+     * Decompresses a single LZ4 block, every length and offset is checked against the buffers.
+     *
+     * @param compressed The compressed block.
+     * @param compressedSize The size of the block in bytes.
+     * @param data Receives the decompressed data.
+     * @param size The size of the decompressed data in bytes.
+     * @return False if the block is corrupt or doesn't decompress to exactly size bytes.
+     */
+    static bool decompressLz4(const uint8_t* compressed, size_t compressedSize, uint8_t* data, size_t size)
+    {
+        const uint8_t* pos = compressed;
+        const uint8_t* end = compressed + compressedSize;
+        size_t written = 0;
+        while(pos < end)
+        {
+            const uint8_t token = *pos++;
+            size_t literalLength = token >> 4;
+            if(literalLength == 15 && !readLz4Length(pos, end, literalLength))
+            {
+                return false;
+            }
+            if(size_t(end - pos) < literalLength || size - written < literalLength)
+            {
+                return false;
+            }
+
+            memcpy(data + written, pos, literalLength);
+            pos += literalLength;
+            written += literalLength;
+
+            // The last sequence has no match
+            if(pos == end)
+            {
+                break;
+            }
+
+            if(end - pos < 2)
+            {
+                return false;
+            }
+            const size_t offset = size_t(pos[0]) | (size_t(pos[1]) << 8);
+            pos += 2;
+            if(offset == 0 || offset > written)
+            {
+                return false;
+            }
+
+            size_t matchLength = token & 15;
+            if(matchLength == 15 && !readLz4Length(pos, end, matchLength))
+            {
+                return false;
+            }
+            matchLength += LZ4_MIN_MATCH;
+            if(size - written < matchLength)
+            {
+                return false;
+            }
+
+            // Matches may overlap the bytes they produce, so they're copied one by one
+            for(size_t i = 0; i < matchLength; i++)
+            {
+                data[written + i] = data[written - offset + i];
+            }
+            written += matchLength;
+        }
+
+        return written == size;
+    }
+} // namespace Engine
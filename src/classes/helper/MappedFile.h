@@ -0,0 +1,122 @@
+#pragma once
+
+#include <cstddef>
+#include <ctime>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace Engine
+{
+    /**
+     * @brief Read only memory mapping of a whole file, unmapped once the object goes out of scope.
+     */
+    class MappedFile
+    {
+        public:
+            MappedFile() = default;
+
+            explicit MappedFile(const char* filePath) { open(filePath); }
+
+            ~MappedFile() { close(); }
+
+            MappedFile(const MappedFile&) = delete;
+            MappedFile& operator=(const MappedFile&) = delete;
+
+            MappedFile(MappedFile&& other) noexcept { *this = std::move(other); }
+
+            MappedFile& operator=(MappedFile&& other) noexcept
+            {
+                if(this != &other)
+                {
+                    close();
+                    m_data = std::exchange(other.m_data, nullptr);
+                    m_size = std::exchange(other.m_size, 0);
+                    m_modificationTime = std::exchange(other.m_modificationTime, 0);
+                    m_isOpen = std::exchange(other.m_isOpen, false);
+                }
+                return *this;
+            }
+
+            /**
+             * @brief Maps the file into memory, replacing any previously mapped file.
+             * @param filePath The path of the file to map.
+             * @return True if the file could be mapped, false otherwise.
+             */
+            bool open(const char* filePath)
+            {
+                close();
+
+                const int fileDescriptor = ::open(filePath, O_RDONLY);
+                if(fileDescriptor < 0)
+                {
+                    return false;
+                }
+
+                struct stat fileStat {};
+                if(fstat(fileDescriptor, &fileStat) != 0)
+                {
+                    ::close(fileDescriptor);
+                    return false;
+                }
+
+                m_size = size_t(fileStat.st_size);
+                m_modificationTime = fileStat.st_mtime;
+
+                // Empty files can't be mapped, but are still valid files
+                if(m_size > 0)
+                {
+                    void* mapping = mmap(nullptr, m_size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0);
+                    if(mapping == MAP_FAILED)
+                    {
+                        ::close(fileDescriptor);
+                        m_size = 0;
+                        return false;
+                    }
+
+                    madvise(mapping, m_size, MADV_SEQUENTIAL);
+                    m_data = static_cast<const char*>(mapping);
+                }
+
+                // The mapping stays valid after the descriptor is closed
+                ::close(fileDescriptor);
+                m_isOpen = true;
+                return true;
+            }
+
+            /**
+             * @brief Unmaps the file.
+             */
+            void close()
+            {
+                if(m_data)
+                {
+                    munmap(const_cast<char*>(m_data), m_size);
+                }
+
+                m_data = nullptr;
+                m_size = 0;
+                m_modificationTime = 0;
+                m_isOpen = false;
+            }
+
+            bool isOpen() const { return m_isOpen; };
+
+            const char* data() const { return m_data; };
+
+            const char* end() const { return m_data + m_size; };
+
+            size_t size() const { return m_size; };
+
+            time_t getModificationTime() const { return m_modificationTime; };
+
+        private:
+            const char* m_data = nullptr;
+            size_t m_size = 0;
+            time_t m_modificationTime = 0;
+            bool m_isOpen = false;
+    };
+} // namespace Engine
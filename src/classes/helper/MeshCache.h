@@ -0,0 +1,250 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "AssetFile.h"
+#include "HashUtils.h"
+#include "MappedFile.h"
+#include "TriDataDef.h"
+#include "VertexEncodingHelper.h"
+
+#define MESH_CACHE_MAGIC 0x4853454D // Equivalent to "MESH" in ASCII
+#define MESH_CACHE_VERSION 4
+#define MESH_CACHE_DIRECTORY "cache/meshes/"
+#define MESH_CACHE_ALIGNMENT 16
+
+namespace Engine
+{
+    inline constexpr uint32_t MESH_CACHE_FLAG_UVS = 1 << 0;
+    inline constexpr uint32_t MESH_CACHE_FLAG_NORMALS = 1 << 1;
+
+    /**
+     * Layout of a binary mesh cache file:
+     * the header, the interleaved vertex stream encoded as vertexFormat and the triangle index stream.
+     * Both streams start on a MESH_CACHE_ALIGNMENT boundary so they can be used straight from the mapping.
+     */
+    struct MeshCacheHeader
+    {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t flags;
+            uint32_t vertexFormat;
+            uint32_t vertexStride;
+            uint32_t indexWidth;
+            uint64_t vertexCount;
+            uint64_t vertexOffset;
+            uint64_t triangleCount;
+            uint64_t indexOffset;
+            uint64_t sourceSize;
+            int64_t sourceModificationTime;
+            uint64_t sourceHash;
+            // Hash of both streams, opening the cache doesn't verify it as that would read the whole file
+            uint64_t contentHash;
+            float boundsMin[3];
+            float boundsMax[3];
+    };
+
+    static_assert(sizeof(MeshCacheHeader) == 112, "MeshCacheHeader must not contain padding");
+
+    static inline uint64_t alignMeshCacheOffset(uint64_t offset)
+    {
+        return (offset + MESH_CACHE_ALIGNMENT - 1) & ~uint64_t(MESH_CACHE_ALIGNMENT - 1);
+    }
+
+    /**
+     * @param sourcePath The path of the mesh file the cache belongs to.
+     * @return The path of the cache file, named after the hash of the source path.
+     */
+    static std::string getMeshCachePath(const char* sourcePath)
+    {
+        char fileName[32];
+        snprintf(fileName, sizeof(fileName), "%016llx.mesh", (unsigned long long)hashString(sourcePath));
+        return std::string(MESH_CACHE_DIRECTORY) + fileName;
+    }
+
+    /**
+     * Writes the imported, indexed mesh into the binary cache so later runs can skip the import.
+     * The file is written to a temporary path first and moved into place once complete.
+     *
+     * @param sourcePath The path of the mesh file the data was imported from.
+     * @param vertexData The interleaved vertex stream, encoded as vertexFormat.
+     * @param vertexFormat The format of the vertex stream.
+     * @param boundsMin The minimum corner of the meshes bounds.
+     * @param boundsMax The maximum corner of the meshes bounds.
+     * @param indexData The triangles of the mesh, packed to indexWidth.
+     * @param indexWidth The width of one index in bytes, either 2 or 4.
+     * @param flags MESH_CACHE_FLAG_* bits describing which vertex attributes the source contained.
+     * @return True if the cache was written, false otherwise.
+     */
+    static bool writeMeshCache(
+            const char* sourcePath,
+            const std::vector<uint8_t>& vertexData,
+            VertexFormat vertexFormat,
+            const glm::vec3& boundsMin,
+            const glm::vec3& boundsMax,
+            const std::vector<uint8_t>& indexData,
+            unsigned int indexWidth,
+            uint32_t flags
+    )
+    {
+        AssetFile source(sourcePath);
+        if(!source.isOpen())
+        {
+            return false;
+        }
+
+        MeshCacheHeader header {};
+        header.magic = MESH_CACHE_MAGIC;
+        header.version = MESH_CACHE_VERSION;
+        header.flags = flags;
+        header.vertexFormat = uint32_t(vertexFormat);
+        header.vertexStride = uint32_t(getVertexStride(vertexFormat));
+        header.vertexCount = vertexData.size() / header.vertexStride;
+        header.vertexOffset = alignMeshCacheOffset(sizeof(MeshCacheHeader));
+        header.triangleCount = indexData.size() / (3 * indexWidth);
+        const size_t vertexBytes = vertexData.size();
+        header.indexOffset = alignMeshCacheOffset(header.vertexOffset + vertexBytes);
+        header.indexWidth = indexWidth;
+        header.sourceSize = source.size();
+        header.sourceModificationTime = int64_t(source.getModificationTime());
+        header.sourceHash = hashBytes(source.data(), source.size());
+        header.contentHash = hashVector(indexData, hashVector(vertexData));
+        for(int i = 0; i < 3; i++)
+        {
+            header.boundsMin[i] = boundsMin[i];
+            header.boundsMax[i] = boundsMax[i];
+        }
+
+        std::error_code error;
+        std::filesystem::create_directories(MESH_CACHE_DIRECTORY, error);
+
+        const std::string cachePath = getMeshCachePath(sourcePath);
+        const std::string tempPath = cachePath + ".tmp";
+        FILE* file = fopen(tempPath.c_str(), "wb");
+        if(file == nullptr)
+        {
+            return false;
+        }
+
+        const char padding[MESH_CACHE_ALIGNMENT] = {};
+        const size_t headerPadding = header.vertexOffset - sizeof(MeshCacheHeader);
+        const size_t vertexPadding = header.indexOffset - header.vertexOffset - vertexBytes;
+
+        bool success = fwrite(&header, sizeof(header), 1, file) == 1;
+        success = success && fwrite(padding, 1, headerPadding, file) == headerPadding;
+        success = success && fwrite(vertexData.data(), 1, vertexBytes, file) == vertexBytes;
+        success = success && fwrite(padding, 1, vertexPadding, file) == vertexPadding;
+        success = success && fwrite(indexData.data(), 1, indexData.size(), file) == indexData.size();
+        success = fclose(file) == 0 && success;
+
+        if(!success || std::rename(tempPath.c_str(), cachePath.c_str()) != 0)
+        {
+            std::remove(tempPath.c_str());
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * @brief Memory mapped binary mesh cache, validated against the mesh file it was created from.
+     */
+    class MeshCacheFile
+    {
+        public:
+            /**
+             * Maps the cache file of a mesh and checks that its layout is intact and it's still up to date.
+             * The source is looked up like the loader does, in the mounted asset packs first,
+             * see isAssetUnchanged. A cache without its source file is used as is.
+             * The streams themselves aren't read, so opening doesn't touch more than the header's page.
+             *
+             * @param sourcePath The path of the mesh file.
+             * @return True if the cache can be used, false if the mesh has to be imported again.
+             */
+            bool open(const char* sourcePath)
+            {
+                if(!m_file.open(getMeshCachePath(sourcePath).c_str()) || !validateLayout())
+                {
+                    m_file.close();
+                    return false;
+                }
+
+                const uint64_t sourceSize = m_header.sourceSize;
+                const int64_t sourceModificationTime = m_header.sourceModificationTime;
+                if(!isAssetUnchanged(sourcePath, sourceSize, sourceModificationTime, m_header.sourceHash))
+                {
+                    m_file.close();
+                    return false;
+                }
+
+                return true;
+            }
+
+            const MeshCacheHeader& getHeader() const { return m_header; };
+
+            const void* getVertexData() const { return m_file.data() + m_header.vertexOffset; };
+
+            size_t getVertexDataSize() const { return getVertexCount() * m_header.vertexStride; };
+
+            size_t getVertexCount() const { return size_t(m_header.vertexCount); };
+
+            VertexFormat getVertexFormat() const { return VertexFormat(m_header.vertexFormat); };
+
+            glm::vec3 getBoundsMin() const
+            {
+                return glm::vec3(m_header.boundsMin[0], m_header.boundsMin[1], m_header.boundsMin[2]);
+            };
+
+            glm::vec3 getBoundsMax() const
+            {
+                return glm::vec3(m_header.boundsMax[0], m_header.boundsMax[1], m_header.boundsMax[2]);
+            };
+
+            const void* getIndexData() const { return m_file.data() + m_header.indexOffset; };
+
+            size_t getIndexDataSize() const { return getTriangleCount() * 3 * getIndexWidth(); };
+
+            unsigned int getIndexWidth() const { return m_header.indexWidth; };
+
+            size_t getTriangleCount() const { return size_t(m_header.triangleCount); };
+
+            bool hasUvs() const { return m_header.flags & MESH_CACHE_FLAG_UVS; };
+
+            bool hasNormals() const { return m_header.flags & MESH_CACHE_FLAG_NORMALS; };
+
+        private:
+            bool validateLayout()
+            {
+                if(m_file.size() < sizeof(MeshCacheHeader))
+                {
+                    return false;
+                }
+
+                memcpy(&m_header, m_file.data(), sizeof(MeshCacheHeader));
+                if(m_header.magic != MESH_CACHE_MAGIC || m_header.version != MESH_CACHE_VERSION ||
+                   m_header.vertexFormat > uint32_t(VertexFormat::SNORM16_POSITIONS) ||
+                   m_header.vertexStride != getVertexStride(VertexFormat(m_header.vertexFormat)) ||
+                   (m_header.indexWidth != 2 && m_header.indexWidth != 4))
+                {
+                    return false;
+                }
+
+                const uint64_t vertexOffset = m_header.vertexOffset;
+                const uint64_t indexOffset = m_header.indexOffset;
+                const uint64_t vertexEnd = vertexOffset + m_header.vertexCount * m_header.vertexStride;
+                const uint64_t indexEnd = indexOffset + m_header.triangleCount * 3 * m_header.indexWidth;
+                return vertexOffset % MESH_CACHE_ALIGNMENT == 0 && indexOffset % MESH_CACHE_ALIGNMENT == 0 &&
+                        vertexOffset >= sizeof(MeshCacheHeader) && vertexEnd <= indexOffset &&
+                        indexEnd <= m_file.size();
+            }
+
+            MappedFile m_file;
+            MeshCacheHeader m_header {};
+    };
+} // namespace Engine
@@ -0,0 +1,372 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <iostream>
+#include <numeric>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "TriDataDef.h"
+
+#define MESH_OPTIMIZER_CACHE_SIZE 16
+
+namespace Engine
+{
+    /**
+     * Simulates a FIFO post-transform vertex cache over the triangles in draw order.
+     *
+     * @param indices The triangles of the mesh.
+     * @param vertexCount The amount of vertices the triangles index.
+     * @param cacheSize The amount of vertices the simulated cache holds.
+     * @return The average cache miss ratio, transformed vertices per triangle. 3 is the worst case,
+     * around 0.5 to 0.7 is typical for well ordered meshes.
+     */
+    static float computeAcmr(
+            const std::vector<triData>& indices,
+            size_t vertexCount,
+            unsigned int cacheSize = MESH_OPTIMIZER_CACHE_SIZE
+    )
+    {
+        if(indices.empty())
+        {
+            return 0.f;
+        }
+
+        // A vertex is cached if it entered the FIFO less than cacheSize misses ago, 0 means never
+        std::vector<size_t> cacheEntry(vertexCount, 0);
+        size_t misses = 0;
+        for(const auto& tri : indices)
+        {
+            for(const unsigned int vertex : tri)
+            {
+                if(cacheEntry[vertex] == 0 || misses - cacheEntry[vertex] >= cacheSize)
+                {
+                    misses++;
+                    cacheEntry[vertex] = misses;
+                }
+            }
+        }
+
+        return float(misses) / float(indices.size());
+    }
+
+    /**
+     * Reorders the triangles for post-transform vertex cache locality using Tipsify
+     * (Sander, Nehab and Barczak, "Fast Triangle Reordering for Vertex Locality and Reduced Overdraw").
+     * Triangles are emitted as fans around one vertex, the next fan vertex is picked among the vertices
+     * of the last fans that are still in the cache.
+     *
+     * @param indices The triangles of the mesh, reordered in place.
+     * @param vertexCount The amount of vertices the triangles index.
+     * @param clusters Receives the index of the first triangle of every cluster. A new cluster starts
+     * wherever the fanning had to jump to a vertex outside the cache.
+     * @param cacheSize The amount of vertices of the targeted cache.
+     */
+    static void optimizeVertexCache(
+            std::vector<triData>& indices,
+            size_t vertexCount,
+            std::vector<size_t>& clusters,
+            unsigned int cacheSize = MESH_OPTIMIZER_CACHE_SIZE
+    )
+    {
+        clusters.clear();
+        if(indices.empty())
+        {
+            return;
+        }
+
+        // Triangles adjacent to every vertex, stored back to back
+        std::vector<unsigned int> liveTriangles(vertexCount, 0);
+        for(const auto& tri : indices)
+        {
+            liveTriangles[tri[0]]++;
+            liveTriangles[tri[1]]++;
+            liveTriangles[tri[2]]++;
+        }
+
+        std::vector<size_t> adjacencyOffset(vertexCount + 1, 0);
+        for(size_t vertex = 0; vertex < vertexCount; vertex++)
+        {
+            adjacencyOffset[vertex + 1] = adjacencyOffset[vertex] + liveTriangles[vertex];
+        }
+
+        std::vector<unsigned int> adjacency(adjacencyOffset[vertexCount]);
+        std::vector<size_t> adjacencyFill(adjacencyOffset.begin(), adjacencyOffset.end() - 1);
+        for(size_t triangle = 0; triangle < indices.size(); triangle++)
+        {
+            for(const unsigned int vertex : indices[triangle])
+            {
+                adjacency[adjacencyFill[vertex]++] = unsigned(triangle);
+            }
+        }
+
+        std::vector<size_t> cacheTime(vertexCount, 0);
+        std::vector<bool> emitted(indices.size(), false);
+        std::vector<unsigned int> deadEnds;
+        std::vector<unsigned int> candidates;
+        std::vector<triData> output;
+        output.reserve(indices.size());
+
+        size_t timeStamp = cacheSize + 1;
+        size_t cursor = 0;
+        long fanVertex = 0;
+        clusters.push_back(0);
+
+        while(fanVertex >= 0)
+        {
+            candidates.clear();
+            for(size_t i = adjacencyOffset[fanVertex]; i < adjacencyOffset[fanVertex + 1]; i++)
+            {
+                const unsigned int triangle = adjacency[i];
+                if(emitted[triangle])
+                {
+                    continue;
+                }
+
+                for(const unsigned int vertex : indices[triangle])
+                {
+                    deadEnds.push_back(vertex);
+                    candidates.push_back(vertex);
+                    liveTriangles[vertex]--;
+                    if(timeStamp - cacheTime[vertex] > cacheSize)
+                    {
+                        cacheTime[vertex] = timeStamp++;
+                    }
+                }
+
+                emitted[triangle] = true;
+                output.push_back(indices[triangle]);
+            }
+
+            // Prefer the candidate that stays in the cache the longest while still having triangles left
+            long nextVertex = -1;
+            size_t bestPriority = 0;
+            for(const unsigned int vertex : candidates)
+            {
+                if(liveTriangles[vertex] == 0)
+                {
+                    continue;
+                }
+
+                size_t priority = 0;
+                const size_t age = timeStamp - cacheTime[vertex];
+                if(age + 2 * liveTriangles[vertex] <= cacheSize)
+                {
+                    priority = age;
+                }
+
+                if(nextVertex < 0 || priority > bestPriority)
+                {
+                    nextVertex = vertex;
+                    bestPriority = priority;
+                }
+            }
+
+            if(nextVertex >= 0)
+            {
+                fanVertex = nextVertex;
+                continue;
+            }
+
+            // Dead end, continue with a recently used vertex or the next vertex in input order
+            while(!deadEnds.empty() && nextVertex < 0)
+            {
+                const unsigned int vertex = deadEnds.back();
+                deadEnds.pop_back();
+                if(liveTriangles[vertex] > 0)
+                {
+                    nextVertex = vertex;
+                }
+            }
+
+            while(cursor < vertexCount && nextVertex < 0)
+            {
+                if(liveTriangles[cursor] > 0)
+                {
+                    nextVertex = long(cursor);
+                }
+                cursor++;
+            }
+
+            if(nextVertex >= 0 && clusters.back() != output.size())
+            {
+                clusters.push_back(output.size());
+            }
+            fanVertex = nextVertex;
+        }
+
+        indices.swap(output);
+    }
+
+    /**
+     * Reorders clusters of triangles so that the ones facing away from the center of the mesh are drawn
+     * first. Those are the most likely to occlude the rest of the mesh, which reduces overdraw.
+     * The triangle order inside every cluster is kept, so the vertex cache locality is preserved.
+     *
+     * @param indices The triangles of the mesh, reordered in place.
+     * @param vertices The vertex positions of the mesh.
+     * @param clusters The index of the first triangle of every cluster, as returned by optimizeVertexCache.
+     */
+    static void optimizeOverdraw(
+            std::vector<triData>& indices,
+            const std::vector<glm::vec3>& vertices,
+            const std::vector<size_t>& clusters
+    )
+    {
+        if(clusters.size() < 2)
+        {
+            return;
+        }
+
+        std::vector<glm::vec3> clusterCentroid(clusters.size(), glm::vec3(0.f));
+        std::vector<glm::vec3> clusterNormal(clusters.size(), glm::vec3(0.f));
+        glm::vec3 meshCentroid(0.f);
+        float meshArea = 0.f;
+
+        for(size_t cluster = 0; cluster < clusters.size(); cluster++)
+        {
+            const size_t end = cluster + 1 < clusters.size() ? clusters[cluster + 1] : indices.size();
+            float clusterArea = 0.f;
+            for(size_t triangle = clusters[cluster]; triangle < end; triangle++)
+            {
+                const auto& tri = indices[triangle];
+                const glm::vec3 normal =
+                        glm::cross(vertices[tri[1]] - vertices[tri[0]], vertices[tri[2]] - vertices[tri[0]]);
+                const float area = glm::length(normal);
+                const glm::vec3 centroid = (vertices[tri[0]] + vertices[tri[1]] + vertices[tri[2]]) / 3.f;
+
+                clusterCentroid[cluster] += centroid * area;
+                clusterNormal[cluster] += normal;
+                clusterArea += area;
+            }
+
+            meshCentroid += clusterCentroid[cluster];
+            meshArea += clusterArea;
+            clusterCentroid[cluster] /= clusterArea > 0.f ? clusterArea : 1.f;
+        }
+        meshCentroid /= meshArea > 0.f ? meshArea : 1.f;
+
+        std::vector<float> clusterSortKey(clusters.size());
+        for(size_t cluster = 0; cluster < clusters.size(); cluster++)
+        {
+            const float normalLength = glm::length(clusterNormal[cluster]);
+            const glm::vec3 direction =
+                    normalLength > 0.f ? clusterNormal[cluster] / normalLength : glm::vec3(0.f);
+            clusterSortKey[cluster] = glm::dot(clusterCentroid[cluster] - meshCentroid, direction);
+        }
+
+        std::vector<size_t> order(clusters.size());
+        std::iota(order.begin(), order.end(), 0);
+        std::stable_sort(
+                order.begin(),
+                order.end(),
+                [&clusterSortKey](size_t a, size_t b) { return clusterSortKey[a] > clusterSortKey[b]; }
+        );
+
+        std::vector<triData> output;
+        output.reserve(indices.size());
+        for(const size_t cluster : order)
+        {
+            const size_t end = cluster + 1 < clusters.size() ? clusters[cluster + 1] : indices.size();
+            const auto clusterBegin = indices.begin() + long(clusters[cluster]);
+            output.insert(output.end(), clusterBegin, indices.begin() + long(end));
+        }
+
+        indices.swap(output);
+    }
+
+    /**
+     * Renumbers the vertices in the order the triangles first use them, so vertex fetches walk through
+     * the vertex buffer linearly. Vertices no triangle uses are dropped.
+     *
+     * @param vertices The vertex positions, reordered in place.
+     * @param uvs The texture coordinates, reordered in place if not empty.
+     * @param normals The normals, reordered in place if not empty.
+     * @param indices The triangles, renumbered in place.
+     */
+    static void optimizeVertexFetch(
+            std::vector<glm::vec3>& vertices,
+            std::vector<glm::vec2>& uvs,
+            std::vector<glm::vec3>& normals,
+            std::vector<triData>& indices
+    )
+    {
+        constexpr unsigned int UNUSED_VERTEX = UINT32_MAX;
+        std::vector<unsigned int> remap(vertices.size(), UNUSED_VERTEX);
+        std::vector<unsigned int> sourceVertex;
+        sourceVertex.reserve(vertices.size());
+
+        for(auto& tri : indices)
+        {
+            for(auto& vertex : tri)
+            {
+                if(remap[vertex] == UNUSED_VERTEX)
+                {
+                    remap[vertex] = unsigned(sourceVertex.size());
+                    sourceVertex.push_back(vertex);
+                }
+                vertex = remap[vertex];
+            }
+        }
+
+        auto reorder = [&sourceVertex](auto& attribute)
+        {
+            if(attribute.empty())
+            {
+                return;
+            }
+
+            std::remove_reference_t<decltype(attribute)> reordered(sourceVertex.size());
+            for(size_t i = 0; i < sourceVertex.size(); i++)
+            {
+                reordered[i] = attribute[sourceVertex[i]];
+            }
+            attribute.swap(reordered);
+        };
+
+        reorder(vertices);
+        reorder(uvs);
+        reorder(normals);
+    }
+
+    /**
+     * Runs all import time optimizations on an indexed mesh and reports the cache efficiency gained.
+     *
+     * @param filePath The path of the mesh, only used for the report.
+     * @param vertices The vertex positions.
+     * @param uvs The texture coordinates, may be empty.
+     * @param normals The normals, may be empty.
+     * @param indices The triangles of the mesh.
+     * @param reduceOverdraw Whether to reorder triangle clusters to reduce overdraw.
+     */
+    static void optimizeMesh(
+            const char* filePath,
+            std::vector<glm::vec3>& vertices,
+            std::vector<glm::vec2>& uvs,
+            std::vector<glm::vec3>& normals,
+            std::vector<triData>& indices,
+            bool reduceOverdraw = true
+    )
+    {
+        if(indices.empty())
+        {
+            return;
+        }
+
+        const float acmrBefore = computeAcmr(indices, vertices.size());
+
+        std::vector<size_t> clusters;
+        optimizeVertexCache(indices, vertices.size(), clusters);
+        if(reduceOverdraw)
+        {
+            optimizeOverdraw(indices, vertices, clusters);
+        }
+        optimizeVertexFetch(vertices, uvs, normals, indices);
+
+        const float acmrAfter = computeAcmr(indices, vertices.size());
+        std::cout << "Optimized mesh [" << filePath << "] ACMR " << acmrBefore << " -> " << acmrAfter
+                  << std::endl;
+    }
+} // namespace Engine
@@ -0,0 +1,129 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <vector>
+
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#define MIPMAP_GENERATOR_SSE2 1
+#endif
+
+#include "ImageData.h"
+
+namespace Engine
+{
+    /**
+     * Halves an RGBA8 image with a 2x2 box filter,
+     * every output texel is the rounded average of four input texels.
+     * Odd sizes are rounded down like glGenerateMipmap does, a dimension of 1 stays 1.
+     *
+     * @param source The texels of the source image, rows packed tightly.
+     * @param sourceWidth The width of the source image.
+     * @param sourceHeight The height of the source image.
+     * @param destination Receives max(sourceWidth / 2, 1) * max(sourceHeight / 2, 1) texels.
+     * @param useSimd Whether to use SSE2 where available, the result is identical either way.
+     */
+    static void downsampleBoxRGBA8(
+            const uint8_t* source,
+            int sourceWidth,
+            int sourceHeight,
+            uint8_t* destination,
+            bool useSimd = true
+    )
+    {
+        const int width = std::max(sourceWidth / 2, 1);
+        const int height = std::max(sourceHeight / 2, 1);
+        const size_t sourceStride = size_t(sourceWidth) * 4;
+
+        for(int y = 0; y < height; y++)
+        {
+            const uint8_t* row0 = source + size_t(2 * y) * sourceStride;
+            const uint8_t* row1 = source + size_t(std::min(2 * y + 1, sourceHeight - 1)) * sourceStride;
+            uint8_t* output = destination + size_t(y) * size_t(width) * 4;
+
+            int x = 0;
+#ifdef MIPMAP_GENERATOR_SSE2
+            // Two output texels per iteration, from four texels of both source rows
+            const __m128i zero = _mm_setzero_si128();
+            const __m128i rounding = _mm_set1_epi16(2);
+            for(; useSimd && sourceWidth >= 2 && x + 2 <= width; x += 2)
+            {
+                const auto* topTexels = reinterpret_cast<const __m128i*>(row0 + size_t(x) * 8);
+                const auto* bottomTexels = reinterpret_cast<const __m128i*>(row1 + size_t(x) * 8);
+                const __m128i top = _mm_loadu_si128(topTexels);
+                const __m128i bottom = _mm_loadu_si128(bottomTexels);
+
+                const __m128i columnsLow =
+                        _mm_add_epi16(_mm_unpacklo_epi8(top, zero), _mm_unpacklo_epi8(bottom, zero));
+                const __m128i columnsHigh =
+                        _mm_add_epi16(_mm_unpackhi_epi8(top, zero), _mm_unpackhi_epi8(bottom, zero));
+
+                const __m128i sumLow = _mm_add_epi16(columnsLow, _mm_srli_si128(columnsLow, 8));
+                const __m128i sumHigh = _mm_add_epi16(columnsHigh, _mm_srli_si128(columnsHigh, 8));
+
+                __m128i average = _mm_unpacklo_epi64(sumLow, sumHigh);
+                average = _mm_srli_epi16(_mm_add_epi16(average, rounding), 2);
+                auto* outputTexels = reinterpret_cast<__m128i*>(output + size_t(x) * 4);
+                _mm_storel_epi64(outputTexels, _mm_packus_epi16(average, zero));
+            }
+#endif
+
+            for(; x < width; x++)
+            {
+                const size_t x0 = size_t(2 * x) * 4;
+                const size_t x1 = size_t(std::min(2 * x + 1, sourceWidth - 1)) * 4;
+                for(size_t channel = 0; channel < 4; channel++)
+                {
+                    const unsigned int sum = row0[x0 + channel] + row0[x1 + channel] + row1[x0 + channel] +
+                            row1[x1 + channel];
+                    output[size_t(x) * 4 + channel] = uint8_t((sum + 2) / 4);
+                }
+            }
+        }
+    }
+
+    /**
+     * Appends the full mip chain down to 1x1 to an uncompressed RGBA8 image holding only its base level.
+     * The levels are computed on the CPU, so they look the same on every driver.
+     *
+     * @param image The image, levels and pixels are extended in place.
+     */
+    static void generateMipChain(ImageData& image)
+    {
+        if(image.isCompressed || image.levels.size() != 1 || image.format != GL_RGBA ||
+           image.type != GL_UNSIGNED_BYTE || image.file)
+        {
+            return;
+        }
+
+        // Size the pixel storage for every level up front, the source level must not move while downsampling
+        std::vector<ImageLevel> levels = image.levels;
+        size_t totalSize = levels[0].offset + levels[0].size;
+        while(levels.back().width > 1 || levels.back().height > 1)
+        {
+            const ImageLevel& previous = levels.back();
+            const GLsizei width = std::max(previous.width / 2, 1);
+            const GLsizei height = std::max(previous.height / 2, 1);
+            const GLint level = previous.level + 1;
+            const size_t size = size_t(width) * size_t(height) * 4;
+            levels.push_back({ totalSize, size, width, height, level });
+            totalSize += size;
+        }
+
+        image.pixels.resize(totalSize);
+        for(size_t level = 1; level < levels.size(); level++)
+        {
+            const ImageLevel& source = levels[level - 1];
+            downsampleBoxRGBA8(
+                    image.pixels.data() + source.offset,
+                    source.width,
+                    source.height,
+                    image.pixels.data() + levels[level].offset
+            );
+        }
+
+        image.levels.swap(levels);
+        image.generateMipmaps = false;
+    }
+} // namespace Engine
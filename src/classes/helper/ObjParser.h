@@ -0,0 +1,449 @@
+#pragma once
+
+#include <algorithm>
+#include <charconv>
+#include <climits>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iostream>
+#include <thread>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+namespace Engine
+{
+    inline constexpr uint8_t OBJ_RELATIVE_POSITION = 1;
+    inline constexpr uint8_t OBJ_RELATIVE_UV = 2;
+    inline constexpr uint8_t OBJ_RELATIVE_NORMAL = 4;
+
+    // Files smaller than this per available thread are parsed on the calling thread only
+    inline constexpr size_t OBJ_MIN_CHUNK_SIZE = 4 * 1024 * 1024;
+
+    /**
+     * Calls the task with every index from 0 to count - 1, possibly concurrently and in any order,
+     * and returns once all of them finished. JobSystem::runTasks fits it.
+     */
+    using ObjTaskRunner = std::function<void(size_t count, const std::function<void(size_t)>& task)>;
+
+    /**
+     * One corner of a triangulated OBJ face, holding 0 based indices into the position, uv and normal lists.
+     * Attributes the face doesn't specify are set to -1.
+     */
+    struct ObjCorner
+    {
+            int position;
+            int uv;
+            int normal;
+            // Indices that came from negative OBJ indices and are still relative to the start of their chunk
+            uint8_t chunkRelative;
+    };
+
+    /**
+     * The records of an OBJ file, faces are already fan triangulated into corners, three per triangle.
+     */
+    struct ObjMeshData
+    {
+            std::vector<glm::vec3> positions;
+            std::vector<glm::vec2> uvs;
+            std::vector<glm::vec3> normals;
+            std::vector<ObjCorner> corners;
+    };
+
+    namespace ObjParsing
+    {
+        /**
+         * The amount of records in front of a chunk, used to move chunk local indices into the merged lists.
+         */
+        struct ChunkOffset
+        {
+                size_t positions = 0;
+                size_t uvs = 0;
+                size_t normals = 0;
+                size_t corners = 0;
+        };
+
+        static inline bool isBlank(char c) { return c == ' ' || c == '\t' || c == '\r'; }
+
+        static inline const char* skipBlanks(const char* pos, const char* end)
+        {
+            while(pos < end && isBlank(*pos))
+            {
+                pos++;
+            }
+            return pos;
+        }
+
+        /**
+         * Parses the next float of a record.
+         * @return The position after the number, or pos itself if there is no number, leaving value untouched.
+         */
+        static inline const char* parseFloat(const char* pos, const char* end, float& value)
+        {
+            const char* start = skipBlanks(pos, end);
+            if(start < end && *start == '+')
+            {
+                start++;
+            }
+
+            const auto result = std::from_chars(start, end, value);
+            return result.ec == std::errc() ? result.ptr : pos;
+        }
+
+        /**
+         * Parses the next (possibly negative) index of a face corner.
+         * @return The position after the number, or nullptr if there is no number.
+         */
+        static inline const char* parseIndex(const char* pos, const char* end, int& value)
+        {
+            if(pos < end && *pos == '+')
+            {
+                pos++;
+            }
+
+            const auto result = std::from_chars(pos, end, value);
+            return result.ec == std::errc() ? result.ptr : nullptr;
+        }
+
+        /**
+         * Turns a 1 based OBJ index into a 0 based index. Negative indices count back from the records parsed
+         * so far, which only covers the current chunk. They get flagged and offset once all chunks are parsed.
+         * Invalid indices are mapped to INT_MAX, so they fail the range check once the file is parsed.
+         */
+        static inline int resolveIndex(int index, size_t count, uint8_t relativeFlag, uint8_t& chunkRelative)
+        {
+            if(index > 0)
+            {
+                return index - 1;
+            }
+            if(index < 0)
+            {
+                chunkRelative |= relativeFlag;
+                return int(int64_t(count) + index);
+            }
+            return INT_MAX;
+        }
+
+        /**
+         * Moves chunk relative indices into the merged lists, indices pointing before the file become invalid.
+         */
+        static inline int offsetRelativeIndex(int index, size_t offset)
+        {
+            const int64_t merged = int64_t(index) + int64_t(offset);
+            return merged >= 0 && merged < INT_MAX ? int(merged) : INT_MAX;
+        }
+
+        static void parseFace(const char* pos, const char* end, ObjMeshData& mesh)
+        {
+            ObjCorner first {};
+            ObjCorner previous {};
+            int cornerCount = 0;
+
+            while(true)
+            {
+                pos = skipBlanks(pos, end);
+                if(pos >= end)
+                {
+                    break;
+                }
+
+                int position = 0, uv = 0, normal = 0;
+                pos = parseIndex(pos, end, position);
+                if(pos == nullptr)
+                {
+                    // Malformed corner, ignore the rest of the face
+                    break;
+                }
+
+                if(pos < end && *pos == '/')
+                {
+                    pos++;
+                    if(pos < end && *pos != '/')
+                    {
+                        pos = parseIndex(pos, end, uv);
+                        if(pos == nullptr)
+                        {
+                            break;
+                        }
+                    }
+
+                    if(pos < end && *pos == '/')
+                    {
+                        pos = parseIndex(pos + 1, end, normal);
+                        if(pos == nullptr)
+                        {
+                            break;
+                        }
+                    }
+                }
+
+                ObjCorner corner {};
+                corner.position = resolveIndex(
+                        position,
+                        mesh.positions.size(),
+                        OBJ_RELATIVE_POSITION,
+                        corner.chunkRelative
+                );
+                corner.uv = uv != 0
+                        ? resolveIndex(uv, mesh.uvs.size(), OBJ_RELATIVE_UV, corner.chunkRelative)
+                        : -1;
+                corner.normal = normal != 0
+                        ? resolveIndex(normal, mesh.normals.size(), OBJ_RELATIVE_NORMAL, corner.chunkRelative)
+                        : -1;
+
+                // Quads and n-gons are split into a triangle fan around the first corner
+                if(cornerCount == 0)
+                {
+                    first = corner;
+                }
+                else if(cornerCount >= 2)
+                {
+                    mesh.corners.push_back(first);
+                    mesh.corners.push_back(previous);
+                    mesh.corners.push_back(corner);
+                }
+
+                previous = corner;
+                cornerCount++;
+            }
+        }
+
+        static void parseLine(const char* pos, const char* end, ObjMeshData& mesh)
+        {
+            pos = skipBlanks(pos, end);
+            if(end - pos < 2)
+            {
+                return;
+            }
+
+            if(pos[0] == 'v')
+            {
+                if(isBlank(pos[1]))
+                {
+                    glm::vec3 vertex(0.f);
+                    pos = parseFloat(pos + 1, end, vertex.x);
+                    pos = parseFloat(pos, end, vertex.y);
+                    parseFloat(pos, end, vertex.z);
+                    mesh.positions.push_back(vertex);
+                }
+                else if(pos[1] == 't' && end - pos > 2 && isBlank(pos[2]))
+                {
+                    glm::vec2 uv(0.f);
+                    pos = parseFloat(pos + 2, end, uv.x);
+                    parseFloat(pos, end, uv.y);
+                    mesh.uvs.push_back(uv);
+                }
+                else if(pos[1] == 'n' && end - pos > 2 && isBlank(pos[2]))
+                {
+                    glm::vec3 normal(0.f);
+                    pos = parseFloat(pos + 2, end, normal.x);
+                    pos = parseFloat(pos, end, normal.y);
+                    parseFloat(pos, end, normal.z);
+                    mesh.normals.push_back(normal);
+                }
+            }
+            else if(pos[0] == 'f' && isBlank(pos[1]))
+            {
+                parseFace(pos + 1, end, mesh);
+            }
+        }
+        static void parseChunk(const char* begin, const char* end, ObjMeshData& mesh)
+        {
+            const char* pos = begin;
+            while(pos < end)
+            {
+                const auto* lineEnd = static_cast<const char*>(memchr(pos, '\n', size_t(end - pos)));
+                if(lineEnd == nullptr)
+                {
+                    lineEnd = end;
+                }
+
+                parseLine(pos, lineEnd, mesh);
+                pos = lineEnd + 1;
+            }
+        }
+
+        static void resolveCorner(ObjCorner& corner, const ChunkOffset& offset)
+        {
+            if(corner.chunkRelative & OBJ_RELATIVE_POSITION)
+            {
+                corner.position = offsetRelativeIndex(corner.position, offset.positions);
+            }
+            if(corner.chunkRelative & OBJ_RELATIVE_UV)
+            {
+                corner.uv = offsetRelativeIndex(corner.uv, offset.uvs);
+            }
+            if(corner.chunkRelative & OBJ_RELATIVE_NORMAL)
+            {
+                corner.normal = offsetRelativeIndex(corner.normal, offset.normals);
+            }
+            corner.chunkRelative = 0;
+        }
+
+        /**
+         * Copies a parsed chunk into its range of the merged lists. Chunks don't overlap, so they can be merged
+         * concurrently once the merged lists are sized.
+         */
+        static void mergeChunk(const ObjMeshData& chunk, const ChunkOffset& offset, ObjMeshData& mesh)
+        {
+            const auto positionTarget = mesh.positions.begin() + ptrdiff_t(offset.positions);
+            std::copy(chunk.positions.begin(), chunk.positions.end(), positionTarget);
+            std::copy(chunk.uvs.begin(), chunk.uvs.end(), mesh.uvs.begin() + ptrdiff_t(offset.uvs));
+            const auto normalTarget = mesh.normals.begin() + ptrdiff_t(offset.normals);
+            std::copy(chunk.normals.begin(), chunk.normals.end(), normalTarget);
+
+            for(size_t i = 0; i < chunk.corners.size(); i++)
+            {
+                ObjCorner corner = chunk.corners[i];
+                resolveCorner(corner, offset);
+                mesh.corners[offset.corners + i] = corner;
+            }
+        }
+    } // namespace ObjParsing
+
+    /**
+     * Parses the v, vt, vn and f records of an OBJ file held in memory, all other records are ignored.
+     * Lines can be of any length, faces can have any amount of corners and use negative indices.
+     *
+     * Large files are split into newline aligned chunks which are parsed by the task runner. The chunks are
+     * merged in file order afterwards, using the prefix sums of their record counts as offsets.
+     *
+     * @param begin The first character of the file.
+     * @param end One past the last character of the file.
+     * @param mesh Receives the parsed records, has to be empty.
+     * @param chunkCount The amount of chunks to split the file into, 0 picks it by file size and core count.
+     * @param runTasks Runs the chunks, without one they're parsed one after another on the calling thread.
+     */
+    static void parseObj(
+            const char* begin,
+            const char* end,
+            ObjMeshData& mesh,
+            size_t chunkCount = 0,
+            const ObjTaskRunner& runTasks = nullptr
+    )
+    {
+        const size_t size = size_t(end - begin);
+        if(chunkCount == 0)
+        {
+            const size_t threadCount = runTasks ? std::max(1u, std::thread::hardware_concurrency()) : 1;
+            chunkCount = std::clamp<size_t>(size / OBJ_MIN_CHUNK_SIZE, 1, threadCount);
+        }
+
+        const ObjTaskRunner runInOrder = [](size_t count, const std::function<void(size_t)>& task)
+        {
+            for(size_t i = 0; i < count; i++)
+            {
+                task(i);
+            }
+        };
+        const ObjTaskRunner& runChunks = runTasks ? runTasks : runInOrder;
+
+        if(chunkCount <= 1)
+        {
+            ObjParsing::parseChunk(begin, end, mesh);
+            for(auto& corner : mesh.corners)
+            {
+                ObjParsing::resolveCorner(corner, ObjParsing::ChunkOffset());
+            }
+            return;
+        }
+
+        // Split the file behind line breaks, so every chunk only holds complete records
+        std::vector<const char*> bounds { begin };
+        for(size_t i = 1; i < chunkCount; i++)
+        {
+            const char* split = std::max(begin + size * i / chunkCount, bounds.back());
+            const auto* lineEnd = static_cast<const char*>(memchr(split, '\n', size_t(end - split)));
+            bounds.push_back(lineEnd != nullptr ? lineEnd + 1 : end);
+        }
+        bounds.push_back(end);
+
+        std::vector<ObjMeshData> chunks(chunkCount);
+        runChunks(chunkCount, [&bounds, &chunks](size_t i)
+                  { ObjParsing::parseChunk(bounds[i], bounds[i + 1], chunks[i]); });
+
+        std::vector<ObjParsing::ChunkOffset> offsets(chunkCount + 1);
+        for(size_t i = 0; i < chunkCount; i++)
+        {
+            offsets[i + 1].positions = offsets[i].positions + chunks[i].positions.size();
+            offsets[i + 1].uvs = offsets[i].uvs + chunks[i].uvs.size();
+            offsets[i + 1].normals = offsets[i].normals + chunks[i].normals.size();
+            offsets[i + 1].corners = offsets[i].corners + chunks[i].corners.size();
+        }
+
+        mesh.positions.resize(offsets.back().positions);
+        mesh.uvs.resize(offsets.back().uvs);
+        mesh.normals.resize(offsets.back().normals);
+        mesh.corners.resize(offsets.back().corners);
+
+        runChunks(chunkCount, [&chunks, &offsets, &mesh](size_t i)
+                  { ObjParsing::mergeChunk(chunks[i], offsets[i], mesh); });
+    }
+
+    /**
+     * Expands the triangulated faces into one position, uv and normal per corner.
+     * UVs and normals are only written if at least one face references them, missing ones are zeroed.
+     *
+     * @param mesh The parsed OBJ records.
+     * @param vertices The vector to store the vertex positions.
+     * @param uvs The vector to store the texture coordinates.
+     * @param normals The vector to store the normals.
+     * @param filePath The path of the parsed file, used for error messages.
+     * @return True if all face indices were valid, false otherwise.
+     */
+    static bool expandObjCorners(
+            const ObjMeshData& mesh,
+            std::vector<glm::vec3>& vertices,
+            std::vector<glm::vec2>& uvs,
+            std::vector<glm::vec3>& normals,
+            const char* filePath
+    )
+    {
+        bool hasUvs = false;
+        bool hasNormals = false;
+        for(const auto& corner : mesh.corners)
+        {
+            const bool positionValid = corner.position >= 0 && size_t(corner.position) < mesh.positions.size();
+            const bool uvValid = corner.uv < 0 || size_t(corner.uv) < mesh.uvs.size();
+            const bool normalValid = corner.normal < 0 || size_t(corner.normal) < mesh.normals.size();
+            if(!positionValid || !uvValid || !normalValid)
+            {
+                std::cout << "Face index out of range in OBJ file [" << filePath << "]" << std::endl;
+                return false;
+            }
+
+            hasUvs |= corner.uv >= 0;
+            hasNormals |= corner.normal >= 0;
+        }
+
+        const size_t offset = vertices.size();
+        vertices.resize(offset + mesh.corners.size());
+        if(hasUvs)
+        {
+            uvs.resize(offset + mesh.corners.size(), glm::vec2(0.f));
+        }
+        if(hasNormals)
+        {
+            normals.resize(offset + mesh.corners.size(), glm::vec3(0.f));
+        }
+
+        for(size_t i = 0; i < mesh.corners.size(); i++)
+        {
+            const ObjCorner& corner = mesh.corners[i];
+            vertices[offset + i] = mesh.positions[corner.position];
+
+            if(hasUvs && corner.uv >= 0)
+            {
+                uvs[offset + i] = mesh.uvs[corner.uv];
+            }
+
+            if(hasNormals && corner.normal >= 0)
+            {
+                normals[offset + i] = mesh.normals[corner.normal];
+            }
+        }
+
+        return true;
+    }
+} // namespace Engine
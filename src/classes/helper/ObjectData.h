@@ -1,51 +1,160 @@
 #pragma once
 
+#include <cstdint>
+#include <memory>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include <GL/glew.h>
 #include <glm/glm.hpp>
 
 #include "TriDataDef.h"
+#include "VertexEncodingHelper.h"
 
 namespace Engine
 {
+    /**
+     * Which CPU copies of a mesh are kept after its buffers have been uploaded.
+     */
+    enum class MeshRetention : uint8_t
+    {
+        // Decided from how the mesh is drawn, see RenderManager::requestResidency
+        AUTOMATIC,
+        // Positions, uvs, normals and indices
+        FULL,
+        // Positions and indices, enough for triangle sorting and picking
+        POSITIONS_AND_INDICES,
+        // Nothing, only the buffers remain
+        NONE
+    };
+
     struct ObjectData
     {
-            ObjectData(
-                    std::string filePath,
-                    GLuint vertexBuffer,
-                    GLuint uvBuffer,
-                    GLuint normalBuffer,
-                    GLuint indexBuffer,
-                    std::vector<glm::vec3> vertexData,
-                    std::vector<glm::vec2> vertexUvs,
-                    std::vector<glm::vec3> vertexNormals,
-                    std::vector<triData> vertexIndices
-            )
-                : m_vertexBuffer(vertexBuffer)
-                , m_uvBuffer(uvBuffer)
-                , m_normalBuffer(normalBuffer)
-                , m_indexBuffer(indexBuffer)
-                , m_vertexData(std::move(vertexData))
-                , m_vertexUvs(std::move(vertexUvs))
-                , m_vertexNormals(std::move(vertexNormals))
-                , m_filePath(std::move(filePath))
-                , m_vertexIndices(std::move(vertexIndices))
+            explicit ObjectData(std::string filePath) : m_filePath(std::move(filePath)) {}
+
+            ObjectData(const ObjectData&) = delete;
+            ObjectData& operator=(const ObjectData&) = delete;
+
+            /**
+             * Frees every GL object of the mesh, runs once the last MeshHandle is released.
+             */
+            ~ObjectData() { releaseBuffers(); }
+
+            void releaseBuffers()
+            {
+                const GLuint buffers[] = { m_vertexBuffer, m_indexBuffer, m_triangleOrderBuffer };
+                for(const GLuint buffer : buffers)
+                {
+                    if(buffer != 0 && buffer != GLuint(-1))
+                    {
+                        glDeleteBuffers(1, &buffer);
+                    }
+                }
+
+                m_vertexBuffer = -1;
+                m_indexBuffer = -1;
+                m_triangleOrderBuffer = 0;
+                m_triangleOrderResolution = 0;
+                m_gpuBytes = 0;
+                m_isResident = false;
+            }
+
+            /**
+             * Drops the CPU copies the retention level doesn't include.
+             *
+             * @param retention The data to keep, AUTOMATIC keeps everything
+             */
+            void releaseCpuData(MeshRetention retention)
+            {
+                if(retention == MeshRetention::POSITIONS_AND_INDICES || retention == MeshRetention::NONE)
+                {
+                    std::vector<glm::vec2>().swap(m_vertexUvs);
+                    std::vector<glm::vec3>().swap(m_vertexNormals);
+                }
+
+                if(retention == MeshRetention::NONE)
+                {
+                    std::vector<glm::vec3>().swap(m_vertexData);
+                    std::vector<triData>().swap(m_vertexIndices);
+                }
+
+                if(retention != MeshRetention::AUTOMATIC && retention != MeshRetention::FULL)
+                {
+                    m_retainedData = retention;
+                }
+            }
+
+            /**
+             * @return True if the positions and indices needed for triangle sorting are in memory
+             */
+            bool hasPositions() const { return m_retainedData != MeshRetention::NONE; }
+
+            size_t getCpuBytes() const
             {
+                return m_vertexData.size() * sizeof(glm::vec3) + m_vertexUvs.size() * sizeof(glm::vec2) +
+                        m_vertexNormals.size() * sizeof(glm::vec3) + m_vertexIndices.size() * sizeof(triData);
             }
 
             std::string m_filePath;
-            GLuint m_vertexBuffer;
-            GLuint m_uvBuffer;
-            GLuint m_normalBuffer;
-            GLuint m_indexBuffer;
+            // Interleaved vertex stream holding positions, uvs and normals, encoded as m_vertexFormat
+            GLuint m_vertexBuffer = -1;
+            GLuint m_indexBuffer = -1;
+            // Width in bytes of the uploaded indices, 2 for meshes with up to 65536 vertices, 4 otherwise
+            unsigned int m_indexWidth = 2;
+            bool m_hasUvs = false;
+            bool m_hasNormals = false;
+            // False until the buffers have been uploaded, see RenderManager::registerObjectAsync
+            bool m_isResident = false;
+            // Set while an asynchronous load is pending
+            bool m_isLoading = false;
+            // Set if the last asynchronous load failed, requestResidency doesn't retry it
+            bool m_loadFailed = false;
+            // Estimated size of the buffers in bytes, see RenderManager::setGpuMemoryBudget
+            size_t m_gpuBytes = 0;
+            // The last frame geometry using the object was drawn in
+            uint64_t m_lastUsedFrame = 0;
             std::vector<glm::vec3> m_vertexData;
             std::vector<glm::vec2> m_vertexUvs;
             std::vector<glm::vec3> m_vertexNormals;
 
             std::vector<triData> m_vertexIndices;
+            // Counts of the uploaded mesh, valid even after the CPU copies have been released
+            size_t m_vertexCount = 0;
+            size_t m_triangleCount = 0;
+
+            // The CPU copies to keep, and the copies currently kept
+            MeshRetention m_retention = MeshRetention::AUTOMATIC;
+            MeshRetention m_retainedData = MeshRetention::FULL;
+            // Set once the mesh was drawn in a way that needs its positions, e.g. sorted translucent geometry
+            bool m_needsPositions = false;
+            // Set while released positions are loaded again in the background, see restoreCpuDataAsync
+            bool m_isRestoring = false;
+            // Set if loading the released positions failed, they aren't requested again until the next upload
+            bool m_restoreFailed = false;
 
-            int getVertexCount() const { return int(m_vertexIndices.size() * 3); };
+            VertexFormat m_vertexFormat = VertexFormat::FLOAT32;
+            // Maps the stored positions into model space, see getDequantizationMatrix
+            glm::mat4 m_dequantization = glm::mat4(1.f);
+
+            // Precomputed back to front triangle orders, see RenderManager::bakeTriangleOrders
+            GLuint m_triangleOrderBuffer = 0;
+            int m_triangleOrderResolution = 0;
+            glm::vec3 m_triangleOrderCenter = glm::vec3(0.f);
+            // Set while the orders are baked in the background
+            bool m_isBakingTriangleOrders = false;
+            // Set if the orders would be too large, the mesh is sorted at runtime instead
+            bool m_triangleOrdersRejected = false;
+
+            int getVertexCount() const { return int(m_triangleCount * 3); };
+
+            GLenum getIndexType() const { return m_indexWidth == 2 ? GL_UNSIGNED_SHORT : GL_UNSIGNED_INT; };
+
+            bool hasTriangleOrders() const { return m_triangleOrderResolution > 0; };
     };
+
+    /**
+     * Reference counted handle of a registered mesh, the mesh is freed with its last handle.
+     */
+    using MeshHandle = std::shared_ptr<ObjectData>;
 } // namespace Engine
\ No newline at end of file
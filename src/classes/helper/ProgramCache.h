@@ -0,0 +1,178 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+#include <GL/glew.h>
+
+#include "HashUtils.h"
+#include "MappedFile.h"
+
+#define PROGRAM_CACHE_MAGIC 0x47525043 // Equivalent to "CPRG" in ASCII
+#define PROGRAM_CACHE_VERSION 1
+#define PROGRAM_CACHE_DIRECTORY "cache/shaders/"
+
+namespace Engine
+{
+    /**
+     * Layout of a program cache file: the header followed by the binary from glGetProgramBinary.
+     * Binaries are only valid for the driver that created them, driverHash identifies it.
+     */
+    struct ProgramCacheHeader
+    {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t binaryFormat;
+            uint32_t padding;
+            uint64_t sourceHash;
+            uint64_t driverHash;
+            uint64_t binarySize;
+    };
+
+    static_assert(sizeof(ProgramCacheHeader) == 40, "ProgramCacheHeader must not contain padding");
+
+    /**
+     * @param shaderPath The path of the shader files without extension, plus the features of the variant.
+     * @return The path of the cache file, named after the hash of the shader path.
+     */
+    static std::string getProgramCachePath(const std::string& shaderPath)
+    {
+        char fileName[32];
+        snprintf(fileName, sizeof(fileName), "%016llx.bin", (unsigned long long)hashString(shaderPath));
+        return std::string(PROGRAM_CACHE_DIRECTORY) + fileName;
+    }
+
+    /**
+     * Has to be called with a current GL context.
+     *
+     * @return The hash of the vendor, renderer and version strings of the driver
+     */
+    static uint64_t getDriverHash()
+    {
+        uint64_t hash = 0;
+        for(const GLenum name : { GL_VENDOR, GL_RENDERER, GL_VERSION })
+        {
+            const auto* string = reinterpret_cast<const char*>(glGetString(name));
+            hash = hashString(string ? string : "", hash);
+        }
+        return hash;
+    }
+
+    /**
+     * @return True if the driver can save and load program binaries, macOS drivers usually can't
+     */
+    static bool isProgramBinarySupported()
+    {
+        GLint formatCount = 0;
+        glGetIntegerv(GL_NUM_PROGRAM_BINARY_FORMATS, &formatCount);
+        return formatCount > 0;
+    }
+
+    /**
+     * Creates a program from its cached binary. The link status isn't queried, that would wait for the
+     * driver. It may still reject a matching binary, for example after an update, which RenderManager's
+     * finishShader checks before the program is first used.
+     *
+     * @param shaderPath The path of the shader files without extension, plus the features of the variant.
+     * @param sourceHash The hash of the current shader sources.
+     * @return The program, 0 if there's no matching cache.
+     */
+    static GLuint loadProgramCache(const std::string& shaderPath, uint64_t sourceHash)
+    {
+        if(!isProgramBinarySupported())
+        {
+            return 0;
+        }
+
+        MappedFile file(getProgramCachePath(shaderPath).c_str());
+        ProgramCacheHeader header {};
+        if(!file.isOpen() || file.size() < sizeof(ProgramCacheHeader))
+        {
+            return 0;
+        }
+
+        memcpy(&header, file.data(), sizeof(ProgramCacheHeader));
+        if(header.magic != PROGRAM_CACHE_MAGIC || header.version != PROGRAM_CACHE_VERSION ||
+           header.sourceHash != sourceHash || header.driverHash != getDriverHash() ||
+           header.binarySize != file.size() - sizeof(ProgramCacheHeader))
+        {
+            return 0;
+        }
+
+        const GLuint program = glCreateProgram();
+        glProgramBinary(
+                program,
+                header.binaryFormat,
+                file.data() + sizeof(ProgramCacheHeader),
+                GLsizei(header.binarySize)
+        );
+
+        return program;
+    }
+
+    /**
+     * Writes the binary of a linked program into the program cache.
+     * The program should be linked with GL_PROGRAM_BINARY_RETRIEVABLE_HINT set.
+     * The file is written to a temporary path first and moved into place once complete.
+     *
+     * @param shaderPath The path of the shader files without extension, plus the features of the variant.
+     * @param sourceHash The hash of the shader sources the program was compiled from.
+     * @param program The linked program.
+     * @return True if the cache was written, false otherwise.
+     */
+    static bool writeProgramCache(const std::string& shaderPath, uint64_t sourceHash, GLuint program)
+    {
+        GLint linkStatus = GL_FALSE;
+        GLint binarySize = 0;
+        glGetProgramiv(program, GL_LINK_STATUS, &linkStatus);
+        glGetProgramiv(program, GL_PROGRAM_BINARY_LENGTH, &binarySize);
+        if(linkStatus != GL_TRUE || binarySize <= 0 || !isProgramBinarySupported())
+        {
+            return false;
+        }
+
+        std::vector<char> binary(binarySize);
+        GLenum binaryFormat = 0;
+        GLsizei writtenSize = 0;
+        glGetProgramBinary(program, binarySize, &writtenSize, &binaryFormat, binary.data());
+        if(writtenSize <= 0)
+        {
+            return false;
+        }
+
+        ProgramCacheHeader header {};
+        header.magic = PROGRAM_CACHE_MAGIC;
+        header.version = PROGRAM_CACHE_VERSION;
+        header.binaryFormat = binaryFormat;
+        header.sourceHash = sourceHash;
+        header.driverHash = getDriverHash();
+        header.binarySize = uint64_t(writtenSize);
+
+        std::error_code error;
+        std::filesystem::create_directories(PROGRAM_CACHE_DIRECTORY, error);
+
+        const std::string cachePath = getProgramCachePath(shaderPath);
+        const std::string tempPath = cachePath + ".tmp";
+        FILE* file = fopen(tempPath.c_str(), "wb");
+        if(file == nullptr)
+        {
+            return false;
+        }
+
+        bool success = fwrite(&header, sizeof(header), 1, file) == 1;
+        success = success && fwrite(binary.data(), 1, size_t(writtenSize), file) == size_t(writtenSize);
+        success = fclose(file) == 0 && success;
+
+        if(!success || std::rename(tempPath.c_str(), cachePath.c_str()) != 0)
+        {
+            std::remove(tempPath.c_str());
+            return false;
+        }
+
+        return true;
+    }
+} // namespace Engine
@@ -0,0 +1,95 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <utility>
+
+namespace Engine
+{
+    /**
+     * Features a shader can be specialised for. Each one adds its define to the shader sources, so a program
+     * only contains the code of the features it was compiled with.
+     */
+    enum ShaderFeature : uint32_t
+    {
+        SHADER_FEATURE_NONE = 0,
+        SHADER_FEATURE_AMBIENT_LIGHT = 1 << 0,
+        SHADER_FEATURE_DIFFUSE_LIGHT = 1 << 1,
+        SHADER_FEATURE_TEXTURE = 1 << 2,
+        SHADER_FEATURE_VERTEX_COLOR = 1 << 3,
+        SHADER_FEATURE_INSTANCING = 1 << 4,
+        SHADER_FEATURE_CLUSTERED_LIGHTS = 1 << 5
+    };
+
+    // Follow the state of the lights at draw time instead of being fixed when the shader is registered
+    inline const uint32_t SHADER_LIGHTING_FEATURES =
+            SHADER_FEATURE_AMBIENT_LIGHT | SHADER_FEATURE_DIFFUSE_LIGHT | SHADER_FEATURE_CLUSTERED_LIGHTS;
+
+    inline const std::pair<ShaderFeature, const char*> SHADER_FEATURE_DEFINES[] = {
+        { SHADER_FEATURE_AMBIENT_LIGHT, "USE_AMBIENT_LIGHT" },
+        { SHADER_FEATURE_DIFFUSE_LIGHT, "USE_DIFFUSE_LIGHT" },
+        { SHADER_FEATURE_TEXTURE, "USE_TEXTURE" },
+        { SHADER_FEATURE_VERTEX_COLOR, "USE_VERTEX_COLOR" },
+        { SHADER_FEATURE_INSTANCING, "USE_INSTANCING" },
+        { SHADER_FEATURE_CLUSTERED_LIGHTS, "USE_CLUSTERED_LIGHTS" }
+    };
+
+    /**
+     * Adds a define for every feature after the #version directive, which has to stay the first statement.
+     * A #line directive keeps the line numbers of compile errors matching the file.
+     *
+     * @param source The GLSL source
+     * @param features The ShaderFeature flags to define
+     * @return The source of the permutation
+     */
+    static std::string addShaderDefines(const std::string& source, uint32_t features)
+    {
+        if(features == SHADER_FEATURE_NONE)
+        {
+            return source;
+        }
+
+        std::string defines;
+        for(const auto& [feature, define] : SHADER_FEATURE_DEFINES)
+        {
+            if(features & feature)
+            {
+                defines += "#define " + std::string(define) + "\n";
+            }
+        }
+
+        size_t insertAt = 0;
+        const size_t version = source.find("#version");
+        if(version != std::string::npos)
+        {
+            const size_t lineEnd = source.find('\n', version);
+            insertAt = lineEnd == std::string::npos ? source.size() : lineEnd + 1;
+        }
+
+        std::string prefix = source.substr(0, insertAt);
+        if(!prefix.empty() && prefix.back() != '\n')
+        {
+            prefix += '\n';
+        }
+
+        const size_t nextLine = size_t(std::count(prefix.begin(), prefix.end(), '\n')) + 1;
+        return prefix + defines + "#line " + std::to_string(nextLine) + "\n" + source.substr(insertAt);
+    }
+
+    /**
+     * @return The name followed by the define of every feature, like "lit+USE_TEXTURE+USE_AMBIENT_LIGHT"
+     */
+    static std::string getShaderVariantName(const std::string& name, uint32_t features)
+    {
+        std::string variantName = name;
+        for(const auto& [feature, define] : SHADER_FEATURE_DEFINES)
+        {
+            if(features & feature)
+            {
+                variantName += "+" + std::string(define);
+            }
+        }
+        return variantName;
+    }
+} // namespace Engine
@@ -0,0 +1,6 @@
+// The stb_image implementation is compiled once here, FileLoading.h only includes its declarations
+#define STB_IMAGE_IMPLEMENTATION
+#define STBI_ONLY_BMP
+#define STBI_ONLY_TGA
+#define STBI_ONLY_PNG
+#include <stb_image.h>
@@ -0,0 +1,236 @@
+#pragma once
+
+#include <algorithm>
+#include <cstring>
+#include <numeric>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "ImageData.h"
+#include "MipmapGenerator.h"
+#include "TextureData.h"
+
+namespace Engine
+{
+    // Texels repeating the border of every image in an atlas, so filtering doesn't pick up its neighbours
+    inline constexpr int TEXTURE_ATLAS_PADDING = 8;
+    // Images start on multiples of this, block compressed mip levels don't mix neighbours down to level 2
+    inline constexpr int TEXTURE_ATLAS_ALIGNMENT = 16;
+    // Smaller levels would blend neighbouring images once the padding is filtered away
+    inline constexpr size_t TEXTURE_ATLAS_MIP_LEVELS = 4;
+
+    /**
+     * @brief Where an image ended up in an atlas or texture array.
+     * Texture coordinates of a mesh are mapped with uv * uvScale + uvOffset, layer selects the array layer.
+     */
+    struct TextureRegion
+    {
+            glm::vec2 uvScale = glm::vec2(1.f);
+            glm::vec2 uvOffset = glm::vec2(0.f);
+            int layer = 0;
+    };
+
+    /**
+     * @brief A texture holding several image files and where each of them is stored.
+     */
+    struct TextureAtlas
+    {
+            TextureHandle texture;
+            // Regions by the path of the packed files
+            std::unordered_map<std::string, TextureRegion> regions;
+    };
+
+    /**
+     * @brief Rectangle of an image inside an atlas in texels, without its padding.
+     */
+    struct AtlasRect
+    {
+            int x;
+            int y;
+            int width;
+            int height;
+    };
+
+    static inline int alignAtlasSize(int size)
+    {
+        return (size + TEXTURE_ATLAS_ALIGNMENT - 1) / TEXTURE_ATLAS_ALIGNMENT * TEXTURE_ATLAS_ALIGNMENT;
+    }
+
+    /**
+     * Packs images into shelves, the tallest images first. Tries every power of two width
+     * and keeps the smallest atlas.
+     *
+     * @param sizes The width and height of every image.
+     * @param maxSize The largest width and height the atlas may have.
+     * @param rects Receives the rectangle of every image, in the order of sizes.
+     * @return The size of the atlas, zero if the images don't fit into maxSize.
+     */
+    static glm::ivec2 packAtlasRects(
+            const std::vector<glm::ivec2>& sizes,
+            int maxSize,
+            std::vector<AtlasRect>& rects
+    )
+    {
+        std::vector<size_t> order(sizes.size());
+        std::iota(order.begin(), order.end(), size_t(0));
+        std::stable_sort(
+                order.begin(),
+                order.end(),
+                [&sizes](size_t a, size_t b) { return sizes[a].y > sizes[b].y; }
+        );
+
+        glm::ivec2 bestSize(0);
+        std::vector<AtlasRect> placed(sizes.size());
+        for(int width = TEXTURE_ATLAS_ALIGNMENT; width <= maxSize; width *= 2)
+        {
+            int shelfX = 0;
+            int shelfY = 0;
+            int shelfHeight = 0;
+            bool fits = true;
+            for(const size_t index : order)
+            {
+                const int cellWidth = alignAtlasSize(sizes[index].x + 2 * TEXTURE_ATLAS_PADDING);
+                const int cellHeight = alignAtlasSize(sizes[index].y + 2 * TEXTURE_ATLAS_PADDING);
+                if(cellWidth > width)
+                {
+                    fits = false;
+                    break;
+                }
+                if(shelfX + cellWidth > width)
+                {
+                    shelfX = 0;
+                    shelfY += shelfHeight;
+                    shelfHeight = 0;
+                }
+
+                placed[index] = { shelfX + TEXTURE_ATLAS_PADDING,
+                                  shelfY + TEXTURE_ATLAS_PADDING,
+                                  sizes[index].x,
+                                  sizes[index].y };
+                shelfX += cellWidth;
+                shelfHeight = std::max(shelfHeight, cellHeight);
+            }
+
+            int height = TEXTURE_ATLAS_ALIGNMENT;
+            while(height < shelfY + shelfHeight)
+            {
+                height *= 2;
+            }
+            if(!fits || height > maxSize)
+            {
+                continue;
+            }
+
+            if(bestSize.x == 0 || width * height < bestSize.x * bestSize.y)
+            {
+                bestSize = glm::ivec2(width, height);
+                rects = placed;
+            }
+        }
+
+        return bestSize;
+    }
+
+    /**
+     * Copies the base levels of RGBA8 images into an atlas, fills their padding with their border texels
+     * and generates the atlas' mip levels.
+     *
+     * @param images The images, uncompressed RGBA8.
+     * @param rects The rectangles from packAtlasRects.
+     * @param atlasSize The size from packAtlasRects.
+     * @param atlas Receives the atlas image.
+     * @param regions Receives the region of every image.
+     */
+    static void buildAtlasImage(
+            const std::vector<const ImageData*>& images,
+            const std::vector<AtlasRect>& rects,
+            glm::ivec2 atlasSize,
+            ImageData& atlas,
+            std::vector<TextureRegion>& regions
+    )
+    {
+        atlas = ImageData();
+        atlas.internalFormat = GL_RGBA8;
+        atlas.format = GL_RGBA;
+        atlas.pixels.assign(size_t(atlasSize.x) * size_t(atlasSize.y) * 4, 0);
+        atlas.levels = { { 0, atlas.pixels.size(), atlasSize.x, atlasSize.y } };
+
+        regions.clear();
+        for(size_t i = 0; i < images.size(); i++)
+        {
+            const ImageData& image = *images[i];
+            const ImageLevel& base = image.levels[0];
+            const AtlasRect& rect = rects[i];
+            for(int y = -TEXTURE_ATLAS_PADDING; y < rect.height + TEXTURE_ATLAS_PADDING; y++)
+            {
+                const int sourceY = std::clamp(y, 0, rect.height - 1);
+                for(int x = -TEXTURE_ATLAS_PADDING; x < rect.width + TEXTURE_ATLAS_PADDING; x++)
+                {
+                    const int sourceX = std::clamp(x, 0, rect.width - 1);
+                    const size_t source =
+                            base.offset + (size_t(sourceY) * size_t(base.width) + size_t(sourceX)) * 4;
+                    const size_t target = (size_t(rect.y + y) * size_t(atlasSize.x) + size_t(rect.x + x)) * 4;
+                    memcpy(atlas.pixels.data() + target, image.pixels.data() + source, 4);
+                }
+            }
+
+            TextureRegion region;
+            region.uvScale = glm::vec2(rect.width, rect.height) / glm::vec2(atlasSize);
+            region.uvOffset = glm::vec2(rect.x, rect.y) / glm::vec2(atlasSize);
+            regions.push_back(region);
+        }
+
+        generateMipChain(atlas);
+        if(atlas.levels.size() > TEXTURE_ATLAS_MIP_LEVELS)
+        {
+            atlas.levels.resize(TEXTURE_ATLAS_MIP_LEVELS);
+            atlas.pixels.resize(atlas.levels.back().offset + atlas.levels.back().size);
+        }
+    }
+
+    /**
+     * Stacks RGBA8 images of the same size and mip count into the layers of an array image.
+     *
+     * @param images The images, uncompressed RGBA8.
+     * @param array Receives the array image, stored layer by layer like DDS files.
+     * @return False if the images don't share their size and mip levels.
+     */
+    static bool buildArrayImage(const std::vector<const ImageData*>& images, ImageData& array)
+    {
+        array = ImageData();
+        array.internalFormat = GL_RGBA8;
+        array.format = GL_RGBA;
+        array.target = GL_TEXTURE_2D_ARRAY;
+        array.layerCount = GLsizei(images.size());
+
+        for(size_t layer = 0; layer < images.size(); layer++)
+        {
+            const ImageData& image = *images[layer];
+            if(image.levels.size() != images[0]->levels.size())
+            {
+                return false;
+            }
+
+            for(size_t level = 0; level < image.levels.size(); level++)
+            {
+                const ImageLevel& mip = image.levels[level];
+                const ImageLevel& firstMip = images[0]->levels[level];
+                if(mip.width != firstMip.width || mip.height != firstMip.height)
+                {
+                    return false;
+                }
+
+                const size_t offset = array.pixels.size();
+                const unsigned char* source = image.getPixelData() + mip.offset;
+                array.pixels.insert(array.pixels.end(), source, source + mip.size);
+                const GLint arrayLayer = GLint(layer);
+                array.levels.push_back({ offset, mip.size, mip.width, mip.height, GLint(level), arrayLayer });
+            }
+        }
+
+        return !images.empty();
+    }
+} // namespace Engine
@@ -0,0 +1,209 @@
+#pragma once
+
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+
+#include "AssetFile.h"
+#include "HashUtils.h"
+#include "ImageData.h"
+#include "TextureFileParser.h"
+
+#define TEXTURE_CACHE_MAGIC 0x58455443 // Equivalent to "CTEX" in ASCII
+#define TEXTURE_CACHE_VERSION 1
+#define TEXTURE_CACHE_DIRECTORY "cache/textures/"
+
+namespace Engine
+{
+    /**
+     * Identifies the source file a texture cache was compressed from, stored in DdsHeader::reserved.
+     */
+    struct TextureCacheStamp
+    {
+            uint32_t magic;
+            uint32_t version;
+            uint64_t sourceSize;
+            int64_t sourceModificationTime;
+            uint64_t sourceHash;
+    };
+
+    static_assert(sizeof(TextureCacheStamp) <= sizeof(DdsHeader::reserved), "TextureCacheStamp too large");
+
+    /**
+     * @param sourcePath The path of the image file the cache belongs to.
+     * @return The path of the DDS cache file, named after the hash of the source path.
+     */
+    static std::string getTextureCachePath(const char* sourcePath)
+    {
+        char fileName[32];
+        snprintf(fileName, sizeof(fileName), "%016llx.dds", (unsigned long long)hashString(sourcePath));
+        return std::string(TEXTURE_CACHE_DIRECTORY) + fileName;
+    }
+
+    /**
+     * Writes a DXT1, DXT5 or RGBA8 image including its mip levels and array layers as a DDS file.
+     * Arrays and uncompressed images get the DX10 header. The file is written to a temporary path first
+     * and moved into place once complete.
+     *
+     * @param filePath The path of the DDS file.
+     * @param image The image, a 2D texture or 2D texture array.
+     * @param stamp Stored in the reserved words of the header if set.
+     * @return True if the file was written, false otherwise.
+     */
+    static bool writeFileDDS(
+            const std::string& filePath,
+            const ImageData& image,
+            const TextureCacheStamp* stamp = nullptr
+    )
+    {
+        uint32_t dxgiFormat;
+        switch(image.internalFormat)
+        {
+            case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+                dxgiFormat = 71;
+                break;
+            case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+                dxgiFormat = 77;
+                break;
+            case GL_RGBA8:
+                dxgiFormat = 28;
+                break;
+            default:
+                return false;
+        }
+        if(image.levels.empty() || (image.target != GL_TEXTURE_2D && image.target != GL_TEXTURE_2D_ARRAY) ||
+           (!image.isCompressed && (image.format != GL_RGBA || image.type != GL_UNSIGNED_BYTE)))
+        {
+            return false;
+        }
+
+        const size_t levelCount = image.levels.size() / size_t(image.layerCount);
+        DdsHeader header {};
+        header.size = sizeof(DdsHeader);
+        // Caps, height, width, pixel format, mip count and linear size are set
+        header.flags = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000 | 0x80000;
+        header.height = uint32_t(image.levels[0].height);
+        header.width = uint32_t(image.levels[0].width);
+        header.linearSize = uint32_t(image.levels[0].size);
+        header.mipMapCount = uint32_t(levelCount);
+        if(stamp)
+        {
+            memcpy(header.reserved, stamp, sizeof(TextureCacheStamp));
+        }
+        header.pixelFormatSize = 32;
+        header.pixelFormatFlags = 0x4; // fourCC is valid
+        header.caps = 0x1000 | (levelCount > 1 ? 0x400008 : 0); // Texture, complex mip chain
+
+        // Plain 2D DXT textures keep the legacy header every DDS reader understands
+        const bool needsDx10Header = image.target == GL_TEXTURE_2D_ARRAY || !image.isCompressed;
+        const DdsHeaderDx10 extension { dxgiFormat, 3, 0, uint32_t(image.layerCount), 0 };
+        if(needsDx10Header)
+        {
+            header.fourCC = DDS_FOURCC('D', 'X', '1', '0');
+        }
+        else if(dxgiFormat == 71)
+        {
+            header.fourCC = DDS_FOURCC('D', 'X', 'T', '1');
+        }
+        else
+        {
+            header.fourCC = DDS_FOURCC('D', 'X', 'T', '5');
+        }
+
+        std::error_code error;
+        std::filesystem::create_directories(std::filesystem::path(filePath).parent_path(), error);
+
+        const std::string tempPath = filePath + ".tmp";
+        FILE* file = fopen(tempPath.c_str(), "wb");
+        if(file == nullptr)
+        {
+            return false;
+        }
+
+        bool success = fwrite("DDS ", 1, 4, file) == 4;
+        success = success && fwrite(&header, sizeof(header), 1, file) == 1;
+        success = success && (!needsDx10Header || fwrite(&extension, sizeof(extension), 1, file) == 1);
+
+        // DDS stores every layer with all of its levels before the next layer
+        for(GLsizei layer = 0; layer < image.layerCount; layer++)
+        {
+            for(const ImageLevel& mip : image.levels)
+            {
+                if(mip.layer == layer)
+                {
+                    const unsigned char* data = image.getPixelData() + mip.offset;
+                    success = success && fwrite(data, 1, mip.size, file) == mip.size;
+                }
+            }
+        }
+        success = fclose(file) == 0 && success;
+
+        if(!success || std::rename(tempPath.c_str(), filePath.c_str()) != 0)
+        {
+            std::remove(tempPath.c_str());
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * Writes a DXT1 or DXT5 compressed image including its mip levels as a DDS file into the texture cache.
+     *
+     * @param sourcePath The path of the image file the data was compressed from.
+     * @param image The compressed image.
+     * @return True if the cache was written, false otherwise.
+     */
+    static bool writeTextureCache(const char* sourcePath, const ImageData& image)
+    {
+        AssetFile source(sourcePath);
+        if(!source.isOpen() || !image.isCompressed || image.target != GL_TEXTURE_2D)
+        {
+            return false;
+        }
+
+        TextureCacheStamp stamp {};
+        stamp.magic = TEXTURE_CACHE_MAGIC;
+        stamp.version = TEXTURE_CACHE_VERSION;
+        stamp.sourceSize = source.size();
+        stamp.sourceModificationTime = int64_t(source.getModificationTime());
+        stamp.sourceHash = hashBytes(source.data(), source.size());
+
+        return writeFileDDS(getTextureCachePath(sourcePath), image, &stamp);
+    }
+
+    /**
+     * Checks that the texture cache of an image file exists and is still up to date.
+     * The source is looked up like the loader does, in the mounted asset packs first,
+     * see isAssetUnchanged. A cache without its source file is used as is.
+     *
+     * @param sourcePath The path of the image file.
+     * @return True if the DDS cache can be loaded instead of the source, false otherwise.
+     */
+    static bool isTextureCacheFresh(const char* sourcePath)
+    {
+        FILE* file = fopen(getTextureCachePath(sourcePath).c_str(), "rb");
+        if(file == nullptr)
+        {
+            return false;
+        }
+
+        char fileCode[4];
+        DdsHeader header {};
+        const bool isComplete =
+                fread(fileCode, 1, 4, file) == 4 && fread(&header, sizeof(header), 1, file) == 1;
+        fclose(file);
+
+        TextureCacheStamp stamp {};
+        memcpy(&stamp, header.reserved, sizeof(stamp));
+        if(!isComplete || strncmp(fileCode, "DDS ", 4) != 0 || stamp.magic != TEXTURE_CACHE_MAGIC ||
+           stamp.version != TEXTURE_CACHE_VERSION)
+        {
+            return false;
+        }
+
+        return isAssetUnchanged(sourcePath, stamp.sourceSize, stamp.sourceModificationTime, stamp.sourceHash);
+    }
+} // namespace Engine
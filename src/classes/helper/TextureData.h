@@ -0,0 +1,56 @@
+#pragma once
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <utility>
+
+#include <GL/glew.h>
+
+namespace Engine
+{
+    struct TextureData
+    {
+            explicit TextureData(std::string filePath) : m_filePath(std::move(filePath)) {}
+
+            TextureData(const TextureData&) = delete;
+            TextureData& operator=(const TextureData&) = delete;
+
+            /**
+             * Frees the texture, runs once the last TextureHandle is released.
+             */
+            ~TextureData() { releaseTexture(); }
+
+            void releaseTexture()
+            {
+                if(m_textureId != 0 && m_textureId != GLuint(-1))
+                {
+                    glDeleteTextures(1, &m_textureId);
+                }
+
+                m_textureId = 0;
+                m_gpuBytes = 0;
+                m_isResident = false;
+            }
+
+            std::string m_filePath;
+            GLuint m_textureId = 0;
+            // GL_TEXTURE_2D unless the texture was loaded from an array or cube map DDS or KTX2 file
+            GLenum m_target = GL_TEXTURE_2D;
+            // False until the texture has been uploaded, see RenderManager::registerTextureAsync
+            bool m_isResident = false;
+            // Set while an asynchronous load is pending
+            bool m_isLoading = false;
+            // Set if the last asynchronous load failed, requestResidency doesn't retry it
+            bool m_loadFailed = false;
+            // Estimated size of the texture including its mip levels in bytes
+            size_t m_gpuBytes = 0;
+            // The last frame geometry using the texture was drawn in
+            uint64_t m_lastUsedFrame = 0;
+    };
+
+    /**
+     * Reference counted handle of a registered texture, the texture is freed with its last handle.
+     */
+    using TextureHandle = std::shared_ptr<TextureData>;
+} // namespace Engine
@@ -0,0 +1,456 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstring>
+#include <iostream>
+
+#include "ImageData.h"
+
+#define DDS_FOURCC(a, b, c, d) (uint32_t(a) | (uint32_t(b) << 8) | (uint32_t(c) << 16) | (uint32_t(d) << 24))
+
+namespace Engine
+{
+    /**
+     * Header of a DDS file as it follows the "DDS " file code. Texture caches keep their
+     * TextureCacheStamp in the reserved words, readers of plain DDS files skip them.
+     */
+    struct DdsHeader
+    {
+            uint32_t size;
+            uint32_t flags;
+            uint32_t height;
+            uint32_t width;
+            uint32_t linearSize;
+            uint32_t depth;
+            uint32_t mipMapCount;
+            uint32_t reserved[11];
+            uint32_t pixelFormatSize;
+            uint32_t pixelFormatFlags;
+            uint32_t fourCC;
+            uint32_t rgbBitCount;
+            uint32_t redMask;
+            uint32_t greenMask;
+            uint32_t blueMask;
+            uint32_t alphaMask;
+            uint32_t caps;
+            uint32_t caps2;
+            uint32_t caps3;
+            uint32_t caps4;
+            uint32_t reserved2;
+    };
+
+    /**
+     * Extended header following the DdsHeader if its fourCC is "DX10".
+     */
+    struct DdsHeaderDx10
+    {
+            uint32_t dxgiFormat;
+            uint32_t resourceDimension;
+            uint32_t miscFlag;
+            uint32_t arraySize;
+            uint32_t miscFlags2;
+    };
+
+    /**
+     * Header of a KTX2 file following its 12 byte identifier, including the index of the data blocks.
+     */
+    struct Ktx2Header
+    {
+            uint32_t vkFormat;
+            uint32_t typeSize;
+            uint32_t pixelWidth;
+            uint32_t pixelHeight;
+            uint32_t pixelDepth;
+            uint32_t layerCount;
+            uint32_t faceCount;
+            uint32_t levelCount;
+            uint32_t supercompressionScheme;
+            uint32_t dfdByteOffset;
+            uint32_t dfdByteLength;
+            uint32_t kvdByteOffset;
+            uint32_t kvdByteLength;
+            // 64 bit values, split since they follow the identifier unaligned
+            uint32_t sgdByteOffset[2];
+            uint32_t sgdByteLength[2];
+    };
+
+    /**
+     * Entry of the KTX2 level index, one per mip level starting with the base level.
+     */
+    struct Ktx2Level
+    {
+            uint64_t byteOffset;
+            uint64_t byteLength;
+            uint64_t uncompressedByteLength;
+    };
+
+    static_assert(sizeof(DdsHeader) == 124, "DdsHeader must match the DDS file layout");
+    static_assert(sizeof(DdsHeaderDx10) == 20, "DdsHeaderDx10 must match the DDS file layout");
+    static_assert(sizeof(Ktx2Header) == 68, "Ktx2Header must match the KTX2 file layout");
+    static_assert(sizeof(Ktx2Level) == 24, "Ktx2Level must match the KTX2 file layout");
+
+    inline constexpr unsigned char KTX2_IDENTIFIER[12] = { 0xAB, 0x4B, 0x54, 0x58, 0x20, 0x32,
+                                                           0x30, 0xBB, 0x0D, 0x0A, 0x1A, 0x0A };
+
+    /**
+     * @param internalFormat A block compressed internal format.
+     * @return The bytes of one 4x4 block, 0 if the format isn't block compressed.
+     */
+    static size_t getCompressedBlockSize(GLenum internalFormat)
+    {
+        switch(internalFormat)
+        {
+            case GL_COMPRESSED_RGB_S3TC_DXT1_EXT:
+            case GL_COMPRESSED_RGBA_S3TC_DXT1_EXT:
+            case GL_COMPRESSED_SRGB_S3TC_DXT1_EXT:
+            case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT:
+            case GL_COMPRESSED_RED_RGTC1:
+            case GL_COMPRESSED_SIGNED_RED_RGTC1:
+                return 8;
+            case GL_COMPRESSED_RGBA_S3TC_DXT3_EXT:
+            case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT:
+            case GL_COMPRESSED_RGBA_S3TC_DXT5_EXT:
+            case GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT:
+            case GL_COMPRESSED_RG_RGTC2:
+            case GL_COMPRESSED_SIGNED_RG_RGTC2:
+            case GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT:
+            case GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT:
+            case GL_COMPRESSED_RGBA_BPTC_UNORM:
+            case GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM:
+                return 16;
+            default:
+                return 0;
+        }
+    }
+
+    /**
+     * @return The exact bytes of one width x height image of the level of a texture in the image's format.
+     */
+    static size_t getImageLevelSize(const ImageData& image, GLsizei width, GLsizei height)
+    {
+        if(image.isCompressed)
+        {
+            const size_t blocks = size_t((width + 3) / 4) * size_t((height + 3) / 4);
+            return blocks * getCompressedBlockSize(image.internalFormat);
+        }
+
+        return size_t(width) * size_t(height) * 4;
+    }
+
+    /**
+     * Sets the format of the image to a block compressed format, or to 8 bit RGBA if internalFormat is one.
+     *
+     * @return False if the format isn't supported
+     */
+    static bool setImageFormat(ImageData& image, GLenum internalFormat)
+    {
+        image.internalFormat = internalFormat;
+        image.type = GL_UNSIGNED_BYTE;
+        if(internalFormat == GL_RGBA8 || internalFormat == GL_SRGB8_ALPHA8)
+        {
+            image.format = GL_RGBA;
+            image.isCompressed = false;
+            return true;
+        }
+
+        image.format = GL_RGBA;
+        image.isCompressed = true;
+        return getCompressedBlockSize(internalFormat) != 0;
+    }
+
+    static GLenum getDxgiInternalFormat(uint32_t dxgiFormat)
+    {
+        switch(dxgiFormat)
+        {
+            case 28:
+                return GL_RGBA8;
+            case 29:
+                return GL_SRGB8_ALPHA8;
+            case 71:
+                return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+            case 72:
+                return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;
+            case 74:
+                return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+            case 75:
+                return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT;
+            case 77:
+                return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            case 78:
+                return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+            case 80:
+                return GL_COMPRESSED_RED_RGTC1;
+            case 81:
+                return GL_COMPRESSED_SIGNED_RED_RGTC1;
+            case 83:
+                return GL_COMPRESSED_RG_RGTC2;
+            case 84:
+                return GL_COMPRESSED_SIGNED_RG_RGTC2;
+            case 95:
+                return GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT;
+            case 96:
+                return GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT;
+            case 98:
+                return GL_COMPRESSED_RGBA_BPTC_UNORM;
+            case 99:
+                return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+            default:
+                return 0;
+        }
+    }
+
+    static GLenum getFourCCInternalFormat(uint32_t fourCC)
+    {
+        switch(fourCC)
+        {
+            case DDS_FOURCC('D', 'X', 'T', '1'):
+                return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+            case DDS_FOURCC('D', 'X', 'T', '3'):
+                return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+            case DDS_FOURCC('D', 'X', 'T', '5'):
+                return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            case DDS_FOURCC('A', 'T', 'I', '1'):
+            case DDS_FOURCC('B', 'C', '4', 'U'):
+                return GL_COMPRESSED_RED_RGTC1;
+            case DDS_FOURCC('B', 'C', '4', 'S'):
+                return GL_COMPRESSED_SIGNED_RED_RGTC1;
+            case DDS_FOURCC('A', 'T', 'I', '2'):
+            case DDS_FOURCC('B', 'C', '5', 'U'):
+                return GL_COMPRESSED_RG_RGTC2;
+            case DDS_FOURCC('B', 'C', '5', 'S'):
+                return GL_COMPRESSED_SIGNED_RG_RGTC2;
+            default:
+                return 0;
+        }
+    }
+
+    static GLenum getVkInternalFormat(uint32_t vkFormat)
+    {
+        switch(vkFormat)
+        {
+            case 37:
+                return GL_RGBA8;
+            case 43:
+                return GL_SRGB8_ALPHA8;
+            case 131:
+                return GL_COMPRESSED_RGB_S3TC_DXT1_EXT;
+            case 132:
+                return GL_COMPRESSED_SRGB_S3TC_DXT1_EXT;
+            case 133:
+                return GL_COMPRESSED_RGBA_S3TC_DXT1_EXT;
+            case 134:
+                return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT1_EXT;
+            case 135:
+                return GL_COMPRESSED_RGBA_S3TC_DXT3_EXT;
+            case 136:
+                return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT3_EXT;
+            case 137:
+                return GL_COMPRESSED_RGBA_S3TC_DXT5_EXT;
+            case 138:
+                return GL_COMPRESSED_SRGB_ALPHA_S3TC_DXT5_EXT;
+            case 139:
+                return GL_COMPRESSED_RED_RGTC1;
+            case 140:
+                return GL_COMPRESSED_SIGNED_RED_RGTC1;
+            case 141:
+                return GL_COMPRESSED_RG_RGTC2;
+            case 142:
+                return GL_COMPRESSED_SIGNED_RG_RGTC2;
+            case 143:
+                return GL_COMPRESSED_RGB_BPTC_UNSIGNED_FLOAT;
+            case 144:
+                return GL_COMPRESSED_RGB_BPTC_SIGNED_FLOAT;
+            case 145:
+                return GL_COMPRESSED_RGBA_BPTC_UNORM;
+            case 146:
+                return GL_COMPRESSED_SRGB_ALPHA_BPTC_UNORM;
+            default:
+                return 0;
+        }
+    }
+
+    /**
+     * Sets the texture target of an image with the given number of array layers and cube faces.
+     */
+    static void setImageTarget(ImageData& image, uint32_t layerCount, uint32_t faceCount)
+    {
+        if(faceCount == 6)
+        {
+            image.target = layerCount > 1 ? GL_TEXTURE_CUBE_MAP_ARRAY : GL_TEXTURE_CUBE_MAP;
+        }
+        else
+        {
+            image.target = layerCount > 1 ? GL_TEXTURE_2D_ARRAY : GL_TEXTURE_2D;
+        }
+        image.layerCount = GLsizei(layerCount * faceCount);
+    }
+
+    /**
+     * Describes the texture stored in a DDS file, the legacy header as well as the DX10 header are supported.
+     * The levels point into the given data, which is stored layer by layer with all mip levels of a layer
+     * following each other.
+     *
+     * @param data The contents of the DDS file.
+     * @param size The size of the file in bytes.
+     * @param image Receives format, target and levels, its offsets are relative to data.
+     * @param filePath The path of the file, used in error messages.
+     * @return True if the file holds a supported texture, false otherwise.
+     */
+    static bool parseDDS(const unsigned char* data, size_t size, ImageData& image, const char* filePath)
+    {
+        DdsHeader header {};
+        if(size < 4 + sizeof(DdsHeader) || memcmp(data, "DDS ", 4) != 0)
+        {
+            std::cout << "DDS file is not correct [" << filePath << "]" << std::endl;
+            return false;
+        }
+        memcpy(&header, data + 4, sizeof(DdsHeader));
+        size_t offset = 4 + sizeof(DdsHeader);
+
+        uint32_t layerCount = 1;
+        uint32_t faceCount = (header.caps2 & 0x200) ? 6 : 1; // DDSCAPS2_CUBEMAP
+        GLenum internalFormat = 0;
+        const bool hasDx10Header = header.fourCC == DDS_FOURCC('D', 'X', '1', '0');
+        if(hasDx10Header)
+        {
+            DdsHeaderDx10 extension {};
+            if(size < offset + sizeof(DdsHeaderDx10))
+            {
+                std::cout << "DDS file is not correct [" << filePath << "]" << std::endl;
+                return false;
+            }
+            memcpy(&extension, data + offset, sizeof(DdsHeaderDx10));
+            offset += sizeof(DdsHeaderDx10);
+
+            // Only 2D resources, volume textures are not supported
+            if(extension.resourceDimension != 3)
+            {
+                std::cout << "DDS dimension not supported [" << filePath << "]" << std::endl;
+                return false;
+            }
+            internalFormat = getDxgiInternalFormat(extension.dxgiFormat);
+            layerCount = std::max(extension.arraySize, 1u);
+            faceCount = (extension.miscFlag & 0x4) ? 6 : 1; // D3D11_RESOURCE_MISC_TEXTURECUBE
+        }
+        else if(header.pixelFormatFlags & 0x4) // DDPF_FOURCC
+        {
+            internalFormat = getFourCCInternalFormat(header.fourCC);
+        }
+        else if((header.pixelFormatFlags & 0x40) && header.rgbBitCount == 32) // DDPF_RGB
+        {
+            internalFormat = header.redMask == 0xFF || header.redMask == 0xFF0000 ? GL_RGBA8 : 0;
+        }
+
+        if(!setImageFormat(image, internalFormat))
+        {
+            std::cout << "DDS format not supported [" << filePath << "]" << std::endl;
+            return false;
+        }
+        if(!image.isCompressed && !hasDx10Header && header.redMask == 0xFF0000)
+        {
+            image.format = GL_BGRA;
+        }
+        if(faceCount == 6 && !hasDx10Header && (header.caps2 & 0xFC00) != 0xFC00)
+        {
+            std::cout << "DDS cube map without all faces [" << filePath << "]" << std::endl;
+            return false;
+        }
+
+        setImageTarget(image, layerCount, faceCount);
+        image.generateMipmaps = false;
+        image.pixels.clear();
+        image.levels.clear();
+
+        // DDSD_MIPMAPCOUNT
+        const uint32_t mipMapCount = (header.flags & 0x20000) ? std::max(header.mipMapCount, 1u) : 1u;
+        for(GLsizei layer = 0; layer < image.layerCount; layer++)
+        {
+            GLsizei width = GLsizei(std::max(header.width, 1u));
+            GLsizei height = GLsizei(std::max(header.height, 1u));
+            for(uint32_t level = 0; level < mipMapCount; level++)
+            {
+                const size_t levelSize = getImageLevelSize(image, width, height);
+                if(offset + levelSize > size)
+                {
+                    std::cout << "DDS file is truncated [" << filePath << "]" << std::endl;
+                    return false;
+                }
+
+                image.levels.push_back({ offset, levelSize, width, height, GLint(level), GLint(layer) });
+                offset += levelSize;
+                width = std::max(width / 2, 1);
+                height = std::max(height / 2, 1);
+            }
+        }
+
+        return true;
+    }
+
+    /**
+     * Describes the texture stored in a KTX2 file. Supercompressed files aren't supported.
+     * A file without mip levels gets them generated after the upload.
+     *
+     * @param data The contents of the KTX2 file.
+     * @param size The size of the file in bytes.
+     * @param image Receives format, target and levels, its offsets are relative to data.
+     * @param filePath The path of the file, used in error messages.
+     * @return True if the file holds a supported texture, false otherwise.
+     */
+    static bool parseKTX2(const unsigned char* data, size_t size, ImageData& image, const char* filePath)
+    {
+        Ktx2Header header {};
+        const size_t levelIndexOffset = sizeof(KTX2_IDENTIFIER) + sizeof(Ktx2Header);
+        if(size < levelIndexOffset || memcmp(data, KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER)) != 0)
+        {
+            std::cout << "KTX2 file is not correct [" << filePath << "]" << std::endl;
+            return false;
+        }
+        memcpy(&header, data + sizeof(KTX2_IDENTIFIER), sizeof(Ktx2Header));
+
+        if(header.supercompressionScheme != 0 || header.pixelDepth > 1 ||
+           !setImageFormat(image, getVkInternalFormat(header.vkFormat)))
+        {
+            std::cout << "KTX2 format not supported [" << filePath << "]" << std::endl;
+            return false;
+        }
+
+        const uint32_t levelCount = std::max(header.levelCount, 1u);
+        if(size < levelIndexOffset + levelCount * sizeof(Ktx2Level) ||
+           (header.faceCount != 1 && header.faceCount != 6))
+        {
+            std::cout << "KTX2 file is not correct [" << filePath << "]" << std::endl;
+            return false;
+        }
+
+        setImageTarget(image, std::max(header.layerCount, 1u), header.faceCount);
+        image.generateMipmaps = header.levelCount == 0 && !image.isCompressed;
+        image.pixels.clear();
+        image.levels.clear();
+
+        // Unlike DDS every level holds all of its layers and faces
+        for(uint32_t level = 0; level < levelCount; level++)
+        {
+            Ktx2Level index {};
+            memcpy(&index, data + levelIndexOffset + level * sizeof(Ktx2Level), sizeof(Ktx2Level));
+
+            const GLsizei width = std::max(GLsizei(header.pixelWidth >> level), 1);
+            const GLsizei height = std::max(GLsizei(header.pixelHeight >> level), 1);
+            const size_t levelSize = getImageLevelSize(image, width, height);
+            if(index.byteOffset + index.byteLength > size ||
+               levelSize * size_t(image.layerCount) > index.byteLength)
+            {
+                std::cout << "KTX2 file is truncated [" << filePath << "]" << std::endl;
+                return false;
+            }
+
+            for(GLsizei layer = 0; layer < image.layerCount; layer++)
+            {
+                const size_t offset = size_t(index.byteOffset) + size_t(layer) * levelSize;
+                image.levels.push_back({ offset, levelSize, width, height, GLint(level), GLint(layer) });
+            }
+        }
+
+        return true;
+    }
+} // namespace Engine
@@ -1,8 +1,84 @@
 #pragma once
 
-#include <tuple>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <vector>
 
-typedef std::tuple<unsigned short, unsigned short, unsigned short> triData;
+#include <glm/glm.hpp>
+
+/**
+ * The three vertex indices of a triangle. Meshes keep their indices at full width on the CPU,
+ * they are only narrowed to the index width of the mesh when uploaded.
+ */
+typedef std::array<unsigned int, 3> triData;
+
+static_assert(sizeof(triData) == 3 * sizeof(unsigned int), "triData has to be tightly packed");
+
+/**
+ * @param vertexCount The amount of vertices the indices address.
+ * @return The smallest index width in bytes able to address all vertices, either 2 or 4.
+ */
+static inline unsigned int getIndexWidth(size_t vertexCount) { return vertexCount <= 0x10000 ? 2 : 4; }
+
+/**
+ * Narrows triangle indices into the layout they are uploaded with.
+ *
+ * @param indices The triangles to pack.
+ * @param indexWidth The width of one index in bytes, either 2 or 4.
+ * @param out Receives the packed indices.
+ */
+static void packIndices(
+        const std::vector<triData>& indices,
+        unsigned int indexWidth,
+        std::vector<uint8_t>& out
+)
+{
+    out.resize(indices.size() * 3 * indexWidth);
+    if(indexWidth == sizeof(unsigned int))
+    {
+        memcpy(out.data(), indices.data(), out.size());
+        return;
+    }
+
+    auto* packed = reinterpret_cast<uint16_t*>(out.data());
+    for(const auto& tri : indices)
+    {
+        *packed++ = uint16_t(tri[0]);
+        *packed++ = uint16_t(tri[1]);
+        *packed++ = uint16_t(tri[2]);
+    }
+}
+
+/**
+ * Widens packed triangle indices back into triangles.
+ *
+ * @param data The packed indices.
+ * @param triangleCount The amount of triangles in data.
+ * @param indexWidth The width of one index in bytes, either 2 or 4.
+ * @param out Receives the triangles.
+ */
+static void unpackIndices(
+        const void* data,
+        size_t triangleCount,
+        unsigned int indexWidth,
+        std::vector<triData>& out
+)
+{
+    out.resize(triangleCount);
+    if(indexWidth == sizeof(unsigned int))
+    {
+        memcpy(out.data(), data, triangleCount * sizeof(triData));
+        return;
+    }
+
+    const auto* packed = static_cast<const uint16_t*>(data);
+    for(auto& tri : out)
+    {
+        tri = { packed[0], packed[1], packed[2] };
+        packed += 3;
+    }
+}
 
 static bool depthSortTrianglesAlgorithm(
         const glm::vec3& cameraPos,
@@ -12,13 +88,13 @@ static bool depthSortTrianglesAlgorithm(
         const triData& triB
 )
 {
-    auto aPos = (vertices[std::get<0>(triA)] + vertices[std::get<1>(triA)] + vertices[std::get<2>(triA)]);
+    auto aPos = (vertices[triA[0]] + vertices[triA[1]] + vertices[triA[2]]);
     aPos.x = aPos.x / 3;
     aPos.y = aPos.y / 3;
     aPos.z = aPos.z / 3;
     aPos += nodePos;
 
-    auto bPos = (vertices[std::get<0>(triB)] + vertices[std::get<1>(triB)] + vertices[std::get<2>(triB)]);
+    auto bPos = (vertices[triB[0]] + vertices[triB[1]] + vertices[triB[2]]);
     bPos.x = bPos.x / 3;
     bPos.y = bPos.y / 3;
     bPos.z = bPos.z / 3;
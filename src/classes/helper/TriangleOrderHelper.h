@@ -0,0 +1,289 @@
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <filesystem>
+#include <numeric>
+#include <string>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+#include "HashUtils.h"
+#include "TriDataDef.h"
+
+#define TRIANGLE_ORDER_CACHE_MAGIC 0x44524F54 // Equivalent to "TORD" in ASCII
+#define TRIANGLE_ORDER_CACHE_VERSION 1
+#define TRIANGLE_ORDER_CACHE_DIRECTORY "cache/triangleOrders/"
+// Larger meshes are sorted at runtime, their orders would take too much video memory
+#define TRIANGLE_ORDER_MAX_TRIANGLES 65536
+
+namespace Engine
+{
+    /**
+     * Precomputed triangle orders are stored per cell of a cube map of view directions.
+     * Every face of the cube is split into resolution * resolution cells.
+     *
+     * @param resolution The amount of cells along one edge of a cube face.
+     * @return The total amount of view directions.
+     */
+    static int getTriangleOrderCount(int resolution) { return 6 * resolution * resolution; }
+
+    /**
+     * Maps a view direction onto the cube map cell it falls into.
+     *
+     * @param dir The direction from the mesh towards the viewer in object space, doesn't need to be normalized.
+     * @param resolution The amount of cells along one edge of a cube face.
+     * @return The index of the precomputed triangle order to use.
+     */
+    static int getTriangleOrderIndex(const glm::vec3& dir, int resolution)
+    {
+        const glm::vec3 absDir = glm::abs(dir);
+        int face;
+        float u, v, major;
+
+        if(absDir.x >= absDir.y && absDir.x >= absDir.z)
+        {
+            face = dir.x >= 0.f ? 0 : 1;
+            major = absDir.x;
+            u = dir.y;
+            v = dir.z;
+        }
+        else if(absDir.y >= absDir.z)
+        {
+            face = dir.y >= 0.f ? 2 : 3;
+            major = absDir.y;
+            u = dir.x;
+            v = dir.z;
+        }
+        else
+        {
+            face = dir.z >= 0.f ? 4 : 5;
+            major = absDir.z;
+            u = dir.x;
+            v = dir.y;
+        }
+
+        if(major <= 0.f)
+        {
+            return 0;
+        }
+
+        const int cellU = std::clamp(int((u / major * 0.5f + 0.5f) * float(resolution)), 0, resolution - 1);
+        const int cellV = std::clamp(int((v / major * 0.5f + 0.5f) * float(resolution)), 0, resolution - 1);
+
+        return (face * resolution + cellV) * resolution + cellU;
+    }
+
+    /**
+     * Returns the normalized view direction through the center of a cube map cell.
+     *
+     * @param index The index of the cube map cell.
+     * @param resolution The amount of cells along one edge of a cube face.
+     * @return The view direction the cell represents.
+     */
+    static glm::vec3 getTriangleOrderDirection(int index, int resolution)
+    {
+        const int face = index / (resolution * resolution);
+        const int cell = index % (resolution * resolution);
+
+        const float u = ((float(cell % resolution) + .5f) / float(resolution)) * 2.f - 1.f;
+        const float v = ((float(cell / resolution) + .5f) / float(resolution)) * 2.f - 1.f;
+        const float major = face % 2 == 0 ? 1.f : -1.f;
+
+        switch(face / 2)
+        {
+            case 0:
+                return glm::normalize(glm::vec3(major, u, v));
+            case 1:
+                return glm::normalize(glm::vec3(u, major, v));
+            default:
+                return glm::normalize(glm::vec3(u, v, major));
+        }
+    }
+
+    /**
+     * Sorts the triangles of a static mesh back to front once for every quantized view direction.
+     * The orders are written back to back, the order of direction n starts at triangle n * indices.size().
+     *
+     * @param vertices The vertex positions of the mesh.
+     * @param indices The triangles of the mesh.
+     * @param resolution The amount of cells along one edge of a cube face.
+     * @param center Receives the center of the meshes bounds, view directions are measured from there.
+     * @param outOrders Receives the sorted triangles of every direction.
+     */
+    static void computeTriangleOrders(
+            const std::vector<glm::vec3>& vertices,
+            const std::vector<triData>& indices,
+            int resolution,
+            glm::vec3& center,
+            std::vector<triData>& outOrders
+    )
+    {
+        glm::vec3 boundsMin = vertices.empty() ? glm::vec3(0.f) : vertices[0];
+        glm::vec3 boundsMax = boundsMin;
+        for(const auto& vertex : vertices)
+        {
+            boundsMin = glm::min(boundsMin, vertex);
+            boundsMax = glm::max(boundsMax, vertex);
+        }
+        center = (boundsMin + boundsMax) * .5f;
+
+        std::vector<glm::vec3> centroids(indices.size());
+        for(size_t i = 0; i < indices.size(); i++)
+        {
+            const auto& tri = indices[i];
+            centroids[i] = vertices[tri[0]] + vertices[tri[1]] + vertices[tri[2]];
+            centroids[i] = centroids[i] / 3.f - center;
+        }
+
+        const int directionCount = getTriangleOrderCount(resolution);
+        outOrders.resize(size_t(directionCount) * indices.size());
+
+        std::vector<unsigned int> order(indices.size());
+        std::vector<float> depth(indices.size());
+        for(int direction = 0; direction < directionCount; direction++)
+        {
+            const glm::vec3 viewDir = getTriangleOrderDirection(direction, resolution);
+            for(size_t i = 0; i < centroids.size(); i++)
+            {
+                depth[i] = glm::dot(centroids[i], viewDir);
+            }
+
+            // Triangles furthest away from the viewer have the smallest projection onto the view direction
+            std::iota(order.begin(), order.end(), 0);
+            std::sort(
+                    order.begin(),
+                    order.end(),
+                    [&depth](unsigned int a, unsigned int b) { return depth[a] < depth[b]; }
+            );
+
+            triData* out = &outOrders[size_t(direction) * indices.size()];
+            for(size_t i = 0; i < order.size(); i++)
+            {
+                out[i] = indices[order[i]];
+            }
+        }
+    }
+
+    struct TriangleOrderCacheHeader
+    {
+            uint32_t magic;
+            uint32_t version;
+            uint32_t resolution;
+            uint32_t triangleCount;
+            uint64_t meshHash;
+            float center[3];
+            uint32_t triangleSize;
+    };
+
+    /**
+     * @param sourcePath The path of the mesh file the orders belong to.
+     * @return The path of the cache file, named after the hash of the source path.
+     */
+    static std::string getTriangleOrderCachePath(const char* sourcePath)
+    {
+        char fileName[32];
+        snprintf(fileName, sizeof(fileName), "%016llx.triorder", (unsigned long long)hashString(sourcePath));
+        return std::string(TRIANGLE_ORDER_CACHE_DIRECTORY) + fileName;
+    }
+
+    /**
+     * Writes precomputed triangle orders into the cache.
+     * The file is written to a temporary path first and moved into place once complete.
+     *
+     * @param sourcePath The path of the mesh file the orders belong to.
+     * @param meshHash Hash of the vertex and index data the orders were computed from.
+     * @param resolution The amount of cells along one edge of a cube face.
+     * @param center The center of the meshes bounds.
+     * @param orders The sorted triangles of every direction.
+     * @return True if the cache was written, false otherwise.
+     */
+    static bool saveTriangleOrderCache(
+            const char* sourcePath,
+            uint64_t meshHash,
+            int resolution,
+            const glm::vec3& center,
+            const std::vector<triData>& orders
+    )
+    {
+        std::error_code error;
+        std::filesystem::create_directories(TRIANGLE_ORDER_CACHE_DIRECTORY, error);
+
+        const std::string cachePath = getTriangleOrderCachePath(sourcePath);
+        const std::string tempPath = cachePath + ".tmp";
+        FILE* file = fopen(tempPath.c_str(), "wb");
+        if(file == nullptr)
+        {
+            return false;
+        }
+
+        TriangleOrderCacheHeader header {};
+        header.magic = TRIANGLE_ORDER_CACHE_MAGIC;
+        header.version = TRIANGLE_ORDER_CACHE_VERSION;
+        header.resolution = uint32_t(resolution);
+        header.triangleCount = uint32_t(orders.size() / getTriangleOrderCount(resolution));
+        header.meshHash = meshHash;
+        header.center[0] = center.x;
+        header.center[1] = center.y;
+        header.center[2] = center.z;
+        header.triangleSize = sizeof(triData);
+
+        bool success = fwrite(&header, sizeof(header), 1, file) == 1 &&
+                fwrite(orders.data(), sizeof(triData), orders.size(), file) == orders.size();
+        success = fclose(file) == 0 && success;
+
+        if(!success || std::rename(tempPath.c_str(), cachePath.c_str()) != 0)
+        {
+            std::remove(tempPath.c_str());
+            return false;
+        }
+
+        return true;
+    }
+
+    /**
+     * Reads precomputed triangle orders, if the cache matches the given mesh.
+     *
+     * @param sourcePath The path of the mesh file the orders belong to.
+     * @param meshHash Hash of the vertex and index data the orders should belong to.
+     * @param resolution The amount of cells along one edge of a cube face.
+     * @param triangleCount The amount of triangles in the mesh.
+     * @param center Receives the center of the meshes bounds.
+     * @param orders Receives the sorted triangles of every direction.
+     * @return True if a matching cache was read, false otherwise.
+     */
+    static bool loadTriangleOrderCache(
+            const char* sourcePath,
+            uint64_t meshHash,
+            int resolution,
+            size_t triangleCount,
+            glm::vec3& center,
+            std::vector<triData>& orders
+    )
+    {
+        FILE* file = fopen(getTriangleOrderCachePath(sourcePath).c_str(), "rb");
+        if(file == nullptr)
+        {
+            return false;
+        }
+
+        TriangleOrderCacheHeader header {};
+        if(fread(&header, sizeof(header), 1, file) != 1 || header.magic != TRIANGLE_ORDER_CACHE_MAGIC ||
+           header.version != TRIANGLE_ORDER_CACHE_VERSION || header.resolution != uint32_t(resolution) ||
+           header.triangleCount != triangleCount || header.meshHash != meshHash ||
+           header.triangleSize != sizeof(triData))
+        {
+            fclose(file);
+            return false;
+        }
+
+        orders.resize(size_t(getTriangleOrderCount(resolution)) * triangleCount);
+        const bool success = fread(orders.data(), sizeof(triData), orders.size(), file) == orders.size();
+        fclose(file);
+
+        center = glm::vec3(header.center[0], header.center[1], header.center[2]);
+        return success;
+    }
+} // namespace Engine
@@ -0,0 +1,53 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+#include <glm/glm.hpp>
+
+/**
+ * One vertex of the interleaved vertex stream, as uploaded to the vertex buffer of an object.
+ */
+struct PackedVertex
+{
+        glm::vec3 position;
+        glm::vec2 uv;
+        glm::vec3 normal;
+};
+
+static_assert(sizeof(PackedVertex) == 32, "PackedVertex has to be tightly packed");
+
+static void interleaveVertices(
+        const std::vector<glm::vec3>& vertices,
+        const std::vector<glm::vec2>& uvs,
+        const std::vector<glm::vec3>& normals,
+        std::vector<PackedVertex>& out
+)
+{
+    out.resize(vertices.size());
+    for(size_t i = 0; i < vertices.size(); i++)
+    {
+        out[i].position = vertices[i];
+        out[i].uv = i < uvs.size() ? uvs[i] : glm::vec2(0.f);
+        out[i].normal = i < normals.size() ? normals[i] : glm::vec3(0.f);
+    }
+}
+
+static void deinterleaveVertices(
+        const PackedVertex* in,
+        size_t count,
+        std::vector<glm::vec3>& vertices,
+        std::vector<glm::vec2>& uvs,
+        std::vector<glm::vec3>& normals
+)
+{
+    vertices.resize(count);
+    uvs.resize(count);
+    normals.resize(count);
+    for(size_t i = 0; i < count; i++)
+    {
+        vertices[i] = in[i].position;
+        uvs[i] = in[i].uv;
+        normals[i] = in[i].normal;
+    }
+}
@@ -0,0 +1,225 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+#include <glm/glm.hpp>
+#include <glm/gtc/packing.hpp>
+
+#include "VertexDataDef.h"
+
+/**
+ * How the vertices of a mesh are stored in its vertex buffer.
+ */
+enum class VertexFormat : uint32_t
+{
+    // Full float PackedVertex, 32 bytes
+    FLOAT32 = 0,
+    // Half float positions, octahedral normals and half float uvs, 16 bytes
+    HALF_POSITIONS = 1,
+    // Positions normalized to the bounds of the mesh, octahedral normals and half float uvs, 16 bytes
+    SNORM16_POSITIONS = 2
+};
+
+/**
+ * One vertex of the compressed vertex formats. Positions are either half floats or snorm16 values
+ * relative to the bounds of the mesh, normals are octahedral encoded snorm16 pairs.
+ */
+struct QuantizedVertex
+{
+        uint16_t position[4];
+        int16_t normal[2];
+        uint16_t uv[2];
+};
+
+static_assert(sizeof(QuantizedVertex) == 16, "QuantizedVertex has to be tightly packed");
+
+static inline size_t getVertexStride(VertexFormat format)
+{
+    return format == VertexFormat::FLOAT32 ? sizeof(PackedVertex) : sizeof(QuantizedVertex);
+}
+
+/**
+ * Maps a unit vector onto the octahedron and unfolds it into the [-1, 1] square.
+ */
+static inline glm::vec2 encodeOctahedral(const glm::vec3& normal)
+{
+    const float length = std::abs(normal.x) + std::abs(normal.y) + std::abs(normal.z);
+    if(length <= 0.f)
+    {
+        return glm::vec2(0.f);
+    }
+
+    glm::vec2 encoded = glm::vec2(normal.x, normal.y) / length;
+    if(normal.z < 0.f)
+    {
+        encoded = glm::vec2(
+                (1.f - std::abs(encoded.y)) * (encoded.x >= 0.f ? 1.f : -1.f),
+                (1.f - std::abs(encoded.x)) * (encoded.y >= 0.f ? 1.f : -1.f)
+        );
+    }
+    return encoded;
+}
+
+static inline glm::vec3 decodeOctahedral(const glm::vec2& encoded)
+{
+    glm::vec3 normal(encoded.x, encoded.y, 1.f - std::abs(encoded.x) - std::abs(encoded.y));
+    if(normal.z < 0.f)
+    {
+        normal = glm::vec3(
+                (1.f - std::abs(encoded.y)) * (encoded.x >= 0.f ? 1.f : -1.f),
+                (1.f - std::abs(encoded.x)) * (encoded.y >= 0.f ? 1.f : -1.f),
+                normal.z
+        );
+    }
+
+    const float length = glm::length(normal);
+    return length > 0.f ? normal / length : normal;
+}
+
+static inline int16_t encodeSnorm16(float value)
+{
+    return int16_t(std::lround(std::clamp(value, -1.f, 1.f) * 32767.f));
+}
+
+static inline float decodeSnorm16(int16_t value) { return std::max(float(value) / 32767.f, -1.f); }
+
+/**
+ * The snorm16 position format stores every position relative to the center of the meshes bounds,
+ * scaled by half their extent.
+ *
+ * @param boundsMin The minimum corner of the meshes bounds.
+ * @param boundsMax The maximum corner of the meshes bounds.
+ * @param center Receives the center of the bounds.
+ * @param extent Receives half the size of the bounds, never zero.
+ */
+static inline void getQuantizationRange(
+        const glm::vec3& boundsMin,
+        const glm::vec3& boundsMax,
+        glm::vec3& center,
+        glm::vec3& extent
+)
+{
+    center = (boundsMin + boundsMax) * .5f;
+    extent = (boundsMax - boundsMin) * .5f;
+    for(int i = 0; i < 3; i++)
+    {
+        extent[i] = extent[i] > 0.f ? extent[i] : 1.f;
+    }
+}
+
+/**
+ * Converts the full float vertices of a mesh into the given vertex format.
+ *
+ * @param vertices The vertices to encode.
+ * @param format The format to encode into.
+ * @param boundsMin The minimum corner of the meshes bounds.
+ * @param boundsMax The maximum corner of the meshes bounds.
+ * @param out Receives the encoded vertex stream.
+ */
+static void encodeVertices(
+        const std::vector<PackedVertex>& vertices,
+        VertexFormat format,
+        const glm::vec3& boundsMin,
+        const glm::vec3& boundsMax,
+        std::vector<uint8_t>& out
+)
+{
+    out.resize(vertices.size() * getVertexStride(format));
+    if(format == VertexFormat::FLOAT32)
+    {
+        memcpy(out.data(), vertices.data(), out.size());
+        return;
+    }
+
+    glm::vec3 center, extent;
+    getQuantizationRange(boundsMin, boundsMax, center, extent);
+
+    auto* encoded = reinterpret_cast<QuantizedVertex*>(out.data());
+    for(const auto& vertex : vertices)
+    {
+        for(int i = 0; i < 3; i++)
+        {
+            if(format == VertexFormat::HALF_POSITIONS)
+            {
+                encoded->position[i] = glm::packHalf1x16(vertex.position[i]);
+            }
+            else
+            {
+                const int16_t value = encodeSnorm16((vertex.position[i] - center[i]) / extent[i]);
+                memcpy(&encoded->position[i], &value, sizeof(int16_t));
+            }
+        }
+        encoded->position[3] = 0;
+
+        const glm::vec2 normal = encodeOctahedral(vertex.normal);
+        encoded->normal[0] = encodeSnorm16(normal.x);
+        encoded->normal[1] = encodeSnorm16(normal.y);
+
+        encoded->uv[0] = glm::packHalf1x16(vertex.uv.x);
+        encoded->uv[1] = glm::packHalf1x16(vertex.uv.y);
+        encoded++;
+    }
+}
+
+/**
+ * Converts an encoded vertex stream back into separate full float attributes.
+ *
+ * @param data The encoded vertex stream.
+ * @param vertexCount The amount of vertices in data.
+ * @param format The format of data.
+ * @param boundsMin The minimum corner of the meshes bounds.
+ * @param boundsMax The maximum corner of the meshes bounds.
+ * @param vertices Receives the vertex positions.
+ * @param uvs Receives the texture coordinates.
+ * @param normals Receives the normals.
+ */
+static void decodeVertices(
+        const void* data,
+        size_t vertexCount,
+        VertexFormat format,
+        const glm::vec3& boundsMin,
+        const glm::vec3& boundsMax,
+        std::vector<glm::vec3>& vertices,
+        std::vector<glm::vec2>& uvs,
+        std::vector<glm::vec3>& normals
+)
+{
+    if(format == VertexFormat::FLOAT32)
+    {
+        deinterleaveVertices(static_cast<const PackedVertex*>(data), vertexCount, vertices, uvs, normals);
+        return;
+    }
+
+    glm::vec3 center, extent;
+    getQuantizationRange(boundsMin, boundsMax, center, extent);
+
+    vertices.resize(vertexCount);
+    uvs.resize(vertexCount);
+    normals.resize(vertexCount);
+
+    const auto* encoded = static_cast<const QuantizedVertex*>(data);
+    for(size_t vertex = 0; vertex < vertexCount; vertex++, encoded++)
+    {
+        for(int i = 0; i < 3; i++)
+        {
+            if(format == VertexFormat::HALF_POSITIONS)
+            {
+                vertices[vertex][i] = glm::unpackHalf1x16(encoded->position[i]);
+            }
+            else
+            {
+                int16_t value;
+                memcpy(&value, &encoded->position[i], sizeof(int16_t));
+                vertices[vertex][i] = center[i] + decodeSnorm16(value) * extent[i];
+            }
+        }
+
+        const glm::vec2 normal(decodeSnorm16(encoded->normal[0]), decodeSnorm16(encoded->normal[1]));
+        normals[vertex] = decodeOctahedral(normal);
+        uvs[vertex] = glm::vec2(glm::unpackHalf1x16(encoded->uv[0]), glm::unpackHalf1x16(encoded->uv[1]));
+    }
+}
@@ -1,98 +1,151 @@
 #pragma once
 
 #include <glm/glm.hpp>
-#include <map>
 
-#include "TriDataDef.h"
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <vector>
 
-static inline void writeToTuple(triData& tuple, const unsigned short& valueIndex, const unsigned short& value)
-{
-    switch(valueIndex)
-    {
-        case 0:
-            std::get<0>(tuple) = value;
-            break;
-        case 1:
-            std::get<1>(tuple) = value;
-            break;
-        case 2:
-            std::get<2>(tuple) = value;
-            break;
-        default:
-            fprintf(stderr, "Vertex indexing failed!");
-    }
-}
+#include "HashUtils.h"
+#include "TriDataDef.h"
+#include "VertexDataDef.h"
 
-struct PackedVertex
+/**
+ * The bytes a vertex is welded by, either the raw bits of every float or the floats quantized to a grid.
+ */
+struct VertexWeldKey
 {
-        glm::vec3 position;
-        glm::vec2 uv;
-        glm::vec3 normal;
+        uint32_t values[8];
 
-        bool operator<(const PackedVertex that) const
+        bool operator==(const VertexWeldKey& that) const
         {
-            return memcmp((void*)this, (void*)&that, sizeof(PackedVertex)) > 0;
-        };
+            return memcmp(values, that.values, sizeof(values)) == 0;
+        }
 };
 
-bool getSimilarVertexIndex_fast(
-        PackedVertex& packed,
-        std::map<PackedVertex, unsigned short>& VertexToOutIndex,
-        unsigned short& result
-)
+static_assert(sizeof(VertexWeldKey) == sizeof(PackedVertex), "Every float of a vertex needs a key value");
+
+static inline VertexWeldKey makeVertexWeldKey(const PackedVertex& vertex, float weldEpsilon)
 {
-    const auto it = VertexToOutIndex.find(packed);
-    if(it == VertexToOutIndex.end())
+    VertexWeldKey key;
+    if(weldEpsilon <= 0.f)
     {
-        return false;
+        memcpy(key.values, &vertex, sizeof(PackedVertex));
+        return key;
     }
-    else
+
+    float floats[8];
+    memcpy(floats, &vertex, sizeof(PackedVertex));
+    for(int i = 0; i < 8; i++)
     {
-        result = it->second;
-        return true;
+        const auto cell = int32_t(std::lround(floats[i] / weldEpsilon));
+        memcpy(&key.values[i], &cell, sizeof(int32_t));
     }
+    return key;
 }
 
-void indexVBO(
+/**
+ * @brief Open addressing hash set of unique vertices, used to weld identical vertices while indexing.
+ * The slots are sized once up front, inserting never allocates.
+ */
+class VertexWeldTable
+{
+    public:
+        /**
+         * @param maxVertexCount The maximum amount of unique vertices that will be inserted.
+         */
+        explicit VertexWeldTable(size_t maxVertexCount)
+        {
+            size_t capacity = 16;
+            while(capacity < maxVertexCount * 2)
+            {
+                capacity *= 2;
+            }
+
+            m_mask = capacity - 1;
+            m_slots.assign(capacity, EMPTY_SLOT);
+            m_keys.reserve(maxVertexCount);
+        }
+
+        /**
+         * Looks up a vertex and inserts it if it isn't in the table yet.
+         *
+         * @param key The weld key of the vertex.
+         * @param index Receives the index of the unique vertex.
+         * @return True if the vertex was inserted, false if it was already in the table.
+         */
+        bool insert(const VertexWeldKey& key, uint32_t& index)
+        {
+            size_t slot = size_t(Engine::hashBytes(key.values, sizeof(key.values))) & m_mask;
+            while(m_slots[slot] != EMPTY_SLOT)
+            {
+                if(m_keys[m_slots[slot]] == key)
+                {
+                    index = m_slots[slot];
+                    return false;
+                }
+                slot = (slot + 1) & m_mask;
+            }
+
+            index = uint32_t(m_keys.size());
+            m_slots[slot] = index;
+            m_keys.push_back(key);
+            return true;
+        }
+
+    private:
+        static constexpr uint32_t EMPTY_SLOT = UINT32_MAX;
+
+        std::vector<uint32_t> m_slots;
+        std::vector<VertexWeldKey> m_keys;
+        size_t m_mask;
+};
+
+/**
+ * Merges identical vertices of a triangle list and replaces it by an indexed triangle list.
+ *
+ * @param in_vertices The vertex positions, three per triangle. Receives the unique positions.
+ * @param in_uvs The texture coordinates, may be empty. Receives the unique texture coordinates.
+ * @param in_normals The normals, may be empty. Receives the unique normals.
+ * @param in_indices Receives the triangles indexing the unique vertices.
+ * @param weldEpsilon If greater than zero, vertices whose attributes all round to the same multiple of
+ * weldEpsilon are merged as well. Otherwise only bitwise identical vertices are merged.
+ */
+static void indexVBO(
         std::vector<glm::vec3>& in_vertices,
         std::vector<glm::vec2>& in_uvs,
         std::vector<glm::vec3>& in_normals,
-        std::vector<triData>& in_indices
+        std::vector<triData>& in_indices,
+        float weldEpsilon = 0.f
 )
 {
-    std::map<PackedVertex, unsigned short> VertexToOutIndex;
+    VertexWeldTable weldTable(in_vertices.size());
     std::vector<triData> out_indices(in_vertices.size() / 3);
     std::vector<glm::vec3> out_vertices;
     std::vector<glm::vec2> out_uvs;
     std::vector<glm::vec3> out_normals;
+    out_vertices.reserve(in_vertices.size());
+    out_uvs.reserve(in_vertices.size());
+    out_normals.reserve(in_vertices.size());
 
     // For each input vertex
     for(unsigned int i = 0; i < in_vertices.size(); i++)
     {
-        const unsigned short tupleIndex = i / 3;
-        const unsigned short valueIndex = i % 3;
 
         PackedVertex packed = { in_vertices[i],
                                 (i < in_uvs.size() ? in_uvs[i] : glm::vec2(0.f)),
                                 (i < in_normals.size() ? in_normals[i] : glm::vec3(0.f)) };
 
-        // Try to find a similar vertex in out_XXXX
-        unsigned short index;
-        bool found = getSimilarVertexIndex_fast(packed, VertexToOutIndex, index);
-
-        if(found)
-        { // A similar vertex is already in the VBO, use it instead !
-            writeToTuple(out_indices[tupleIndex], valueIndex, index);
-        }
-        else
-        { // If not, it needs to be added in the output data.
-            out_vertices.push_back(in_vertices[i]);
-            out_uvs.push_back(i < in_uvs.size() ? in_uvs[i] : glm::vec2(0.f));
-            out_normals.push_back(i < in_normals.size() ? in_normals[i] : glm::vec3(0.f));
-            unsigned short newindex = (unsigned short)out_vertices.size() - 1;
-            writeToTuple(out_indices[tupleIndex], valueIndex, newindex);
-            VertexToOutIndex[packed] = newindex;
+        uint32_t index;
+        if(weldTable.insert(makeVertexWeldKey(packed, weldEpsilon), index))
+        { // Not seen yet, it needs to be added in the output data.
+            out_vertices.push_back(packed.position);
+            out_uvs.push_back(packed.uv);
+            out_normals.push_back(packed.normal);
         }
+
+        out_indices[i / 3][i % 3] = index;
     }
 
     in_vertices.swap(out_vertices);
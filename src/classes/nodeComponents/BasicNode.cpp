@@ -2,6 +2,7 @@
 
 #include "../engine/EngineManager.h"
 #include "GeometryComponent.h"
+#include "LightComponent.h"
 #include "UiDebugWindow.h"
 
 #include <iostream>
@@ -33,6 +34,12 @@ namespace Engine
         {
             SingletonManager::get<EngineManager>()->removeDebugUiFromScene(debugUi->getNodeId());
         }
+
+        // Lights may also be geometry, like a lamp drawing its bulb
+        if(std::dynamic_pointer_cast<LightComponent>(thisNode))
+        {
+            SingletonManager::get<EngineManager>()->removeLightFromScene(getNodeId());
+        }
     }
 
     std::shared_ptr<BasicNode> BasicNode::getChildNode(int pos) const
@@ -58,6 +65,11 @@ namespace Engine
             SingletonManager::get<EngineManager>()->addDebugUiToScene(debugUi);
         }
 
+        if(auto light = std::dynamic_pointer_cast<LightComponent>(node))
+        {
+            SingletonManager::get<EngineManager>()->addLightToScene(light);
+        }
+
         node->start();
 
         if(!node->getName().empty())
@@ -97,7 +109,11 @@ namespace Engine
         {
             const auto& engineManager = SingletonManager::get<EngineManager>();
             child->callOnAllChildrenRecursiveAndSelf(
-                    [engineManager](BasicNode* node) -> void { engineManager->removeGeometryFromScene(node); }
+                    [engineManager](BasicNode* node) -> void
+                    {
+                        engineManager->removeGeometryFromScene(node);
+                        engineManager->removeLightFromScene(node);
+                    }
             );
             child->cleanupNode();
             child->setParent(nullptr);
@@ -112,7 +128,11 @@ namespace Engine
     {
         const auto& engineManager = SingletonManager::get<EngineManager>();
         callOnAllChildrenRecursiveAndSelf(
-                [engineManager](BasicNode* node) -> void { engineManager->removeGeometryFromScene(node); }
+                [engineManager](BasicNode* node) -> void
+                {
+                    engineManager->removeGeometryFromScene(node);
+                    engineManager->removeLightFromScene(node);
+                }
         );
         setParent(nullptr);
     }
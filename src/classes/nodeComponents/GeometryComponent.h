@@ -3,6 +3,9 @@
 #include "../engine/EngineManager.h"
 #include "../engine/rendering/RenderManager.h"
 #include "../helper/ObjectData.h"
+#include "../helper/TextureAtlas.h"
+#include "../helper/TextureData.h"
+#include "../helper/TriangleOrderHelper.h"
 #include "BasicNode.h"
 #include "CameraComponent.h"
 
@@ -26,15 +29,24 @@ namespace Engine
                 : m_objectData(nullptr)
                 , m_shader(nullptr)
                 , m_textureBuffer(0)
+                , m_texture(nullptr)
                 , m_tint(glm::vec4(1.f, 1.f, 1.f, 1.f))
                 , m_isTranslucent(false)
+                , m_usesTriangleOrders(false)
                 , m_customIndexBuffer(0)
                 , m_customVertexIndices(std::vector<triData>())
+                , m_triangleOrderIndex(0)
             {
                 setIsTranslucent(m_tint.w < 1.f);
             }
 
-            ~GeometryComponent() = default;
+            ~GeometryComponent()
+            {
+                if(m_customIndexBuffer != 0)
+                {
+                    glDeleteBuffers(1, &m_customIndexBuffer);
+                }
+            }
 
             /**
              * @brief Get the tint color of the geometry.
@@ -68,13 +80,64 @@ namespace Engine
              * @brief Get the texture buffer ID associated with the geometry.
              * @return The texture buffer ID as a GLuint.
              */
-            GLuint getTextureBuffer() const { return m_textureBuffer; };
+            GLuint getTextureBuffer() const { return m_texture ? m_texture->m_textureId : m_textureBuffer; };
 
             /**
              * @brief Set the texture buffer ID for the geometry.
              * @param buffer The texture buffer ID as a GLuint.
              */
-            void setTextureBuffer(GLuint buffer) { m_textureBuffer = buffer; };
+            void setTextureBuffer(GLuint buffer)
+            {
+                m_textureBuffer = buffer;
+                m_texture = nullptr;
+                m_textureRegion = TextureRegion();
+            };
+
+            /**
+             * @brief Get the texture set with setTexture.
+             * @return A handle of the texture, nullptr if the geometry uses a raw texture buffer.
+             */
+            TextureHandle getTexture() const { return m_texture; };
+
+            /**
+             * @brief Set a texture that might still be loading, see RenderManager::registerTextureAsync.
+             * @param texture A handle of the texture.
+             */
+            void setTexture(TextureHandle texture)
+            {
+                m_texture = std::move(texture);
+                m_textureRegion = TextureRegion();
+            };
+
+            /**
+             * @brief Use the region of a file in an atlas or texture array built by the RenderManager.
+             * Geometry sharing the atlas binds the same texture.
+             * @param atlas The atlas, see RenderManager::buildTextureAtlas and buildTextureArray.
+             * @param filePath The path of the packed file, the whole texture is used if it isn't in the
+             * atlas.
+             */
+            void setTexture(const TextureAtlas& atlas, const std::string& filePath)
+            {
+                const auto region = atlas.regions.find(filePath);
+                m_texture = atlas.texture;
+                m_textureRegion = region != atlas.regions.end() ? region->second : TextureRegion();
+            };
+
+            /**
+             * @brief Get the part of the texture the texture coordinates of the geometry are mapped into.
+             * @return The region, covering the whole texture unless an atlas is used.
+             */
+            const TextureRegion& getTextureRegion() const { return m_textureRegion; };
+
+            /**
+             * @brief Get wether the mesh and texture of the geometry have finished loading.
+             * @return A boolean, the geometry isn't drawn while false.
+             */
+            bool isResident() const
+            {
+                const bool objectResident = !m_objectData || m_objectData->m_isResident;
+                return objectResident && (!m_texture || m_texture->m_isResident);
+            };
 
             /**
              * @brief Get the shader used for rendering the geometry.
@@ -100,14 +163,61 @@ namespace Engine
              */
             void setIsTranslucent(bool isTranslucent) { m_isTranslucent = isTranslucent; }
 
+            /**
+             * @brief Get wether translucent geometry requests precomputed triangle orders for its mesh.
+             * @return A boolean indicating if the orders are used.
+             */
+            bool getUsesTriangleOrders() const { return m_usesTriangleOrders; };
+
+            /**
+             * @brief Opts geometry whose mesh never deforms into precomputed triangle orders, see
+             * RenderManager::bakeTriangleOrders. They take 96 times the index memory of the mesh, so the
+             * triangles are sorted every frame by default.
+             * @param usesTriangleOrders A boolean setting if the orders are used.
+             */
+            void setUsesTriangleOrders(bool usesTriangleOrders) { m_usesTriangleOrders = usesTriangleOrders; }
+
+            /**
+             * @brief Get wether drawing the geometry reads the CPU positions of its mesh.
+             * @return True for translucent geometry that sorts its triangles at runtime.
+             */
+            bool needsMeshPositions() const
+            {
+                return m_isTranslucent && m_objectData && !m_objectData->hasTriangleOrders();
+            }
+
+            /**
+             * @brief Orders the triangles back to front as seen from the active camera.
+             *
+             * Objects with precomputed triangle orders only pick the order closest to the current view direction,
+             * all other objects get their triangles sorted and uploaded again.
+             */
             void depthSortTriangles()
             {
+                const auto& cameraPos = SingletonManager::get<EngineManager>()->getCamera()->getGlobalPosition();
+
+                if(m_objectData->hasTriangleOrders())
+                {
+                    const glm::mat4 worldToLocal = glm::inverse(getGlobalModelMatrix());
+                    const glm::vec3 localCameraPos = worldToLocal * glm::vec4(cameraPos, 1.f);
+                    m_triangleOrderIndex = getTriangleOrderIndex(
+                            localCameraPos - m_objectData->m_triangleOrderCenter,
+                            m_objectData->m_triangleOrderResolution
+                    );
+                    return;
+                }
+
+                // Released positions are being restored, the last order is drawn until they're back
+                if(!m_objectData->hasPositions())
+                {
+                    return;
+                }
+
                 if(m_customVertexIndices.empty())
                 {
                     m_customVertexIndices = m_objectData->m_vertexIndices;
                 }
 
-                const auto& cameraPos = SingletonManager::get<EngineManager>()->getCamera()->getGlobalPosition();
                 const auto& nodePos = getGlobalPosition();
                 const auto& vertices = m_objectData->m_vertexData;
 
@@ -118,7 +228,9 @@ namespace Engine
                         { return depthSortTrianglesAlgorithm(cameraPos, nodePos, vertices, a, b); }
                 );
 
-                unsigned int dataSize = m_customVertexIndices.size() * sizeof(triData);
+                packIndices(m_customVertexIndices, m_objectData->m_indexWidth, m_customIndexData);
+
+                unsigned int dataSize = m_customIndexData.size();
                 if(m_customIndexBuffer == 0)
                 {
                     // Generate a buffer with our identifier
@@ -126,13 +238,13 @@ namespace Engine
                     glBindBuffer(GL_ARRAY_BUFFER, m_customIndexBuffer);
 
                     // Give vertices to OpenGL
-                    glBufferData(GL_ARRAY_BUFFER, dataSize, &m_customVertexIndices[0], GL_STATIC_DRAW);
+                    glBufferData(GL_ARRAY_BUFFER, dataSize, &m_customIndexData[0], GL_STATIC_DRAW);
                 }
                 else
                 {
                     glBindBuffer(GL_ARRAY_BUFFER, m_customIndexBuffer);
                     // Give vertices to OpenGL
-                    glBufferData(GL_ARRAY_BUFFER, dataSize, &m_customVertexIndices[0], GL_STATIC_DRAW);
+                    glBufferData(GL_ARRAY_BUFFER, dataSize, &m_customIndexData[0], GL_STATIC_DRAW);
                 }
                 // glFinish();
             }
@@ -145,21 +257,47 @@ namespace Engine
             {
                 if(m_isTranslucent)
                 {
+                    if(m_objectData && m_objectData->hasTriangleOrders())
+                    {
+                        return m_objectData->m_triangleOrderBuffer;
+                    }
+
                     return m_customIndexBuffer;
                 }
 
                 return m_objectData ? m_objectData->m_indexBuffer : 0;
             };
 
+            /**
+             * @brief Gets the byte offset of the triangles to draw inside the index buffer.
+             * @return size_t
+             */
+            size_t getIndexBufferOffset() const
+            {
+                if(m_isTranslucent && m_objectData && m_objectData->hasTriangleOrders())
+                {
+                    const size_t triangleSize = 3 * m_objectData->m_indexWidth;
+                    const size_t orderSize = m_objectData->m_triangleCount * triangleSize;
+                    return size_t(m_triangleOrderIndex) * orderSize;
+                }
+
+                return 0;
+            };
+
         private:
             std::shared_ptr<ObjectData> m_objectData;
             std::shared_ptr<Shader> m_shader;
             GLuint m_textureBuffer;
+            TextureHandle m_texture;
+            TextureRegion m_textureRegion;
             glm::vec4 m_tint;
             bool m_isTranslucent;
+            bool m_usesTriangleOrders;
 
             GLuint m_customIndexBuffer;
             std::vector<triData> m_customVertexIndices;
+            std::vector<uint8_t> m_customIndexData;
+            int m_triangleOrderIndex;
     };
 
 } // namespace Engine
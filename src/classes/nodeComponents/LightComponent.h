@@ -0,0 +1,91 @@
+#pragma once
+
+#include "BasicNode.h"
+
+#include <algorithm>
+
+#include <glm/vec3.hpp>
+
+namespace Engine
+{
+    enum LightType
+    {
+        LIGHT_POINT = 0,
+        LIGHT_SPOT = 1
+    };
+
+    /**
+     * @brief The LightComponent class represents a point or spot light that can be attached to a node in the
+     * engine.
+     * Lights in the scene are assigned to the clusters of the view frustum each frame,
+     * every fragment only evaluates the lights of its cluster.
+     * A spot light shines along the node's forward direction.
+     */
+    class LightComponent : virtual public BasicNode
+    {
+        public:
+            explicit LightComponent()
+                : m_type(LIGHT_POINT)
+                , m_color(glm::vec3(1.f))
+                , m_intensity(1.f)
+                , m_range(10.f)
+                , m_innerAngle(20.f)
+                , m_outerAngle(30.f)
+                , m_isActive(true)
+            {
+            }
+
+            ~LightComponent() = default;
+
+            LightType getLightType() const { return m_type; };
+
+            void setLightType(LightType type) { m_type = type; };
+
+            glm::vec3 getColor() const { return m_color; };
+
+            void setColor(glm::vec3 color) { m_color = color; };
+
+            float getIntensity() const { return m_intensity; };
+
+            void setIntensity(float intensity) { m_intensity = intensity; };
+
+            /**
+             * @return The distance the light fades out at, it doesn't reach any further
+             */
+            float getRange() const { return m_range; };
+
+            void setRange(float range) { m_range = std::max(range, 0.f); };
+
+            /**
+             * @return The angle in degrees between the spot light's direction and where it starts to fade out
+             */
+            float getInnerAngle() const { return m_innerAngle; };
+
+            void setInnerAngle(float degrees) { m_innerAngle = std::clamp(degrees, 0.f, m_outerAngle); };
+
+            /**
+             * @return The angle in degrees between the spot light's direction and the edge of its cone
+             */
+            float getOuterAngle() const { return m_outerAngle; };
+
+            void setOuterAngle(float degrees)
+            {
+                m_outerAngle = std::clamp(degrees, 0.f, 89.f);
+                m_innerAngle = std::min(m_innerAngle, m_outerAngle);
+            };
+
+            bool isActive() const { return m_isActive; };
+
+            void setIsActive(bool isActive) { m_isActive = isActive; };
+
+        private:
+            LightType m_type;
+            glm::vec3 m_color;
+            float m_intensity;
+            float m_range;
+            float m_innerAngle;
+            float m_outerAngle;
+            bool m_isActive;
+    };
+
+} // namespace Engine
@@ -0,0 +1,135 @@
+#include "AssetMemoryDebugWindow.h"
+
+#include "../engine/EngineManager.h"
+#include "../engine/rendering/RenderManager.h"
+#include "../uiElements/UiElementSeperator.h"
+#include "../uiElements/UiElementSlider.h"
+#include "../uiElements/UiElementText.h"
+
+#include <cstdio>
+#include <string>
+
+#include <GLFW/glfw3.h>
+
+using namespace Engine::Ui;
+
+static constexpr size_t BYTES_PER_MEGABYTE = 1024 * 1024;
+
+static std::string formatAssetText(
+        const std::string& filePath,
+        bool isResident,
+        bool isLoading,
+        bool loadFailed,
+        size_t gpuBytes,
+        size_t cpuBytes
+)
+{
+    const char* state = "evicted";
+    if(isResident)
+    {
+        state = "resident";
+    }
+    else if(isLoading)
+    {
+        state = "loading";
+    }
+    else if(loadFailed)
+    {
+        state = "failed";
+    }
+    char text[96];
+    snprintf(
+            text,
+            sizeof(text),
+            "%-8s GPU %8.1f KB  CPU %8.1f KB  ",
+            state,
+            double(gpuBytes) / 1024.0,
+            double(cpuBytes) / 1024.0
+    );
+    return text + filePath;
+}
+
+AssetMemoryDebugWindow::AssetMemoryDebugWindow()
+{
+    addWindowFlag(ImGuiWindowFlags_AlwaysAutoResize);
+
+    setIsWindowClosable(false);
+
+    m_lastTimeStamp = 0.0;
+    m_renderManager = SingletonManager::get<EngineManager>()->getRenderManager();
+
+    setWindowTitle("Asset Memory");
+
+    m_usageText = std::make_shared<UiElementText>("GPU memory: -");
+    addContent(m_usageText);
+
+    const int budget = int(m_renderManager->getGpuMemoryBudget() / BYTES_PER_MEGABYTE);
+    auto budgetSlider = std::make_shared<UiElementSlider<int>>(
+            budget,
+            0,
+            2048,
+            "Budget MB (0 = unlimited)",
+            std::bind(&AssetMemoryDebugWindow::onBudgetChange, this, std::placeholders::_1)
+    );
+    addContent(budgetSlider);
+
+    addContent(std::make_shared<UiElementSeparator>("Assets"));
+}
+
+void AssetMemoryDebugWindow::update()
+{
+    if(glfwGetTime() - m_lastTimeStamp >= 0.5)
+    {
+        updateAssetList();
+        m_lastTimeStamp = glfwGetTime();
+    }
+}
+
+void AssetMemoryDebugWindow::onBudgetChange(int megabytes)
+{
+    m_renderManager->setGpuMemoryBudget(size_t(megabytes) * BYTES_PER_MEGABYTE);
+}
+
+void AssetMemoryDebugWindow::updateAssetList()
+{
+    const double usage = double(m_renderManager->getGpuMemoryUsage()) / double(BYTES_PER_MEGABYTE);
+    const double budget = double(m_renderManager->getGpuMemoryBudget()) / double(BYTES_PER_MEGABYTE);
+    char usageText[64];
+    snprintf(usageText, sizeof(usageText), "GPU memory: %.2f MB / %.0f MB", usage, budget);
+    m_usageText->setText(usageText);
+
+    for(const auto& text : m_assetTexts)
+    {
+        removeContent(text);
+    }
+    m_assetTexts.clear();
+
+    for(const auto& object : m_renderManager->getObjects())
+    {
+        m_assetTexts.push_back(std::make_shared<UiElementText>(formatAssetText(
+                object->m_filePath,
+                object->m_isResident,
+                object->m_isLoading,
+                object->m_loadFailed,
+                object->m_gpuBytes,
+                object->getCpuBytes()
+        )));
+    }
+
+    for(const auto& texture : m_renderManager->getTextures())
+    {
+        m_assetTexts.push_back(std::make_shared<UiElementText>(formatAssetText(
+                texture->m_filePath,
+                texture->m_isResident,
+                texture->m_isLoading,
+                texture->m_loadFailed,
+                texture->m_gpuBytes,
+                0
+        )));
+    }
+
+    for(const auto& text : m_assetTexts)
+    {
+        addContent(text);
+    }
+}
@@ -0,0 +1,31 @@
+#pragma once
+
+#include "../nodeComponents/UiDebugWindow.h"
+
+namespace Engine
+{
+    class RenderManager;
+
+    namespace Ui
+    {
+        class UiElementText;
+
+        class AssetMemoryDebugWindow : public UiDebugWindow
+        {
+            public:
+                AssetMemoryDebugWindow();
+                ~AssetMemoryDebugWindow() = default;
+
+                void update() override;
+
+            private:
+                void onBudgetChange(int megabytes);
+                void updateAssetList();
+
+                std::shared_ptr<RenderManager> m_renderManager;
+                std::shared_ptr<UiElementText> m_usageText;
+                std::vector<std::shared_ptr<UiElementText>> m_assetTexts;
+                double m_lastTimeStamp;
+        };
+    } // namespace Ui
+} // namespace Engine
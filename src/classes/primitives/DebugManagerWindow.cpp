@@ -6,6 +6,7 @@
 #include "../uiElements/UiElementPlot.h"
 #include "../uiElements/UiElementRadio.h"
 #include "../uiElements/UiElementText.h"
+#include "AssetMemoryDebugWindow.h"
 #include "PerformanceDebugWindow.h"
 #include "SceneSettingsDebugWindow.h"
 
@@ -30,6 +31,13 @@ DebugManagerWindow::DebugManagerWindow()
             std::bind(&DebugManagerWindow::onSceneSettingsWindowRadioClick, this, std::placeholders::_1)
     );
     addContent(m_sceneSettingsWindowRadio);
+
+    m_assetMemoryWindowRadio = std::make_shared<UiElementRadio>(
+            false,
+            "Asset Memory",
+            std::bind(&DebugManagerWindow::onAssetMemoryWindowRadioClick, this, std::placeholders::_1)
+    );
+    addContent(m_assetMemoryWindowRadio);
 }
 
 void DebugManagerWindow::update() {}
@@ -61,3 +69,17 @@ void DebugManagerWindow::onSceneSettingsWindowRadioClick(bool newValue)
         m_sceneSettingsWindow = nullptr;
     }
 }
+
+void DebugManagerWindow::onAssetMemoryWindowRadioClick(bool newValue)
+{
+    if(newValue)
+    {
+        m_assetMemoryWindow = std::make_shared<AssetMemoryDebugWindow>();
+        addChild(m_assetMemoryWindow);
+    }
+    else
+    {
+        deleteChild(m_assetMemoryWindow);
+        m_assetMemoryWindow = nullptr;
+    }
+}
\ No newline at end of file
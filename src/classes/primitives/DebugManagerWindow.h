@@ -4,6 +4,7 @@
 
 namespace Engine::Ui
 {
+    class AssetMemoryDebugWindow;
     class PerformanceDebugWindow;
     class SceneSettingsDebugWindow;
     class UiElementRadio;
@@ -24,5 +25,9 @@ namespace Engine::Ui
             void onSceneSettingsWindowRadioClick(bool newValue);
             std::shared_ptr<SceneSettingsDebugWindow> m_sceneSettingsWindow;
             std::shared_ptr<UiElementRadio> m_sceneSettingsWindowRadio;
+
+            void onAssetMemoryWindowRadioClick(bool newValue);
+            std::shared_ptr<AssetMemoryDebugWindow> m_assetMemoryWindow;
+            std::shared_ptr<UiElementRadio> m_assetMemoryWindowRadio;
     };
 } // namespace Engine::Ui
\ No newline at end of file
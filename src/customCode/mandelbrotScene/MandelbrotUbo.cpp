@@ -3,7 +3,7 @@
 
 MandelbrotUbo::MandelbrotUbo() : m_iterations(300), m_zoom(400), m_screenSize(1200, 600), m_offset(0, 0)
 {
-    setSize(24);
+    setSize(sizeof(MandelbrotBlock));
     setBindingPoint({ "MandelbrotBlock", 5 });
 
     setupUbo();
@@ -11,10 +11,10 @@ MandelbrotUbo::MandelbrotUbo() : m_iterations(300), m_zoom(400), m_screenSize(12
 
 void MandelbrotUbo::UpdateUbo()
 {
-    LoadVariable(m_iterations, 0);
-    LoadVariable(m_zoom, 4);
-    LoadVariable(m_screenSize, 8);
-    LoadVariable(m_offset, 16);
+    LoadVariable(m_iterations, offsetof(MandelbrotBlock, iterations));
+    LoadVariable(m_zoom, offsetof(MandelbrotBlock, zoom));
+    LoadVariable(m_screenSize, offsetof(MandelbrotBlock, screenSize));
+    LoadVariable(m_offset, offsetof(MandelbrotBlock, offset));
 }
 
 void MandelbrotUbo::resetData()
@@ -30,23 +30,23 @@ void MandelbrotUbo::resetData()
 void MandelbrotUbo::setIterations(int itr)
 {
     m_iterations = itr;
-    LoadVariable(m_iterations, 0);
+    LoadVariable(m_iterations, offsetof(MandelbrotBlock, iterations));
 }
 
 void MandelbrotUbo::setZoom(float zoom)
 {
     m_zoom = zoom;
-    LoadVariable(m_zoom, 4);
+    LoadVariable(m_zoom, offsetof(MandelbrotBlock, zoom));
 }
 
 void MandelbrotUbo::setScreenSize(glm::vec2 screenSize)
 {
     m_screenSize = screenSize;
-    LoadVariable(m_screenSize, 8);
+    LoadVariable(m_screenSize, offsetof(MandelbrotBlock, screenSize));
 }
 
 void MandelbrotUbo::setOffset(glm::vec2 offset)
 {
     m_offset = offset;
-    LoadVariable(m_offset, 16);
+    LoadVariable(m_offset, offsetof(MandelbrotBlock, offset));
 }
@@ -1,8 +1,28 @@
 #include "../../classes/engine/rendering/UboBlock.h"
 #include "../../classes/engine/rendering/lighting/LightingPoints.h"
 
+#include <cstddef>
+#include <cstdint>
+
 #include <glm/vec2.hpp>
 
+/**
+ * std140 layout of the MandelbrotBlock in mandelbrot.frag
+ */
+struct MandelbrotBlock
+{
+        int32_t iterations;
+        float zoom;
+        glm::vec2 screenSize;
+        glm::vec2 offset;
+};
+
+static_assert(offsetof(MandelbrotBlock, iterations) == 0, "MandelbrotBlock doesn't match std140");
+static_assert(offsetof(MandelbrotBlock, zoom) == 4, "MandelbrotBlock doesn't match std140");
+static_assert(offsetof(MandelbrotBlock, screenSize) == 8, "MandelbrotBlock doesn't match std140");
+static_assert(offsetof(MandelbrotBlock, offset) == 16, "MandelbrotBlock doesn't match std140");
+static_assert(sizeof(MandelbrotBlock) == 24, "MandelbrotBlock doesn't match std140");
+
 class MandelbrotUbo : public Engine::UboBlock
 {
     public:
@@ -34,11 +34,11 @@ void TestSceneOrigin::start()
 
     // Tree models normals are broken, causing the model to look bad with translucency
     m_tree = std::make_shared<GeometryComponent>();
-    m_tree->setObjectData(renderManager->registerObject("resources/objects/tree.obj"));
+    m_tree->setObjectData(renderManager->registerObjectAsync("resources/objects/tree.obj"));
     m_tree->setShader(std::make_shared<TextureShader>(renderManager));
     m_tree->setPosition(glm::vec3(0.f, 3.f, 0.f));
     // m_tree->setRotation(glm::vec3(70.f, 0.f, 0.f));
-    m_tree->setTextureBuffer(renderManager->registerTexture("resources/textures/treeTexture.bmp"));
+    m_tree->setTexture(renderManager->registerTextureAsync("resources/textures/treeTexture.bmp"));
     m_tree->setName("tree");
     m_tree->setTint(glm::vec4(1.f, 1.f, 1.f, 1.f));
     addChild(m_tree);
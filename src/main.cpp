@@ -1,24 +1,39 @@
 
 #include "classes/engine/EngineManager.h"
 #include "classes/engine/GameInterface.h"
+#include "classes/engine/StartupTrace.h"
 #include "classes/engine/rendering/RenderManager.h"
 #include "customCode/mandelbrotScene/MandelbrotSceneOrigin.h"
 #include "customCode/testScene/TestSceneOrigin.h"
 #include "customCode/waveFunctionCollapse/WafeFunctionCollapseSceneOrigin.h"
 
+#include <cstdlib>
+
 using namespace Engine;
 
 int main()
 {
     // This file is for showcasing how the engine can be used and is in no way optimized
 
+    // Created first so the start-up trace begins with main, printed once a frame was presented.
+    // Set ENGINE_STARTUP_TRACE to a file path to also export it there.
+    const std::shared_ptr<StartupTrace> startupTrace = SingletonManager::get<StartupTrace>();
+    if(const char* tracePath = std::getenv("ENGINE_STARTUP_TRACE"))
+    {
+        startupTrace->setExportPath(tracePath);
+    }
+
 #ifdef DEBUG
     std::cout << "DEBUG MODE" << std::endl;
 #else
     std::cout << "PROD MODE" << std::endl;
 #endif
 
-    const std::shared_ptr<GameInterface> game = std::make_shared<GameInterface>();
+    // Boot mode: the scene's meshes load on worker threads while the window and GL context are created
+    BootAssets bootAssets;
+    bootAssets.meshes = { "resources/objects/plane.obj" };
+
+    const std::shared_ptr<GameInterface> game = std::make_shared<GameInterface>(bootAssets);
     const std::shared_ptr<EngineManager> engineManager = SingletonManager::get<EngineManager>();
 
     auto& ambientLight = engineManager->getRenderManager()->getAmbientLightUbo();
@@ -5,7 +5,12 @@ using namespace Engine;
 
 ColorShader::ColorShader(const std::shared_ptr<RenderManager>& renderManager)
 {
-    registerShader(renderManager, "resources/shader/color", "color");
+    registerShader(
+            renderManager,
+            "resources/shader/lit",
+            "color",
+            SHADER_FEATURE_VERTEX_COLOR | SHADER_LIGHTING_FEATURES
+    );
 
     bindUbo(renderManager->getAmbientLightUbo());
     bindUbo(renderManager->getDiffuseLightUbo());
@@ -5,7 +5,12 @@ using namespace Engine;
 
 TextureShader::TextureShader(const std::shared_ptr<RenderManager>& renderManager)
 {
-    registerShader(renderManager, "resources/shader/texture", "texture");
+    registerShader(
+            renderManager,
+            "resources/shader/lit",
+            "texture",
+            SHADER_FEATURE_TEXTURE | SHADER_LIGHTING_FEATURES
+    );
 
     bindUbo(renderManager->getAmbientLightUbo());
     bindUbo(renderManager->getDiffuseLightUbo());
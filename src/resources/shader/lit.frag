@@ -0,0 +1,137 @@
+#version 410
+
+// Compiled per permutation, lights that are off aren't part of the program at all
+
+// Input Data
+#if defined(USE_TEXTURE)
+in vec2 UV;
+#elif defined(USE_VERTEX_COLOR)
+in vec4 fragmentColor;
+#endif
+in vec3 normal;
+#ifdef USE_CLUSTERED_LIGHTS
+in vec3 viewPosition;
+in vec3 viewNormal;
+#endif
+// Ouput data
+out vec4 color;
+
+// Per-draw data, written to the uniform ring for every draw
+layout(std140) uniform DrawBlock
+{
+    mat4 MVP;
+    // View space of the clustered lights, including the dequantization of the positions
+    mat4 modelView;
+    // Inverse transpose of the view and model matrix, turning normals into view space
+    mat4 normalMatrix;
+    vec4 tintColor;
+    // Scale in xy and offset in zw mapping the UVs into the geometry's region of a texture atlas
+    vec4 uvTransform;
+    // Normals of compressed vertex formats are octahedral encoded in the x and y components
+    bool useOctNormals;
+    // textureArraySampler is used instead of textureSampler, textureLayer selects the layer
+    bool useTextureArray;
+    float textureLayer;
+};
+
+// Values that stay constant for the whole mesh
+#ifdef USE_TEXTURE
+uniform sampler2D textureSampler;
+uniform sampler2DArray textureArraySampler;
+#endif
+#ifdef USE_AMBIENT_LIGHT
+layout(std140) uniform AmbientLightBlock
+{
+    bool useAmbient;
+    float ambientIntensity;
+    vec3 ambientLightColor;
+};
+#endif
+#ifdef USE_DIFFUSE_LIGHT
+layout(std140) uniform DiffuseLightBlock
+{
+    bool useDiffuse;
+    float diffuseIntensity;
+    vec3 diffuseLightDir;
+    vec3 diffuseLightColor;
+};
+#endif
+#ifdef USE_CLUSTERED_LIGHTS
+// Three texels per light: view position and range, color and cos of the inner angle,
+// view direction and cos of the outer angle, which is -2 for point lights
+uniform samplerBuffer lightData;
+// Offset into clusterLightIndices and light count of every cluster
+uniform usamplerBuffer clusterRanges;
+uniform usamplerBuffer clusterLightIndices;
+layout(std140) uniform ClusterBlock
+{
+    // Clusters along x, y and z, the light count in w
+    ivec4 clusterGrid;
+    // zNear, zFar and the scale and bias turning log(depth) into the slice
+    vec4 clusterDepth;
+    // Size of a tile in pixels in xy, the viewport's origin in zw
+    vec4 clusterTile;
+};
+
+vec3 clusteredLights(vec3 albedo)
+{
+    float depth = max(-viewPosition.z, clusterDepth.x);
+    int slice = int(floor(log(depth) * clusterDepth.z + clusterDepth.w));
+    ivec2 tile = ivec2((gl_FragCoord.xy - clusterTile.zw) / clusterTile.xy);
+    ivec3 cluster = clamp(ivec3(tile, slice), ivec3(0), clusterGrid.xyz - 1);
+    int clusterIndex = cluster.x + clusterGrid.x * (cluster.y + clusterGrid.y * cluster.z);
+    uvec2 range = texelFetch(clusterRanges, clusterIndex).xy;
+
+    vec3 n = normalize(viewNormal);
+    vec3 result = vec3(0.0);
+    for(uint i = 0u; i < range.y; i++)
+    {
+        int light = int(texelFetch(clusterLightIndices, int(range.x + i)).x) * 3;
+        vec4 positionRange = texelFetch(lightData, light);
+        vec4 colorInner = texelFetch(lightData, light + 1);
+        vec4 directionOuter = texelFetch(lightData, light + 2);
+
+        vec3 toLight = positionRange.xyz - viewPosition;
+        float distanceSquared = dot(toLight, toLight);
+        vec3 l = toLight * inversesqrt(max(distanceSquared, 0.0001));
+
+        // Inverse square falloff, faded to zero at the light's range
+        float fade = clamp(1.0 - pow(distanceSquared / (positionRange.w * positionRange.w), 2.0), 0.0, 1.0);
+        float attenuation = fade * fade / (distanceSquared + 1.0);
+        if(directionOuter.w > -1.5)
+        {
+            attenuation *= smoothstep(directionOuter.w, colorInner.w, dot(-l, directionOuter.xyz));
+        }
+
+        result += albedo * colorInner.rgb * max(dot(n, l), 0.0) * attenuation;
+    }
+    return result;
+}
+#endif
+
+void main()
+{
+#if defined(USE_TEXTURE)
+    vec4 sampledColor = useTextureArray ? texture(textureArraySampler, vec3(UV, textureLayer))
+                                        : texture(textureSampler, UV);
+    vec4 baseColor = vec4(sampledColor.rgb, 1) * tintColor;
+#elif defined(USE_VERTEX_COLOR)
+    vec4 baseColor = fragmentColor * tintColor;
+#else
+    vec4 baseColor = tintColor;
+#endif
+
+    vec3 litColor = vec3(0.0, 0.0, 0.0);
+#ifdef USE_AMBIENT_LIGHT
+    litColor += baseColor.xyz * ambientLightColor * ambientIntensity;
+#endif
+#ifdef USE_DIFFUSE_LIGHT
+    float diffuse = max(dot(normalize(normal), normalize(diffuseLightDir)), 0.0);
+    litColor += baseColor.xyz * diffuseLightColor * diffuse * diffuseIntensity;
+#endif
+#ifdef USE_CLUSTERED_LIGHTS
+    litColor += clusteredLights(baseColor.xyz);
+#endif
+
+    color = vec4(litColor, baseColor.w);
+}
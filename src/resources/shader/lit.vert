@@ -0,0 +1,70 @@
+#version 410
+
+// Compiled per permutation, USE_TEXTURE and USE_VERTEX_COLOR select what location 1 holds
+
+// Input vertex data, different for all executions of this shader
+layout(location = 0) in vec3 vertexPosition_modelspace;
+#if defined(USE_TEXTURE)
+layout(location = 1) in vec2 vertexUV;
+#elif defined(USE_VERTEX_COLOR)
+layout(location = 1) in vec4 vertexColor;
+#endif
+layout(location = 2) in vec3 vertexNormal;
+
+// Per-draw data, written to the uniform ring for every draw
+layout(std140) uniform DrawBlock
+{
+    mat4 MVP;
+    // View space of the clustered lights, including the dequantization of the positions
+    mat4 modelView;
+    // Inverse transpose of the view and model matrix, turning normals into view space
+    mat4 normalMatrix;
+    vec4 tintColor;
+    // Scale in xy and offset in zw mapping the UVs into the geometry's region of a texture atlas
+    vec4 uvTransform;
+    // Normals of compressed vertex formats are octahedral encoded in the x and y components
+    bool useOctNormals;
+    // textureArraySampler is used instead of textureSampler, textureLayer selects the layer
+    bool useTextureArray;
+    float textureLayer;
+};
+
+// Output data ; will be interpolated for each fragment.
+#if defined(USE_TEXTURE)
+out vec2 UV;
+#elif defined(USE_VERTEX_COLOR)
+out vec4 fragmentColor;
+#endif
+out vec3 normal;
+#ifdef USE_CLUSTERED_LIGHTS
+out vec3 viewPosition;
+out vec3 viewNormal;
+#endif
+
+vec3 decodeOctNormal(vec2 encoded)
+{
+    vec3 n = vec3(encoded, 1.0 - abs(encoded.x) - abs(encoded.y));
+    if(n.z < 0.0)
+    {
+        vec2 signs = vec2(encoded.x >= 0.0 ? 1.0 : -1.0, encoded.y >= 0.0 ? 1.0 : -1.0);
+        n.xy = (1.0 - abs(encoded.yx)) * signs;
+    }
+    return normalize(n);
+}
+
+void main()
+{
+    // Output position of the vertex, in clip space : MVP * position
+    gl_Position = MVP * vec4(vertexPosition_modelspace, 1);
+
+#if defined(USE_TEXTURE)
+    UV = vertexUV * uvTransform.xy + uvTransform.zw;
+#elif defined(USE_VERTEX_COLOR)
+    fragmentColor = vertexColor;
+#endif
+    normal = useOctNormals ? decodeOctNormal(vertexNormal.xy) : vertexNormal;
+#ifdef USE_CLUSTERED_LIGHTS
+    viewPosition = (modelView * vec4(vertexPosition_modelspace, 1)).xyz;
+    viewNormal = mat3(normalMatrix) * normal;
+#endif
+}
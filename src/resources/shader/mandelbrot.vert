@@ -3,8 +3,23 @@
 // Input vertex data, different for all executions of this shader
 layout(location = 0) in vec3 vertexPosition_modelspace;
 
-// Values that stay constant for the whole mesh.
-uniform mat4 MVP;
+// Per-draw data, written to the uniform ring for every draw
+layout(std140) uniform DrawBlock
+{
+    mat4 MVP;
+    // View space of the clustered lights, including the dequantization of the positions
+    mat4 modelView;
+    // Inverse transpose of the view and model matrix, turning normals into view space
+    mat4 normalMatrix;
+    vec4 tintColor;
+    // Scale in xy and offset in zw mapping the UVs into the geometry's region of a texture atlas
+    vec4 uvTransform;
+    // Normals of compressed vertex formats are octahedral encoded in the x and y components
+    bool useOctNormals;
+    // textureArraySampler is used instead of textureSampler, textureLayer selects the layer
+    bool useTextureArray;
+    float textureLayer;
+};
 
 void main()
 {
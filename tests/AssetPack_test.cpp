@@ -0,0 +1,97 @@
+#include <gtest/gtest.h>
+
+#include "../src/classes/helper/AssetFile.h"
+#include "../src/classes/helper/AssetPack.h"
+
+#include <cstdio>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace Engine;
+
+static std::string writeTestFile(const std::string& name, const std::string& content)
+{
+    const std::string filePath = (std::filesystem::temp_directory_path() / name).string();
+    FILE* file = fopen(filePath.c_str(), "wb");
+    fwrite(content.data(), 1, content.size(), file);
+    fclose(file);
+    return filePath;
+}
+
+TEST(AssetPackSuite, Lz4RoundTrip)
+{
+    std::vector<uint8_t> data;
+    for(int i = 0; i < 5000; i++)
+    {
+        // Runs, repeated phrases and some noise, matches overlap the bytes they produce
+        data.push_back(i % 700 < 300 ? uint8_t('a') : uint8_t("vertex normal uv "[i % 17]));
+        if(i % 97 == 0)
+        {
+            data.push_back(uint8_t(i * 31));
+        }
+    }
+
+    std::vector<uint8_t> compressed;
+    compressLz4(data.data(), data.size(), compressed);
+    EXPECT_LT(compressed.size(), data.size() / 4);
+
+    std::vector<uint8_t> decompressed(data.size());
+    ASSERT_TRUE(decompressLz4(compressed.data(), compressed.size(), decompressed.data(), data.size()));
+    EXPECT_EQ(decompressed, data);
+
+    // Sizes below the minimum match distance are stored as literals only
+    const uint8_t tiny[3] = { 1, 2, 3 };
+    compressLz4(tiny, sizeof(tiny), compressed);
+    uint8_t tinyOut[3];
+    ASSERT_TRUE(decompressLz4(compressed.data(), compressed.size(), tinyOut, sizeof(tinyOut)));
+    EXPECT_EQ(tinyOut[2], 3);
+
+    EXPECT_FALSE(decompressLz4(compressed.data(), compressed.size(), tinyOut, 2));
+}
+
+TEST(AssetPackSuite, FindsAndReadsEntries)
+{
+    const std::string text(4096, 'x');
+    std::string noise;
+    for(int i = 0; i < 257; i++)
+    {
+        noise.push_back(char((i * 7919 + 13) % 251));
+    }
+
+    const std::vector<AssetPackSource> sources = {
+        { "resources/shader/test.vert", writeTestFile("assetPackText.vert", text) },
+        { "./resources/textures/noise.bin", writeTestFile("assetPackNoise.bin", noise) },
+    };
+    const std::string packPath = (std::filesystem::temp_directory_path() / "assetPackTest.pack").string();
+    ASSERT_TRUE(writeAssetPack(packPath.c_str(), sources));
+
+    AssetPack pack;
+    ASSERT_TRUE(pack.open(packPath.c_str()));
+    EXPECT_EQ(pack.getEntryCount(), 2u);
+
+    const AssetPackEntry* textEntry = pack.find("resources/shader/test.vert");
+    ASSERT_NE(textEntry, nullptr);
+    EXPECT_TRUE(textEntry->flags & ASSET_PACK_FLAG_LZ4);
+    EXPECT_LT(textEntry->storedSize, text.size());
+
+    const AssetPackEntry* noiseEntry = pack.find("./resources/textures/noise.bin");
+    ASSERT_NE(noiseEntry, nullptr);
+    EXPECT_FALSE(noiseEntry->flags & ASSET_PACK_FLAG_LZ4);
+    EXPECT_EQ(noiseEntry->offset % ASSET_PACK_ALIGNMENT, 0u);
+    EXPECT_EQ(pack.find("resources/shader/missing.vert"), nullptr);
+
+    std::vector<char> data;
+    ASSERT_TRUE(pack.read(*textEntry, data));
+    EXPECT_EQ(std::string(data.begin(), data.end()), text);
+
+    // Mounted packs are searched before the filesystem
+    ASSERT_TRUE(AssetPack::mount(packPath.c_str()));
+    AssetFile file("resources/textures/noise.bin");
+    ASSERT_TRUE(file.isOpen());
+    EXPECT_EQ(std::string(file.data(), file.size()), noise);
+    AssetPack::unmountAll();
+    EXPECT_FALSE(AssetFile("resources/textures/noise.bin").isOpen());
+
+    std::filesystem::remove(packPath);
+}
@@ -0,0 +1,140 @@
+#include <gtest/gtest.h>
+
+#include "../src/classes/helper/BlockCompression.h"
+
+#include <vector>
+
+using namespace Engine;
+
+static void decodeColorBlock(const uint8_t* block, uint8_t* texels)
+{
+    int palette[4][3];
+    unpackColor565(uint16_t(block[0] | (block[1] << 8)), palette[0]);
+    unpackColor565(uint16_t(block[2] | (block[3] << 8)), palette[1]);
+    for(int channel = 0; channel < 3; channel++)
+    {
+        palette[2][channel] = (2 * palette[0][channel] + palette[1][channel]) / 3;
+        palette[3][channel] = (palette[0][channel] + 2 * palette[1][channel]) / 3;
+    }
+
+    const uint32_t indices = block[4] | (block[5] << 8) | (block[6] << 16) | (uint32_t(block[7]) << 24);
+    for(int texel = 0; texel < 16; texel++)
+    {
+        const int index = (indices >> (texel * 2)) & 3;
+        for(int channel = 0; channel < 3; channel++)
+        {
+            texels[texel * 4 + channel] = uint8_t(palette[index][channel]);
+        }
+    }
+}
+
+static void decodeAlphaBlock(const uint8_t* block, uint8_t* texels)
+{
+    int palette[8] = { block[0], block[1] };
+    for(int step = 1; step < 7; step++)
+    {
+        palette[step + 1] = ((7 - step) * block[0] + step * block[1]) / 7;
+    }
+
+    uint64_t indices = 0;
+    for(int byte = 0; byte < 6; byte++)
+    {
+        indices |= uint64_t(block[2 + byte]) << (byte * 8);
+    }
+    for(int texel = 0; texel < 16; texel++)
+    {
+        texels[texel * 4 + 3] = uint8_t(palette[(indices >> (texel * 3)) & 7]);
+    }
+}
+
+TEST(BlockCompressionSuite, SolidBlockKeepsItsColor)
+{
+    std::vector<uint8_t> texels(64);
+    for(int texel = 0; texel < 16; texel++)
+    {
+        texels[texel * 4 + 0] = 255;
+        texels[texel * 4 + 1] = 128;
+        texels[texel * 4 + 2] = 0;
+        texels[texel * 4 + 3] = 255;
+    }
+
+    uint8_t block[BC1_BLOCK_SIZE];
+    compressColorBlock(texels.data(), block);
+
+    uint8_t decoded[64];
+    decodeColorBlock(block, decoded);
+    for(int texel = 0; texel < 16; texel++)
+    {
+        EXPECT_EQ(decoded[texel * 4 + 0], 255);
+        EXPECT_NEAR(decoded[texel * 4 + 1], 128, 2);
+        EXPECT_EQ(decoded[texel * 4 + 2], 0);
+    }
+}
+
+TEST(BlockCompressionSuite, GradientStaysClose)
+{
+    std::vector<uint8_t> texels(64);
+    for(int texel = 0; texel < 16; texel++)
+    {
+        texels[texel * 4 + 0] = uint8_t(texel * 16);
+        texels[texel * 4 + 1] = uint8_t(texel * 16);
+        texels[texel * 4 + 2] = uint8_t(texel * 16);
+        texels[texel * 4 + 3] = uint8_t(255 - texel * 17);
+    }
+
+    uint8_t block[BC3_BLOCK_SIZE];
+    compressAlphaBlock(texels.data(), block);
+    compressColorBlock(texels.data(), block + 8);
+
+    uint8_t decoded[64];
+    decodeAlphaBlock(block, decoded);
+    decodeColorBlock(block + 8, decoded);
+    for(int i = 0; i < 64; i++)
+    {
+        EXPECT_NEAR(decoded[i], texels[i], i % 4 == 3 ? 19 : 40);
+    }
+}
+
+TEST(BlockCompressionSuite, SimdBoundsMatchScalar)
+{
+    uint8_t texels[64];
+    for(int i = 0; i < 64; i++)
+    {
+        texels[i] = uint8_t((i * 97 + 13) % 251);
+    }
+
+    uint8_t minimumSimd[4], maximumSimd[4], minimum[4], maximum[4];
+    getBlockBounds(texels, minimumSimd, maximumSimd, true);
+    getBlockBounds(texels, minimum, maximum, false);
+    for(int channel = 0; channel < 4; channel++)
+    {
+        EXPECT_EQ(minimumSimd[channel], minimum[channel]);
+        EXPECT_EQ(maximumSimd[channel], maximum[channel]);
+    }
+}
+
+TEST(BlockCompressionSuite, CompressesEveryLevel)
+{
+    ImageData image;
+    image.internalFormat = GL_RGBA8;
+    image.format = GL_RGBA;
+    image.pixels.assign(6 * 5 * 4 + 3 * 2 * 4, 255);
+    image.levels = { { 0, 6 * 5 * 4, 6, 5 }, { 6 * 5 * 4, 3 * 2 * 4, 3, 2 } };
+
+    ASSERT_TRUE(compressImage(image));
+    EXPECT_TRUE(image.isCompressed);
+    EXPECT_EQ(image.internalFormat, GLenum(GL_COMPRESSED_RGBA_S3TC_DXT1_EXT));
+    ASSERT_EQ(image.levels.size(), 2u);
+    EXPECT_EQ(image.levels[0].size, 2 * 2 * BC1_BLOCK_SIZE);
+    EXPECT_EQ(image.levels[1].offset, 2 * 2 * BC1_BLOCK_SIZE);
+    EXPECT_EQ(image.levels[1].size, BC1_BLOCK_SIZE);
+    EXPECT_EQ(image.pixels.size(), 5 * BC1_BLOCK_SIZE);
+
+    ImageData translucent;
+    translucent.format = GL_RGBA;
+    translucent.pixels.assign(4 * 4 * 4, 128);
+    translucent.levels = { { 0, 4 * 4 * 4, 4, 4 } };
+    ASSERT_TRUE(compressImage(translucent));
+    EXPECT_EQ(translucent.internalFormat, GLenum(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT));
+    EXPECT_EQ(translucent.pixels.size(), BC3_BLOCK_SIZE);
+}
@@ -0,0 +1,147 @@
+#include <gtest/gtest.h>
+
+#include "../src/classes/helper/LightClustering.h"
+
+#include <random>
+#include <vector>
+
+using namespace Engine;
+
+namespace
+{
+    std::vector<uint32_t> getClusterLights(const LightClusterSlice& slice, size_t tile)
+    {
+        size_t offset = 0;
+        for(size_t i = 0; i < tile; i++)
+        {
+            offset += slice.counts[i];
+        }
+        return { slice.indices.begin() + std::ptrdiff_t(offset),
+                 slice.indices.begin() + std::ptrdiff_t(offset + slice.counts[tile]) };
+    }
+} // namespace
+
+TEST(LightClusteringSuite, BoundsCoverTheFrustum)
+{
+    ClusterGrid grid;
+    grid.size = glm::ivec3(4, 2, 8);
+    grid.zNear = 1.f;
+    grid.zFar = 256.f;
+
+    ClusterBounds bounds;
+    buildClusterBounds(grid, 1.f, 0.5f, bounds);
+
+    ASSERT_EQ(bounds.minX.size(), 64u);
+    EXPECT_FLOAT_EQ(bounds.maxZ[0], -1.f);
+    EXPECT_FLOAT_EQ(bounds.minZ[0], -2.f);
+    EXPECT_FLOAT_EQ(bounds.minZ[63], -256.f);
+
+    // Bottom left cluster of the last slice reaches the frustum's corner at the far plane
+    const size_t last = 0 + 4 * (0 + 2 * 7);
+    EXPECT_FLOAT_EQ(bounds.minX[last], -256.f);
+    EXPECT_FLOAT_EQ(bounds.minY[last], -128.f);
+}
+
+TEST(LightClusteringSuite, PointLightTouchesNearbyClusters)
+{
+    ClusterGrid grid;
+    grid.size = glm::ivec3(2, 2, 4);
+    grid.zNear = 1.f;
+    grid.zFar = 16.f;
+
+    ClusterBounds bounds;
+    buildClusterBounds(grid, 1.f, 1.f, bounds);
+
+    // Slice 1 spans depths 2 to 4, the light sits in its top right tile
+    std::vector<ClusterLight> lights = {
+        { glm::vec3(2.f, 2.f, -3.f), 0.5f, glm::vec3(0.f, 0.f, -1.f), 0.f, false },
+        { glm::vec3(0.f, 0.f, -100.f), 1.f, glm::vec3(0.f, 0.f, -1.f), 0.f, false }
+    };
+
+    LightClusterSlice slice;
+    assignClusterSlice(bounds, lights, 1, slice);
+
+    ASSERT_EQ(slice.counts.size(), 4u);
+    EXPECT_EQ(getClusterLights(slice, 3), (std::vector<uint32_t> { 0 }));
+    EXPECT_TRUE(getClusterLights(slice, 0).empty());
+
+    assignClusterSlice(bounds, lights, 3, slice);
+    EXPECT_TRUE(slice.indices.empty());
+}
+
+TEST(LightClusteringSuite, SpotLightFacingAwayIsCulled)
+{
+    ClusterGrid grid;
+    grid.size = glm::ivec3(1, 1, 2);
+    grid.zNear = 1.f;
+    grid.zFar = 4.f;
+
+    ClusterBounds bounds;
+    buildClusterBounds(grid, 1.f, 1.f, bounds);
+
+    // Both sit behind the camera and reach the first slice, only the one pointing into the frustum lights it
+    std::vector<ClusterLight> lights = {
+        { glm::vec3(0.f, 0.f, 3.f), 10.f, glm::vec3(0.f, 0.f, 1.f), 0.9f, true },
+        { glm::vec3(0.f, 0.f, 3.f), 10.f, glm::vec3(0.f, 0.f, -1.f), 0.9f, true }
+    };
+
+    for(const bool useSimd : { true, false })
+    {
+        LightClusterSlice slice;
+        assignClusterSlice(bounds, lights, 0, slice, useSimd);
+        EXPECT_EQ(slice.indices, (std::vector<uint32_t> { 1 }));
+    }
+}
+
+TEST(LightClusteringSuite, SimdMatchesScalar)
+{
+    ClusterGrid grid;
+    grid.size = glm::ivec3(8, 6, 12);
+    grid.zNear = 0.5f;
+    grid.zFar = 60.f;
+
+    ClusterBounds bounds;
+    buildClusterBounds(grid, 1.2f, 0.9f, bounds);
+
+    std::mt19937 random(7);
+    std::uniform_real_distribution<float> position(-30.f, 30.f);
+    std::uniform_real_distribution<float> unit(0.f, 1.f);
+    std::vector<ClusterLight> lights(203);
+    for(ClusterLight& light : lights)
+    {
+        light.position = glm::vec3(position(random), position(random), -unit(random) * 60.f);
+        light.range = 1.f + unit(random) * 8.f;
+        light.direction = glm::normalize(glm::vec3(unit(random) - 0.5f, unit(random) - 0.5f, -unit(random)));
+        light.cosOuterAngle = unit(random);
+        light.isSpot = unit(random) < 0.5f;
+    }
+
+    for(int z = 0; z < grid.size.z; z++)
+    {
+        LightClusterSlice simd, scalar;
+        assignClusterSlice(bounds, lights, z, simd, true);
+        assignClusterSlice(bounds, lights, z, scalar, false);
+
+        EXPECT_EQ(simd.counts, scalar.counts) << "slice " << z;
+        EXPECT_EQ(simd.indices, scalar.indices) << "slice " << z;
+    }
+}
+
+TEST(LightClusteringSuite, MergeOffsetsFollowSlices)
+{
+    std::vector<LightClusterSlice> slices(2);
+    slices[0].counts = { 2, 0 };
+    slices[0].indices = { 4, 7 };
+    slices[1].counts = { 1, 3 };
+    slices[1].indices = { 1, 2, 5, 6 };
+
+    std::vector<uint32_t> clusterRanges, lightIndices;
+    mergeClusterSlices(slices, clusterRanges, lightIndices);
+    EXPECT_EQ(clusterRanges, (std::vector<uint32_t> { 0, 2, 2, 0, 2, 1, 3, 3 }));
+    EXPECT_EQ(lightIndices, (std::vector<uint32_t> { 4, 7, 1, 2, 5, 6 }));
+
+    // Clusters past the limit keep the lights that still fit
+    mergeClusterSlices(slices, clusterRanges, lightIndices, 4);
+    EXPECT_EQ(clusterRanges, (std::vector<uint32_t> { 0, 2, 2, 0, 2, 1, 3, 1 }));
+    EXPECT_EQ(lightIndices, (std::vector<uint32_t> { 4, 7, 1, 2 }));
+}
@@ -0,0 +1,70 @@
+#include <gtest/gtest.h>
+
+#include "../src/classes/helper/MeshCache.h"
+
+#include <cstdio>
+#include <cstring>
+#include <filesystem>
+#include <string>
+#include <vector>
+
+using namespace Engine;
+
+static void writeSourceFile(const std::string& filePath, const std::string& content)
+{
+    FILE* file = fopen(filePath.c_str(), "wb");
+    fwrite(content.data(), 1, content.size(), file);
+    fclose(file);
+}
+
+TEST(MeshCacheSuite, RoundTripsWithoutDecoding)
+{
+    const std::string sourcePath = (std::filesystem::temp_directory_path() / "meshCacheTest.obj").string();
+    writeSourceFile(sourcePath, "v 0 0 0\nv 1 0 0\nv 0 1 0\nf 1 2 3\n");
+
+    const size_t stride = getVertexStride(VertexFormat::FLOAT32);
+    std::vector<uint8_t> vertexData(3 * stride);
+    for(size_t i = 0; i < vertexData.size(); i++)
+    {
+        vertexData[i] = uint8_t(i * 7 + 1);
+    }
+    const std::vector<uint8_t> indexData = { 0, 0, 1, 0, 2, 0 };
+
+    ASSERT_TRUE(writeMeshCache(
+            sourcePath.c_str(),
+            vertexData,
+            VertexFormat::FLOAT32,
+            glm::vec3(0.f),
+            glm::vec3(1.f, 1.f, 0.f),
+            indexData,
+            2,
+            MESH_CACHE_FLAG_NORMALS
+    ));
+
+    {
+        MeshCacheFile cache;
+        ASSERT_TRUE(cache.open(sourcePath.c_str()));
+        EXPECT_EQ(cache.getVertexFormat(), VertexFormat::FLOAT32);
+        EXPECT_EQ(cache.getVertexCount(), 3u);
+        EXPECT_EQ(cache.getTriangleCount(), 1u);
+        EXPECT_EQ(cache.getIndexWidth(), 2u);
+        EXPECT_FALSE(cache.hasUvs());
+        EXPECT_TRUE(cache.hasNormals());
+        EXPECT_EQ(cache.getBoundsMax(), glm::vec3(1.f, 1.f, 0.f));
+
+        // The streams are used straight from the mapping, aligned so they can be uploaded as they are
+        ASSERT_EQ(cache.getVertexDataSize(), vertexData.size());
+        EXPECT_EQ(memcmp(cache.getVertexData(), vertexData.data(), vertexData.size()), 0);
+        ASSERT_EQ(cache.getIndexDataSize(), indexData.size());
+        EXPECT_EQ(memcmp(cache.getIndexData(), indexData.data(), indexData.size()), 0);
+        EXPECT_EQ(reinterpret_cast<uintptr_t>(cache.getIndexData()) % MESH_CACHE_ALIGNMENT, 0u);
+    }
+
+    // A changed source invalidates the cache
+    writeSourceFile(sourcePath, "v 0 0 0\nv 1 0 0\nv 0 1 0\nv 1 1 0\nf 1 2 3\nf 2 4 3\n");
+    MeshCacheFile stale;
+    EXPECT_FALSE(stale.open(sourcePath.c_str()));
+
+    std::remove(getMeshCachePath(sourcePath.c_str()).c_str());
+    std::remove(sourcePath.c_str());
+}
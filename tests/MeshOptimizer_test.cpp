@@ -0,0 +1,79 @@
+#include <gtest/gtest.h>
+
+#include "../src/classes/helper/MeshOptimizer.h"
+#include "../src/classes/helper/VertexIndexingHelper.h"
+
+#include <algorithm>
+#include <vector>
+
+using namespace Engine;
+
+namespace
+{
+    // Indexed grid of size * size quads, triangles listed column by column to start off cache unfriendly
+    void buildGrid(int size, std::vector<glm::vec3>& vertices, std::vector<triData>& indices)
+    {
+        for(int y = 0; y <= size; y++)
+        {
+            for(int x = 0; x <= size; x++)
+            {
+                vertices.emplace_back(float(x), float(y), 0.f);
+            }
+        }
+
+        for(int x = 0; x < size; x++)
+        {
+            for(int y = 0; y < size; y++)
+            {
+                const unsigned int corner = y * (size + 1) + x;
+                indices.push_back({ corner, corner + 1, corner + size + 2 });
+                indices.push_back({ corner, corner + size + 2, corner + size + 1 });
+            }
+        }
+    }
+} // namespace
+
+TEST(MeshOptimizerSuite, AcmrOfSingleTriangle)
+{
+    const std::vector<triData> indices = { { 0, 1, 2 }, { 0, 1, 2 } };
+    EXPECT_FLOAT_EQ(computeAcmr(indices, 3), 1.5f);
+}
+
+TEST(MeshOptimizerSuite, KeepsTrianglesAndImprovesAcmr)
+{
+    std::vector<glm::vec3> vertices, normals;
+    std::vector<glm::vec2> uvs;
+    std::vector<triData> indices;
+    buildGrid(64, vertices, indices);
+
+    const float acmrBefore = computeAcmr(indices, vertices.size());
+
+    // Remember every triangle by its positions, the indices change when the vertices are reordered
+    auto triangleKeys = [&vertices](const std::vector<triData>& tris)
+    {
+        std::vector<std::array<float, 9>> keys;
+        for(const auto& tri : tris)
+        {
+            std::array<float, 9> key {};
+            for(int corner = 0; corner < 3; corner++)
+            {
+                key[corner * 3] = vertices[tri[corner]].x;
+                key[corner * 3 + 1] = vertices[tri[corner]].y;
+                key[corner * 3 + 2] = vertices[tri[corner]].z;
+            }
+            keys.push_back(key);
+        }
+        std::sort(keys.begin(), keys.end());
+        return keys;
+    };
+    const auto keysBefore = triangleKeys(indices);
+
+    optimizeMesh("grid", vertices, uvs, normals, indices);
+
+    EXPECT_EQ(triangleKeys(indices), keysBefore);
+    EXPECT_LT(computeAcmr(indices, vertices.size()), acmrBefore);
+    EXPECT_LT(computeAcmr(indices, vertices.size()), 0.9f);
+
+    // Vertices are fetched in first use order
+    EXPECT_EQ(indices[0][0], 0);
+}
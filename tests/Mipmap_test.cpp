@@ -0,0 +1,56 @@
+#include <gtest/gtest.h>
+
+#include "../src/classes/helper/MipmapGenerator.h"
+
+#include <random>
+#include <vector>
+
+TEST(MipmapSuite, BoxFilterAveragesWithRounding)
+{
+    // 2x2 RGBA image, one output texel
+    const std::vector<uint8_t> source = { 0, 10, 255, 1, 1, 10, 255, 2, 2, 11, 255, 2, 3, 11, 254, 2 };
+    std::vector<uint8_t> destination(4);
+    Engine::downsampleBoxRGBA8(source.data(), 2, 2, destination.data());
+
+    EXPECT_EQ(destination, (std::vector<uint8_t> { 2, 11, 255, 2 }));
+}
+
+TEST(MipmapSuite, SimdMatchesScalar)
+{
+    std::mt19937 random(42);
+    const int sizes[][2] = { { 64, 64 }, { 37, 21 }, { 9, 1 }, { 1, 7 }, { 2, 2 } };
+    for(const auto& size : sizes)
+    {
+        std::vector<uint8_t> source(size_t(size[0]) * size_t(size[1]) * 4);
+        for(auto& value : source)
+        {
+            value = uint8_t(random());
+        }
+
+        const size_t outputSize = size_t(std::max(size[0] / 2, 1)) * size_t(std::max(size[1] / 2, 1)) * 4;
+        std::vector<uint8_t> simd(outputSize), scalar(outputSize);
+        Engine::downsampleBoxRGBA8(source.data(), size[0], size[1], simd.data(), true);
+        Engine::downsampleBoxRGBA8(source.data(), size[0], size[1], scalar.data(), false);
+
+        EXPECT_EQ(simd, scalar) << size[0] << "x" << size[1];
+    }
+}
+
+TEST(MipmapSuite, GeneratesChainDownToOnePixel)
+{
+    Engine::ImageData image;
+    image.internalFormat = GL_RGBA8;
+    image.format = GL_RGBA;
+    image.pixels.assign(size_t(16) * 4 * 4, 200);
+    image.levels = { { 0, image.pixels.size(), 16, 4 } };
+
+    Engine::generateMipChain(image);
+
+    ASSERT_EQ(image.levels.size(), 5u);
+    EXPECT_EQ(image.levels.back().width, 1);
+    EXPECT_EQ(image.levels.back().height, 1);
+    EXPECT_EQ(image.levels[2].width, 4);
+    EXPECT_EQ(image.levels[2].height, 1);
+    EXPECT_EQ(image.pixels.size(), image.levels.back().offset + 4);
+    EXPECT_EQ(image.pixels.back(), 200);
+}
@@ -0,0 +1,139 @@
+#include <gtest/gtest.h>
+
+#include "../src/classes/helper/ObjParser.h"
+
+#include <string>
+
+using namespace Engine;
+
+static bool parseObjString(
+        const std::string& obj,
+        std::vector<glm::vec3>& vertices,
+        std::vector<glm::vec2>& uvs,
+        std::vector<glm::vec3>& normals
+)
+{
+    ObjMeshData mesh;
+    parseObj(obj.data(), obj.data() + obj.size(), mesh);
+    return expandObjCorners(mesh, vertices, uvs, normals, "test");
+}
+
+TEST(ObjParserSuite, Triangle)
+{
+    const std::string obj = "v 0 0 0\nv 1 0 0\nv 0 1 0\nvt 0.5 1\nvn 0 0 1\nf 1/1/1 2/1/1 3/1/1\n";
+
+    std::vector<glm::vec3> vertices, normals;
+    std::vector<glm::vec2> uvs;
+    ASSERT_TRUE(parseObjString(obj, vertices, uvs, normals));
+
+    ASSERT_EQ(3, vertices.size());
+    ASSERT_EQ(3, uvs.size());
+    ASSERT_EQ(3, normals.size());
+    ASSERT_FLOAT_EQ(1.f, vertices[1].x);
+    ASSERT_FLOAT_EQ(0.5f, uvs[2].x);
+    ASSERT_FLOAT_EQ(1.f, normals[0].z);
+}
+
+TEST(ObjParserSuite, QuadFanTriangulation)
+{
+    const std::string obj = "v 0 0 0\nv 1 0 0\nv 1 1 0\nv 0 1 0\nv 0 2 0\nf 1 2 3 4 5\n";
+
+    std::vector<glm::vec3> vertices, normals;
+    std::vector<glm::vec2> uvs;
+    ASSERT_TRUE(parseObjString(obj, vertices, uvs, normals));
+
+    ASSERT_EQ(9, vertices.size());
+    ASSERT_TRUE(uvs.empty());
+    ASSERT_TRUE(normals.empty());
+
+    // Every triangle of the fan starts at the first corner
+    for(int tri = 0; tri < 3; tri++)
+    {
+        ASSERT_FLOAT_EQ(0.f, vertices[tri * 3].x);
+        ASSERT_FLOAT_EQ(0.f, vertices[tri * 3].y);
+    }
+    ASSERT_FLOAT_EQ(2.f, vertices[8].y);
+}
+
+TEST(ObjParserSuite, NegativeIndicesAndCrLf)
+{
+    const std::string obj = "v 0 0 0\r\nv 1 0 0\r\nv 0 1 0\r\nvn 0 1 0\r\nf -3//-1 -2//-1 -1//-1\r\n";
+
+    std::vector<glm::vec3> vertices, normals;
+    std::vector<glm::vec2> uvs;
+    ASSERT_TRUE(parseObjString(obj, vertices, uvs, normals));
+
+    ASSERT_EQ(3, vertices.size());
+    ASSERT_TRUE(uvs.empty());
+    ASSERT_EQ(3, normals.size());
+    ASSERT_FLOAT_EQ(1.f, vertices[1].x);
+    ASSERT_FLOAT_EQ(1.f, normals[2].y);
+}
+
+TEST(ObjParserSuite, LongLines)
+{
+    std::string obj = "# " + std::string(1000, 'x') + "\n";
+    obj += "v " + std::string(200, ' ') + "1.5 2.5 3.5\n";
+    obj += "v 0 0 0\nv 0 1 0\nf 1 2 3";
+
+    std::vector<glm::vec3> vertices, normals;
+    std::vector<glm::vec2> uvs;
+    ASSERT_TRUE(parseObjString(obj, vertices, uvs, normals));
+
+    ASSERT_EQ(3, vertices.size());
+    ASSERT_FLOAT_EQ(3.5f, vertices[0].z);
+}
+
+TEST(ObjParserSuite, IndexOutOfRange)
+{
+    const std::string obj = "v 0 0 0\nv 1 0 0\nf 1 2 3\n";
+
+    std::vector<glm::vec3> vertices, normals;
+    std::vector<glm::vec2> uvs;
+    ASSERT_FALSE(parseObjString(obj, vertices, uvs, normals));
+}
+
+TEST(ObjParserSuite, ChunkedMatchesSequential)
+{
+    std::string obj;
+    for(int i = 0; i < 200; i++)
+    {
+        obj += "v " + std::to_string(i) + " 0 0\nvt 0 " + std::to_string(i) + "\n";
+        if(i >= 2)
+        {
+            // Mix absolute and relative indices, relative ones may reach back into previous chunks
+            obj += "f " + std::to_string(i - 1) + "/-3 -2/-2 -1/" + std::to_string(i + 1) + "\n";
+        }
+    }
+
+    // The chunks may finish in any order, the runner takes them back to front
+    const ObjTaskRunner runReversed = [](size_t count, const std::function<void(size_t)>& task)
+    {
+        for(size_t i = count; i > 0; i--)
+        {
+            task(i - 1);
+        }
+    };
+
+    ObjMeshData sequential, chunked;
+    parseObj(obj.data(), obj.data() + obj.size(), sequential, 1);
+    parseObj(obj.data(), obj.data() + obj.size(), chunked, 7, runReversed);
+
+    ASSERT_EQ(sequential.positions.size(), chunked.positions.size());
+    ASSERT_EQ(sequential.uvs.size(), chunked.uvs.size());
+    ASSERT_EQ(sequential.corners.size(), chunked.corners.size());
+    for(size_t i = 0; i < sequential.corners.size(); i++)
+    {
+        ASSERT_EQ(sequential.corners[i].position, chunked.corners[i].position);
+        ASSERT_EQ(sequential.corners[i].uv, chunked.corners[i].uv);
+        ASSERT_EQ(sequential.corners[i].normal, chunked.corners[i].normal);
+    }
+    for(size_t i = 0; i < sequential.positions.size(); i++)
+    {
+        ASSERT_FLOAT_EQ(sequential.positions[i].x, chunked.positions[i].x);
+    }
+
+    std::vector<glm::vec3> vertices, normals;
+    std::vector<glm::vec2> uvs;
+    ASSERT_TRUE(expandObjCorners(chunked, vertices, uvs, normals, "test"));
+}
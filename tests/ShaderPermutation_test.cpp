@@ -0,0 +1,42 @@
+#include <gtest/gtest.h>
+
+#include "../src/classes/helper/ShaderPermutation.h"
+
+#include <string>
+
+using namespace Engine;
+
+TEST(ShaderPermutationSuite, DefinesFollowVersionDirective)
+{
+    const std::string source = "#version 410\nvoid main()\n{\n}\n";
+    const std::string permutation =
+            addShaderDefines(source, SHADER_FEATURE_TEXTURE | SHADER_FEATURE_AMBIENT_LIGHT);
+
+    EXPECT_EQ(
+            permutation,
+            "#version 410\n#define USE_AMBIENT_LIGHT\n#define USE_TEXTURE\n#line 2\nvoid main()\n{\n}\n"
+    );
+    EXPECT_EQ(addShaderDefines(source, SHADER_FEATURE_NONE), source);
+}
+
+TEST(ShaderPermutationSuite, LineNumbersMatchSourceAfterComments)
+{
+    const std::string source = "// Comment\n#version 410";
+    EXPECT_EQ(
+            addShaderDefines(source, SHADER_FEATURE_INSTANCING),
+            "// Comment\n#version 410\n#define USE_INSTANCING\n#line 3\n"
+    );
+}
+
+TEST(ShaderPermutationSuite, VariantNamesDifferPerFeatureSet)
+{
+    EXPECT_EQ(getShaderVariantName("lit", SHADER_FEATURE_NONE), "lit");
+    EXPECT_EQ(
+            getShaderVariantName("lit", SHADER_FEATURE_VERTEX_COLOR | SHADER_FEATURE_DIFFUSE_LIGHT),
+            "lit+USE_DIFFUSE_LIGHT+USE_VERTEX_COLOR"
+    );
+    EXPECT_NE(
+            getShaderVariantName("lit", SHADER_FEATURE_AMBIENT_LIGHT),
+            getShaderVariantName("lit", SHADER_FEATURE_DIFFUSE_LIGHT)
+    );
+}
@@ -0,0 +1,89 @@
+#include <gtest/gtest.h>
+
+#include "../src/classes/helper/TextureAtlas.h"
+
+#include <vector>
+
+using namespace Engine;
+
+static ImageData makeSolidImage(int width, int height, unsigned char value)
+{
+    ImageData image;
+    image.internalFormat = GL_RGBA8;
+    image.format = GL_RGBA;
+    image.pixels.assign(size_t(width) * size_t(height) * 4, value);
+    image.levels = { { 0, image.pixels.size(), width, height } };
+    generateMipChain(image);
+    return image;
+}
+
+TEST(TextureAtlasSuite, PackedRectsDontOverlap)
+{
+    const std::vector<glm::ivec2> sizes = { { 64, 64 }, { 30, 10 }, { 100, 20 }, { 8, 8 }, { 64, 32 } };
+    std::vector<AtlasRect> rects;
+    const glm::ivec2 atlasSize = packAtlasRects(sizes, 1024, rects);
+    ASSERT_GT(atlasSize.x, 0);
+    ASSERT_EQ(rects.size(), sizes.size());
+
+    for(size_t i = 0; i < rects.size(); i++)
+    {
+        const AtlasRect& a = rects[i];
+        EXPECT_EQ(a.width, sizes[i].x);
+        EXPECT_EQ((a.x - TEXTURE_ATLAS_PADDING) % TEXTURE_ATLAS_ALIGNMENT, 0);
+        EXPECT_GE(a.x - TEXTURE_ATLAS_PADDING, 0);
+        EXPECT_LE(a.x + a.width + TEXTURE_ATLAS_PADDING, atlasSize.x);
+        EXPECT_LE(a.y + a.height + TEXTURE_ATLAS_PADDING, atlasSize.y);
+
+        for(size_t j = i + 1; j < rects.size(); j++)
+        {
+            const AtlasRect& b = rects[j];
+            const bool separate = a.x + a.width + 2 * TEXTURE_ATLAS_PADDING <= b.x ||
+                    b.x + b.width + 2 * TEXTURE_ATLAS_PADDING <= a.x ||
+                    a.y + a.height + 2 * TEXTURE_ATLAS_PADDING <= b.y ||
+                    b.y + b.height + 2 * TEXTURE_ATLAS_PADDING <= a.y;
+            EXPECT_TRUE(separate);
+        }
+    }
+
+    EXPECT_EQ(packAtlasRects(sizes, 64, rects), glm::ivec2(0));
+}
+
+TEST(TextureAtlasSuite, AtlasPadsAndMapsRegions)
+{
+    const ImageData first = makeSolidImage(16, 8, 50);
+    const ImageData second = makeSolidImage(4, 4, 200);
+    const std::vector<const ImageData*> images = { &first, &second };
+
+    std::vector<AtlasRect> rects;
+    const glm::ivec2 atlasSize = packAtlasRects({ { 16, 8 }, { 4, 4 } }, 256, rects);
+
+    ImageData atlas;
+    std::vector<TextureRegion> regions;
+    buildAtlasImage(images, rects, atlasSize, atlas, regions);
+
+    ASSERT_EQ(regions.size(), 2u);
+    EXPECT_LE(atlas.levels.size(), TEXTURE_ATLAS_MIP_LEVELS);
+    EXPECT_FLOAT_EQ(regions[1].uvScale.x * float(atlasSize.x), 4.f);
+    EXPECT_FLOAT_EQ(regions[1].uvOffset.x * float(atlasSize.x), float(rects[1].x));
+
+    // The texel left of the second image's region is padding repeating its border
+    const size_t padding = (size_t(rects[1].y) * size_t(atlasSize.x) + size_t(rects[1].x - 1)) * 4;
+    EXPECT_EQ(atlas.pixels[padding], 200);
+}
+
+TEST(TextureAtlasSuite, ArrayNeedsMatchingSizes)
+{
+    const ImageData first = makeSolidImage(8, 8, 10);
+    const ImageData second = makeSolidImage(8, 8, 20);
+    const ImageData other = makeSolidImage(4, 8, 30);
+
+    ImageData array;
+    ASSERT_TRUE(buildArrayImage({ &first, &second }, array));
+    EXPECT_EQ(array.target, GLenum(GL_TEXTURE_2D_ARRAY));
+    EXPECT_EQ(array.layerCount, 2);
+    ASSERT_EQ(array.levels.size(), first.levels.size() * 2);
+    EXPECT_EQ(array.levels[first.levels.size()].layer, 1);
+    EXPECT_EQ(array.pixels[array.levels[first.levels.size()].offset], 20);
+
+    EXPECT_FALSE(buildArrayImage({ &first, &other }, array));
+}
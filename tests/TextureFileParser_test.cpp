@@ -0,0 +1,121 @@
+#include <gtest/gtest.h>
+
+#include "../src/classes/helper/TextureFileParser.h"
+
+#include <vector>
+
+using namespace Engine;
+
+static std::vector<unsigned char> makeDDS(
+        const DdsHeader& header,
+        const DdsHeaderDx10* extension,
+        size_t dataSize
+)
+{
+    std::vector<unsigned char> file(4 + sizeof(DdsHeader));
+    memcpy(file.data(), "DDS ", 4);
+    memcpy(file.data() + 4, &header, sizeof(DdsHeader));
+    if(extension)
+    {
+        const auto* bytes = reinterpret_cast<const unsigned char*>(extension);
+        file.insert(file.end(), bytes, bytes + sizeof(DdsHeaderDx10));
+    }
+    file.resize(file.size() + dataSize);
+    return file;
+}
+
+static DdsHeader makeDdsHeader(uint32_t width, uint32_t height, uint32_t mipMapCount, uint32_t fourCC)
+{
+    DdsHeader header {};
+    header.size = sizeof(DdsHeader);
+    header.flags = 0x1 | 0x2 | 0x4 | 0x1000 | 0x20000;
+    header.width = width;
+    header.height = height;
+    header.mipMapCount = mipMapCount;
+    header.pixelFormatSize = 32;
+    header.pixelFormatFlags = 0x4;
+    header.fourCC = fourCC;
+    return header;
+}
+
+TEST(TextureFileParserSuite, DdsLevelsHaveExactSizes)
+{
+    // 8x4 DXT1: 2 blocks, then 4x2 and 2x1 take one block each
+    const DdsHeader header = makeDdsHeader(8, 4, 3, DDS_FOURCC('D', 'X', 'T', '1'));
+    const std::vector<unsigned char> file = makeDDS(header, nullptr, 16 + 8 + 8);
+
+    ImageData image;
+    ASSERT_TRUE(parseDDS(file.data(), file.size(), image, "test.dds"));
+    EXPECT_EQ(image.internalFormat, GLenum(GL_COMPRESSED_RGBA_S3TC_DXT1_EXT));
+    EXPECT_EQ(image.target, GLenum(GL_TEXTURE_2D));
+    ASSERT_EQ(image.levels.size(), 3u);
+    EXPECT_EQ(image.levels[0].offset, 128u);
+    EXPECT_EQ(image.levels[0].size, 16u);
+    EXPECT_EQ(image.levels[1].size, 8u);
+    EXPECT_EQ(image.levels[2].width, 2);
+    EXPECT_EQ(image.levels[2].height, 1);
+    EXPECT_EQ(image.levels[2].level, 2);
+
+    EXPECT_FALSE(parseDDS(file.data(), file.size() - 1, image, "test.dds"));
+}
+
+TEST(TextureFileParserSuite, DdsDx10ArraysAndCubeMaps)
+{
+    const DdsHeader header = makeDdsHeader(4, 4, 2, DDS_FOURCC('D', 'X', '1', '0'));
+    DdsHeaderDx10 extension { 98, 3, 0, 3, 0 }; // BC7, 2D, three layers
+
+    std::vector<unsigned char> file = makeDDS(header, &extension, 3 * (16 + 16));
+    ImageData image;
+    ASSERT_TRUE(parseDDS(file.data(), file.size(), image, "array.dds"));
+    EXPECT_EQ(image.internalFormat, GLenum(GL_COMPRESSED_RGBA_BPTC_UNORM));
+    EXPECT_EQ(image.target, GLenum(GL_TEXTURE_2D_ARRAY));
+    EXPECT_EQ(image.layerCount, 3);
+    ASSERT_EQ(image.levels.size(), 6u);
+    // Layers are stored one after another, each with all of its levels
+    EXPECT_EQ(image.levels[2].layer, 1);
+    EXPECT_EQ(image.levels[2].level, 0);
+    EXPECT_EQ(image.levels[2].offset, 148u + 32u);
+
+    extension = { 80, 3, 0x4, 1, 0 }; // BC4 cube map
+    file = makeDDS(header, &extension, 6 * (8 + 8));
+    ASSERT_TRUE(parseDDS(file.data(), file.size(), image, "cube.dds"));
+    EXPECT_EQ(image.internalFormat, GLenum(GL_COMPRESSED_RED_RGTC1));
+    EXPECT_EQ(image.target, GLenum(GL_TEXTURE_CUBE_MAP));
+    EXPECT_EQ(image.levels.size(), 12u);
+
+    extension = { 2, 3, 0, 1, 0 }; // R32G32B32A32_FLOAT isn't supported
+    file = makeDDS(header, &extension, 256);
+    EXPECT_FALSE(parseDDS(file.data(), file.size(), image, "float.dds"));
+}
+
+TEST(TextureFileParserSuite, Ktx2LevelsFollowTheLevelIndex)
+{
+    Ktx2Header header {};
+    header.vkFormat = 137; // BC3
+    header.pixelWidth = 8;
+    header.pixelHeight = 8;
+    header.layerCount = 2;
+    header.faceCount = 1;
+    header.levelCount = 2;
+
+    // The level index lists the smallest level's data first, like KTX2 files store it
+    const Ktx2Level levels[2] = { { 200, 2 * 64, 2 * 64 }, { 160, 2 * 16, 2 * 16 } };
+    std::vector<unsigned char> file(200 + 2 * 64);
+    memcpy(file.data(), KTX2_IDENTIFIER, sizeof(KTX2_IDENTIFIER));
+    memcpy(file.data() + sizeof(KTX2_IDENTIFIER), &header, sizeof(Ktx2Header));
+    memcpy(file.data() + 80, levels, sizeof(levels));
+
+    ImageData image;
+    ASSERT_TRUE(parseKTX2(file.data(), file.size(), image, "test.ktx2"));
+    EXPECT_EQ(image.internalFormat, GLenum(GL_COMPRESSED_RGBA_S3TC_DXT5_EXT));
+    EXPECT_EQ(image.target, GLenum(GL_TEXTURE_2D_ARRAY));
+    ASSERT_EQ(image.levels.size(), 4u);
+    EXPECT_EQ(image.levels[0].offset, 200u);
+    EXPECT_EQ(image.levels[1].offset, 264u);
+    EXPECT_EQ(image.levels[1].layer, 1);
+    EXPECT_EQ(image.levels[2].offset, 160u);
+    EXPECT_EQ(image.levels[3].width, 4);
+
+    file.resize(300);
+    EXPECT_FALSE(parseKTX2(file.data(), file.size(), image, "test.ktx2"));
+}
@@ -0,0 +1,62 @@
+#include <gtest/gtest.h>
+
+#include "../src/classes/helper/VertexEncodingHelper.h"
+
+#include <vector>
+
+TEST(VertexEncodingSuite, OctahedralNormalsRoundTrip)
+{
+    const std::vector<glm::vec3> normals = { { 0, 0, 1 },  { 0, 0, -1 },     { 1, 0, 0 },
+                                             { 0, -1, 0 }, { .6f, -.8f, 0 }, { -.48f, .6f, -.64f } };
+
+    for(const auto& normal : normals)
+    {
+        const glm::vec2 encoded = encodeOctahedral(normal);
+        const glm::vec3 decoded = decodeOctahedral(glm::vec2(
+                decodeSnorm16(encodeSnorm16(encoded.x)),
+                decodeSnorm16(encodeSnorm16(encoded.y))
+        ));
+        EXPECT_GT(glm::dot(decoded, normal), 0.9999f);
+    }
+}
+
+TEST(VertexEncodingSuite, QuantizedFormatsRoundTrip)
+{
+    const std::vector<PackedVertex> vertices = {
+        { { -2.f, 0.f, 10.f }, { 0.f, 1.f }, { 0.f, 1.f, 0.f } },
+        { { 3.f, 1.5f, 12.f }, { .25f, .75f }, { 0.f, 0.f, -1.f } },
+        { { .5f, -1.f, 11.f }, { 4.f, -2.f }, { 1.f, 0.f, 0.f } },
+    };
+    const glm::vec3 boundsMin(-2.f, -1.f, 10.f);
+    const glm::vec3 boundsMax(3.f, 1.5f, 12.f);
+
+    const auto formats = {
+        VertexFormat::FLOAT32,
+        VertexFormat::HALF_POSITIONS,
+        VertexFormat::SNORM16_POSITIONS,
+    };
+    for(const auto format : formats)
+    {
+        std::vector<uint8_t> encoded;
+        encodeVertices(vertices, format, boundsMin, boundsMax, encoded);
+        ASSERT_EQ(encoded.size(), vertices.size() * getVertexStride(format));
+
+        std::vector<glm::vec3> positions, normals;
+        std::vector<glm::vec2> uvs;
+        const size_t count = vertices.size();
+        decodeVertices(encoded.data(), count, format, boundsMin, boundsMax, positions, uvs, normals);
+
+        for(size_t i = 0; i < vertices.size(); i++)
+        {
+            for(int axis = 0; axis < 3; axis++)
+            {
+                EXPECT_NEAR(positions[i][axis], vertices[i].position[axis], 0.01f);
+                EXPECT_NEAR(normals[i][axis], vertices[i].normal[axis], 0.001f);
+            }
+            EXPECT_NEAR(uvs[i].x, vertices[i].uv.x, 0.001f);
+            EXPECT_NEAR(uvs[i].y, vertices[i].uv.y, 0.001f);
+        }
+    }
+
+    EXPECT_EQ(getVertexStride(VertexFormat::SNORM16_POSITIONS) * 2, getVertexStride(VertexFormat::FLOAT32));
+}
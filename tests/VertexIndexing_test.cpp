@@ -0,0 +1,96 @@
+#include <gtest/gtest.h>
+
+#include "../src/classes/helper/VertexIndexingHelper.h"
+
+#include <vector>
+
+TEST(VertexIndexingSuite, WeldsIdenticalVertices)
+{
+    // Two triangles of a quad, sharing one edge
+    std::vector<glm::vec3> vertices = { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 },
+                                        { 0, 0, 0 }, { 1, 1, 0 }, { 0, 1, 0 } };
+    std::vector<glm::vec2> uvs;
+    std::vector<glm::vec3> normals;
+    std::vector<triData> indices;
+
+    indexVBO(vertices, uvs, normals, indices);
+
+    ASSERT_EQ(vertices.size(), 4);
+    ASSERT_EQ(uvs.size(), 4);
+    ASSERT_EQ(normals.size(), 4);
+    ASSERT_EQ(indices.size(), 2);
+    EXPECT_EQ(indices[0], (triData { 0, 1, 2 }));
+    EXPECT_EQ(indices[1], (triData { 0, 2, 3 }));
+}
+
+TEST(VertexIndexingSuite, KeepsVerticesWithDifferentAttributes)
+{
+    std::vector<glm::vec3> vertices = { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 },
+                                        { 0, 0, 0 }, { 1, 1, 0 }, { 0, 1, 0 } };
+    std::vector<glm::vec2> uvs = { { 0, 0 }, { 1, 0 }, { 1, 1 }, { .5f, 0 }, { 1, 1 }, { 0, 1 } };
+    std::vector<glm::vec3> normals;
+    std::vector<triData> indices;
+
+    indexVBO(vertices, uvs, normals, indices);
+
+    ASSERT_EQ(vertices.size(), 5);
+    EXPECT_EQ(indices[1], (triData { 3, 2, 4 }));
+}
+
+TEST(VertexIndexingSuite, EpsilonWeldingMergesNearbyVertices)
+{
+    std::vector<glm::vec3> vertices = { { 0, 0, 0 }, { 1, 0, 0 }, { 1, 1, 0 },
+                                        { 0.0001f, 0, 0 }, { 1, 1.0001f, 0 }, { 0, 1, 0 } };
+    std::vector<glm::vec2> uvs;
+    std::vector<glm::vec3> normals;
+    std::vector<triData> exactIndices;
+    std::vector<glm::vec3> exactVertices = vertices;
+
+    indexVBO(exactVertices, uvs, normals, exactIndices);
+    EXPECT_EQ(exactVertices.size(), 6);
+
+    std::vector<triData> weldedIndices;
+    indexVBO(vertices, uvs, normals, weldedIndices, 0.001f);
+
+    ASSERT_EQ(vertices.size(), 4);
+    EXPECT_EQ(weldedIndices[1], (triData { 0, 2, 3 }));
+    EXPECT_EQ(vertices[0], glm::vec3(0, 0, 0));
+}
+
+TEST(VertexIndexingSuite, IndexWidthFollowsVertexCount)
+{
+    EXPECT_EQ(getIndexWidth(0x10000), 2);
+    EXPECT_EQ(getIndexWidth(0x10001), 4);
+
+    const std::vector<triData> indices = { { 0, 1, 2 }, { 65535, 3, 70000 } };
+    std::vector<uint8_t> packed;
+    std::vector<triData> unpacked;
+
+    packIndices(indices, 4, packed);
+    ASSERT_EQ(packed.size(), 24);
+    unpackIndices(packed.data(), indices.size(), 4, unpacked);
+    EXPECT_EQ(unpacked, indices);
+
+    packIndices({ indices[0] }, 2, packed);
+    ASSERT_EQ(packed.size(), 6);
+    unpackIndices(packed.data(), 1, 2, unpacked);
+    EXPECT_EQ(unpacked[0], indices[0]);
+}
+
+TEST(VertexIndexingSuite, IndicesBeyondSixteenBits)
+{
+    // Every triangle is distinct, so every vertex stays unique
+    std::vector<glm::vec3> vertices(3 * 30000);
+    for(size_t i = 0; i < vertices.size(); i++)
+    {
+        vertices[i] = glm::vec3(float(i), 0.f, 0.f);
+    }
+    std::vector<glm::vec2> uvs;
+    std::vector<glm::vec3> normals;
+    std::vector<triData> indices;
+
+    indexVBO(vertices, uvs, normals, indices);
+
+    ASSERT_EQ(vertices.size(), 90000);
+    EXPECT_EQ(indices.back(), (triData { 89997, 89998, 89999 }));
+}
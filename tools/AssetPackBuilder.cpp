@@ -0,0 +1,68 @@
+#include "../src/classes/helper/AssetPack.h"
+
+#include <algorithm>
+#include <filesystem>
+#include <iostream>
+#include <string>
+#include <vector>
+
+using namespace Engine;
+
+/**
+ * Packs every asset below a resource directory into one asset pack.
+ * Entries are named after their path relative to the directory's parent, like "resources/shader/lit.vert",
+ * the way the engine refers to them. C++ sources kept next to the shaders aren't packed.
+ *
+ * Usage: assetPackBuilder <resource directory> <pack path>
+ */
+int main(int argc, char** argv)
+{
+    if(argc != 3)
+    {
+        std::cout << "Usage: assetPackBuilder <resource directory> <pack path>" << std::endl;
+        return 1;
+    }
+
+    const std::filesystem::path resourcePath = std::filesystem::path(argv[1]).lexically_normal();
+    if(!std::filesystem::is_directory(resourcePath))
+    {
+        std::cout << "Couldn't open directory [" << argv[1] << "]" << std::endl;
+        return 1;
+    }
+
+    // A trailing slash leaves an empty file name, the directory is the parent path then
+    std::filesystem::path basePath = resourcePath.parent_path();
+    if(!resourcePath.has_filename())
+    {
+        basePath = basePath.parent_path();
+    }
+
+    std::vector<AssetPackSource> sources;
+    for(const auto& file : std::filesystem::recursive_directory_iterator(resourcePath))
+    {
+        const std::string extension = file.path().extension().string();
+        if(!file.is_regular_file() || extension == ".cpp" || extension == ".h")
+        {
+            continue;
+        }
+
+        const std::string path = file.path().lexically_relative(basePath).generic_string();
+        sources.push_back({ path, file.path().string() });
+    }
+
+    // Sorted, so packing the same files twice gives the same pack
+    std::sort(
+            sources.begin(),
+            sources.end(),
+            [](const AssetPackSource& a, const AssetPackSource& b) { return a.path < b.path; }
+    );
+
+    if(!writeAssetPack(argv[2], sources))
+    {
+        std::cout << "Couldn't write asset pack [" << argv[2] << "]" << std::endl;
+        return 1;
+    }
+
+    std::cout << "Packed " << sources.size() << " files into [" << argv[2] << "]" << std::endl;
+    return 0;
+}